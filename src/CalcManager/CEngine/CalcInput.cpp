@@ -332,8 +332,5 @@ Rational CalcInput::ToRational(uint32_t radix, int32_t precision)
         return 0;
     }
 
-    Rational result{ rat };
-    destroyrat(rat);
-
-    return result;
+    return Rational::Attach(rat);
 }
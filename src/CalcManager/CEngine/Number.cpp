@@ -7,60 +7,69 @@ using namespace std;
 
 namespace CalcEngine
 {
+    namespace
+    {
+        shared_ptr<NUMBER const> ShareNumber(PNUMBER p)
+        {
+            return shared_ptr<NUMBER const>{ p, [](NUMBER const* pnum) { _destroynum(const_cast<PNUMBER>(pnum)); } };
+        }
+    }
+
     Number::Number() noexcept
         : Number(1, 0, { 0 })
     {
     }
 
     Number::Number(int32_t sign, int32_t exp, vector<uint32_t> const& mantissa) noexcept
-        : m_sign{ sign }
-        , m_exp{ exp }
-        , m_mantissa{ mantissa }
     {
+        PNUMBER p = nullptr;
+        createnum(p, static_cast<uint32_t>(mantissa.size()));
+        p->sign = sign;
+        p->exp = exp;
+        p->cdigit = static_cast<int32_t>(mantissa.size());
+        copy(mantissa.begin(), mantissa.end(), p->mant);
+
+        m_number = ShareNumber(p);
     }
 
     Number::Number(PNUMBER p) noexcept
-        : m_sign{ p->sign }
-        , m_exp{ p->exp }
-        , m_mantissa{}
     {
-        m_mantissa.reserve(p->cdigit);
-        copy(p->mant, p->mant + p->cdigit, back_inserter(m_mantissa));
+        PNUMBER copy = nullptr;
+        DUPNUM(copy, p);
+
+        m_number = ShareNumber(copy);
     }
 
-    PNUMBER Number::ToPNUMBER() const
+    Number::Number(shared_ptr<NUMBER const> number) noexcept
+        : m_number{ move(number) }
     {
-        PNUMBER ret = _createnum(static_cast<uint32_t>(this->Mantissa().size()) + 1);
-        ret->sign = this->Sign();
-        ret->exp = this->Exp();
-        ret->cdigit = static_cast<int32_t>(this->Mantissa().size());
+    }
 
-        MANTTYPE* ptrRet = ret->mant;
-        for (auto const& digit : this->Mantissa())
-        {
-            *ptrRet++ = digit;
-        }
+    PNUMBER Number::ToPNUMBER() const
+    {
+        PNUMBER ret = nullptr;
+        DUPNUM(ret, m_number.get());
 
         return ret;
     }
 
     int32_t const& Number::Sign() const
     {
-        return m_sign;
+        return m_number->sign;
     }
 
     int32_t const& Number::Exp() const
     {
-        return m_exp;
+        return m_number->exp;
     }
 
-    vector<uint32_t> const& Number::Mantissa() const
+    vector<uint32_t> Number::Mantissa() const
     {
-        return m_mantissa;
+        return vector<uint32_t>(m_number->mant, m_number->mant + m_number->cdigit);
     }
 
     bool Number::IsZero() const
     {
-        return all_of(m_mantissa.begin(), m_mantissa.end(), [](auto&& i) { return i == 0; });
+        return all_of(m_number->mant, m_number->mant + m_number->cdigit, [](auto&& i) { return i == 0; });
     }
 }
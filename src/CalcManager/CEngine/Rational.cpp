@@ -6,9 +6,39 @@ using namespace std;
 
 namespace CalcEngine
 {
+    namespace
+    {
+        // Moves the sign of q to p, Ratpack only writes to an operand to do this.
+        void KeepQPositive(PRAT prat)
+        {
+            if (prat->pq->sign != 1)
+            {
+                prat->pp->sign *= prat->pq->sign;
+                prat->pq->sign = 1;
+            }
+        }
+    }
+
+    struct Rational::RatStorage
+    {
+        explicit RatStorage(PRAT p) noexcept
+            : prat{ p }
+        {
+        }
+
+        RatStorage(RatStorage const&) = delete;
+        RatStorage& operator=(RatStorage const&) = delete;
+
+        ~RatStorage()
+        {
+            destroyrat(prat);
+        }
+
+        PRAT prat;
+    };
+
     Rational::Rational() noexcept
-        : m_p{}
-        , m_q{ 1, 0, { 1 } }
+        : m_rat{ Share(i32torat(0)) }
     {
     }
 
@@ -20,34 +50,37 @@ namespace CalcEngine
             qExp -= n.Exp();
         }
 
-        m_p = Number(n.Sign(), 0, n.Mantissa());
-        m_q = Number(1, qExp, { 1 });
+        PRAT prat = nullptr;
+        createrat(prat);
+        DUPNUM(prat->pp, n.m_number.get());
+        prat->pp->exp = 0;
+        createnum(prat->pq, 1);
+        prat->pq->sign = 1;
+        prat->pq->cdigit = 1;
+        prat->pq->exp = qExp;
+        prat->pq->mant[0] = 1;
+
+        m_rat = Share(prat);
     }
 
     Rational::Rational(Number const& p, Number const& q) noexcept
-        : m_p{ p }
-        , m_q{ q }
     {
+        PRAT prat = nullptr;
+        createrat(prat);
+        DUPNUM(prat->pp, p.m_number.get());
+        DUPNUM(prat->pq, q.m_number.get());
+
+        m_rat = Share(prat);
     }
 
     Rational::Rational(int32_t i)
+        : m_rat{ Share(i32torat(i)) }
     {
-        PRAT pr = i32torat(static_cast<int32_t>(i));
-
-        m_p = Number{ pr->pp };
-        m_q = Number{ pr->pq };
-
-        destroyrat(pr);
     }
 
     Rational::Rational(uint32_t ui)
+        : m_rat{ Share(Ui32torat(ui)) }
     {
-        PRAT pr = Ui32torat(static_cast<uint32_t>(ui));
-
-        m_p = Number{ pr->pp };
-        m_q = Number{ pr->pq };
-
-        destroyrat(pr);
     }
 
     Rational::Rational(uint64_t ui)
@@ -55,133 +88,151 @@ namespace CalcEngine
         uint32_t hi = (uint32_t) (((ui) >> 32) & 0xffffffff);
         uint32_t lo = (uint32_t) ui;
 
-        Rational temp = (Rational{ hi } << 32) | lo;
+        // The internal base is 2^32, so the two halves are the digits.
+        PRAT prat = nullptr;
+        createrat(prat);
+        createnum(prat->pp, 2);
+        prat->pp->sign = 1;
+        prat->pp->cdigit = (hi == 0) ? 1 : 2;
+        prat->pp->mant[0] = lo;
+        prat->pp->mant[1] = hi;
+        createnum(prat->pq, 1);
+        prat->pq->sign = 1;
+        prat->pq->cdigit = 1;
+        prat->pq->mant[0] = 1;
 
-        m_p = Number{ temp.P() };
-        m_q = Number{ temp.Q() };
+        m_rat = Share(prat);
     }
 
     Rational::Rational(PRAT prat) noexcept
-        : m_p{ Number{ prat->pp } }
-        , m_q{ Number{ prat->pq } }
     {
+        PRAT copy = nullptr;
+        DUPRAT(copy, prat);
+
+        m_rat = Share(copy);
     }
 
-    PRAT Rational::ToPRAT() const
+    Rational::Rational(shared_ptr<RatStorage> rat) noexcept
+        : m_rat{ move(rat) }
     {
-        PRAT ret = _createrat();
+    }
 
-        ret->pp = this->P().ToPNUMBER();
-        ret->pq = this->Q().ToPNUMBER();
+    shared_ptr<Rational::RatStorage> Rational::Share(PRAT prat)
+    {
+        KeepQPositive(prat);
 
-        return ret;
+        try
+        {
+            return make_shared<RatStorage>(prat);
+        }
+        catch (...)
+        {
+            destroyrat(prat);
+            throw;
+        }
     }
 
-    Number const& Rational::P() const
+    PRAT Rational::ToPRAT() const
     {
-        return m_p;
+        PRAT ret = nullptr;
+        DUPRAT(ret, m_rat->prat);
+
+        return ret;
     }
 
-    Number const& Rational::Q() const
+    Rational Rational::Attach(PRAT& prat)
     {
-        return m_q;
+        PRAT taken = prat;
+        prat = nullptr;
+
+        return Rational{ Share(taken) };
     }
 
-    Rational Rational::operator-() const
+    PRAT Rational::GetPRAT() const noexcept
     {
-        return Rational{ Number{ -1 * m_p.Sign(), m_p.Exp(), m_p.Mantissa() }, m_q };
+        return m_rat->prat;
     }
 
-    Rational& Rational::operator+=(Rational const& rhs)
+    PRAT* Rational::GetMutablePRAT()
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
-        {
-            addrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
+        if (m_rat.use_count() != 1)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
+            PRAT copy = nullptr;
+            DUPRAT(copy, m_rat->prat);
+            m_rat = Share(copy);
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return &m_rat->prat;
     }
 
-    Rational& Rational::operator-=(Rational const& rhs)
+    template <typename TOperation>
+    Rational& Rational::Update(Rational const& rhs, TOperation operation)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        // The operation works on a copy so that this Rational keeps its value when it throws, and so that rhs is
+        // left alone when the two share it.
+        PRAT result = nullptr;
+        DUPRAT(result, m_rat->prat);
 
         try
         {
-            subrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
+            operation(&result, rhs.m_rat->prat);
         }
         catch (uint32_t error)
         {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
+            destroyrat(result);
             throw(error);
         }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+        if (m_rat.use_count() == 1)
+        {
+            KeepQPositive(result);
+            swap(m_rat->prat, result);
+            destroyrat(result);
+        }
+        else
+        {
+            m_rat = Share(result);
+        }
 
         return *this;
     }
 
-    Rational& Rational::operator*=(Rational const& rhs)
+    Number Rational::P() const
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        return Number{ shared_ptr<NUMBER const>{ m_rat, m_rat->prat->pp } };
+    }
 
-        try
-        {
-            mulrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
+    Number Rational::Q() const
+    {
+        return Number{ shared_ptr<NUMBER const>{ m_rat, m_rat->prat->pq } };
+    }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+    Rational Rational::operator-() const
+    {
+        Rational result{ *this };
+        (*result.GetMutablePRAT())->pp->sign *= -1;
 
-        return *this;
+        return result;
     }
 
-    Rational& Rational::operator/=(Rational const& rhs)
+    Rational& Rational::operator+=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
+        return Update(rhs, [](PRAT* pa, PRAT b) { addrat(pa, b, RATIONAL_PRECISION); });
+    }
 
-        try
-        {
-            divrat(&lhsRat, rhsRat, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
+    Rational& Rational::operator-=(Rational const& rhs)
+    {
+        return Update(rhs, [](PRAT* pa, PRAT b) { subrat(pa, b, RATIONAL_PRECISION); });
+    }
 
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
+    Rational& Rational::operator*=(Rational const& rhs)
+    {
+        return Update(rhs, [](PRAT* pa, PRAT b) { mulrat(pa, b, RATIONAL_PRECISION); });
+    }
 
-        return *this;
+    Rational& Rational::operator/=(Rational const& rhs)
+    {
+        return Update(rhs, [](PRAT* pa, PRAT b) { divrat(pa, b, RATIONAL_PRECISION); });
     }
 
     /// <summary>
@@ -193,138 +244,32 @@ namespace CalcEngine
     /// </remarks>
     Rational& Rational::operator%=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
-        {
-            remrat(&lhsRat, rhsRat);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return Update(rhs, [](PRAT* pa, PRAT b) { remrat(pa, b); });
     }
 
     Rational& Rational::operator<<=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
-        {
-            lshrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return Update(rhs, [](PRAT* pa, PRAT b) { lshrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
     }
 
     Rational& Rational::operator>>=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
-        {
-            rshrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return Update(rhs, [](PRAT* pa, PRAT b) { rshrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
     }
 
     Rational& Rational::operator&=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        try
-        {
-            andrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return Update(rhs, [](PRAT* pa, PRAT b) { andrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
     }
 
     Rational& Rational::operator|=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-        try
-        {
-            orrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return Update(rhs, [](PRAT* pa, PRAT b) { orrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
     }
 
     Rational& Rational::operator^=(Rational const& rhs)
     {
-        PRAT lhsRat = this->ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-        try
-        {
-            xorrat(&lhsRat, rhsRat, RATIONAL_BASE, RATIONAL_PRECISION);
-            destroyrat(rhsRat);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        *this = Rational{ lhsRat };
-        destroyrat(lhsRat);
-
-        return *this;
+        return Update(rhs, [](PRAT* pa, PRAT b) { xorrat(pa, b, RATIONAL_BASE, RATIONAL_PRECISION); });
     }
 
     Rational operator+(Rational lhs, Rational const& rhs)
@@ -396,25 +341,7 @@ namespace CalcEngine
 
     bool operator==(Rational const& lhs, Rational const& rhs)
     {
-        PRAT lhsRat = lhs.ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        bool result = false;
-        try
-        {
-            result = rat_equ(lhsRat, rhsRat, RATIONAL_PRECISION);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        destroyrat(lhsRat);
-        destroyrat(rhsRat);
-
-        return result;
+        return rat_equ(lhs.GetPRAT(), rhs.GetPRAT(), RATIONAL_PRECISION);
     }
 
     bool operator!=(Rational const& lhs, Rational const& rhs)
@@ -424,25 +351,7 @@ namespace CalcEngine
 
     bool operator<(Rational const& lhs, Rational const& rhs)
     {
-        PRAT lhsRat = lhs.ToPRAT();
-        PRAT rhsRat = rhs.ToPRAT();
-
-        bool result = false;
-        try
-        {
-            result = rat_lt(lhsRat, rhsRat, RATIONAL_PRECISION);
-        }
-        catch (uint32_t error)
-        {
-            destroyrat(lhsRat);
-            destroyrat(rhsRat);
-            throw(error);
-        }
-
-        destroyrat(lhsRat);
-        destroyrat(rhsRat);
-
-        return result;
+        return rat_lt(lhs.GetPRAT(), rhs.GetPRAT(), RATIONAL_PRECISION);
     }
 
     bool operator>(Rational const& lhs, Rational const& rhs)
@@ -462,40 +371,51 @@ namespace CalcEngine
 
     wstring Rational::ToString(uint32_t radix, NUMOBJ_FMT fmt, int32_t precision) const
     {
-        PRAT rat = this->ToPRAT();
-        wstring result{};
+        PRAT rat = m_rat->prat;
+        return RatToString(rat, fmt, radix, precision);
+    }
 
-        try
-        {
-            result = RatToString(rat, fmt, radix, precision);
-        }
-        catch (uint32_t error)
+    uint64_t Rational::ToUInt64_t() const
+    {
+        uint64_t lowBits;
+        bool isNegative;
+        bool isWhole;
+        if (TryGetIntegerBits(lowBits, isNegative, isWhole) && (!isNegative || lowBits == 0))
         {
-            destroyrat(rat);
-            throw(error);
+            return lowBits;
         }
 
-        destroyrat(rat);
-
-        return result;
+        return rattoUi64(m_rat->prat, RATIONAL_BASE, RATIONAL_PRECISION);
     }
 
-    uint64_t Rational::ToUInt64_t() const
+    bool Rational::TryGetIntegerBits(uint64_t& lowBits, bool& isNegative, bool& isWhole) const
     {
-        PRAT rat = this->ToPRAT();
-        uint64_t result;
-        try
+        PNUMBER p = m_rat->prat->pp;
+        PNUMBER q = m_rat->prat->pq;
+        if (q->cdigit != 1 || q->mant[0] != 1 || q->exp != 0)
         {
-            result = rattoUi64(rat, RATIONAL_BASE, RATIONAL_PRECISION);
+            return false;
         }
-        catch (uint32_t error)
+
+        lowBits = 0;
+        isNegative = false;
+        isWhole = true;
+        if (zernum(p))
         {
-            destroyrat(rat);
-            throw(error);
+            return true;
         }
 
-        destroyrat(rat);
+        if (p->exp < 0)
+        {
+            return false;
+        }
 
-        return result;
+        for (int32_t i = 0; i < p->cdigit && i + p->exp < 2; i++)
+        {
+            lowBits |= static_cast<uint64_t>(p->mant[i]) << ((i + p->exp) * BASEXPWR);
+        }
+        isNegative = p->sign * q->sign < 0;
+        isWhole = p->cdigit + p->exp <= 2;
+        return true;
     }
 }
@@ -6,6 +6,110 @@
 using namespace std;
 using namespace CalcEngine;
 
+namespace
+{
+    // Digits beyond the display precision of the first adaptive evaluation.
+    constexpr int32_t ADAPTIVE_GUARD_DIGITS = 8;
+
+    // Replaces a copy of rat by function of it at precision.
+    template <typename Function>
+    Rational EvaluateAt(Rational const& rat, int32_t precision, Function function)
+    {
+        PRAT prat = rat.ToPRAT();
+        try
+        {
+            function(&prat, precision);
+        }
+        catch (uint32_t error)
+        {
+            destroyrat(prat);
+            throw(error);
+        }
+
+        return Rational::Attach(prat);
+    }
+
+    // rat divided out to cdigit BASEX digits, so that arithmetic on it costs little however long p and q are.
+    Rational Shortened(Rational const& rat, int32_t cdigit)
+    {
+        PRAT prat = nullptr;
+        createrat(prat);
+        prat->pp = RatToNumberx(rat.GetPRAT(), cdigit);
+        prat->pq = i32tonum(1, BASEX);
+
+        return Rational::Attach(prat);
+    }
+
+    // Whether every number within the gap between rat and previous shows the same digits as rat, in fixed and in
+    // scientific format.  The gap is widened by a unit past the guard digits of rat, which covers both shortening
+    // and RatToStringx truncating where RatToString rounds.
+    bool ShowsSame(Rational const& rat, Rational const& previous, uint32_t radix, int32_t shown)
+    {
+        int32_t cdigit = (shown + ADAPTIVE_GUARD_DIGITS) / g_ratio + 1;
+        Rational shortrat = Shortened(rat, cdigit + 2);
+
+        PRAT unit = shortrat.ToPRAT();
+        unit->pp->sign = 1;
+        unit->pp->exp -= cdigit;
+        Rational widened = RationalMath::Abs(shortrat - Shortened(previous, cdigit + 2)) + Rational::Attach(unit);
+
+        PRAT low = (shortrat - widened).ToPRAT();
+        PRAT high = (shortrat + widened).ToPRAT();
+        bool same = RatToStringx(low, FMT_FLOAT, radix, shown) == RatToStringx(high, FMT_FLOAT, radix, shown)
+                    && RatToStringx(low, FMT_SCIENTIFIC, radix, shown) == RatToStringx(high, FMT_SCIENTIFIC, radix, shown);
+        destroyrat(low);
+        destroyrat(high);
+
+        return same;
+    }
+
+    // Evaluates function at RATIONAL_PRECISION, or in adaptive mode first at the display precision plus guard digits
+    // and again with as many more.  The gap between the two bounds the error of the second, if it shows the same
+    // digits anywhere within the gap it is the result.  Otherwise the precision doubles until RATIONAL_PRECISION.
+    template <typename Function>
+    Rational Evaluate(Rational const& rat, Function function)
+    {
+        RATPAKCONTEXT context = getratpakcontext();
+        if (context.fadaptive && !context.ftrueinfinite && context.constants != nullptr)
+        {
+            uint32_t radix = context.constants->radix;
+            int32_t shown = context.constants->precision;
+            try
+            {
+                int32_t precision = shown + ADAPTIVE_GUARD_DIGITS;
+                Rational previous = EvaluateAt(rat, precision, function);
+                for (precision += ADAPTIVE_GUARD_DIGITS; precision < RATIONAL_PRECISION; precision *= 2)
+                {
+                    Rational result = EvaluateAt(rat, precision, function);
+                    if (ShowsSame(result, previous, radix, shown))
+                    {
+                        return result;
+                    }
+                    previous = move(result);
+                }
+            }
+            catch (uint32_t)
+            {
+                // Evaluated again below, which reports the error if there is one.
+            }
+        }
+
+        return EvaluateAt(rat, RATIONAL_PRECISION, function);
+    }
+}
+
+void RationalMath::SetAdaptivePrecision(bool adaptive)
+{
+    RATPAKCONTEXT context = getratpakcontext();
+    context.fadaptive = adaptive;
+    setratpakcontext(context);
+}
+
+bool RationalMath::IsAdaptivePrecision()
+{
+    return getratpakcontext().fadaptive;
+}
+
 Rational RationalMath::Frac(Rational const& rat)
 {
     PRAT prat = rat.ToPRAT();
@@ -19,10 +123,7 @@ Rational RationalMath::Frac(Rational const& rat)
         throw(error);
     }
 
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Rational::Attach(prat);
 }
 
 Rational RationalMath::Integer(Rational const& rat)
@@ -38,33 +139,24 @@ Rational RationalMath::Integer(Rational const& rat)
         throw(error);
     }
 
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Rational::Attach(prat);
 }
 
 Rational RationalMath::Pow(Rational const& base, Rational const& pow)
 {
     PRAT baseRat = base.ToPRAT();
-    PRAT powRat = pow.ToPRAT();
 
     try
     {
-        powrat(&baseRat, powRat, RATIONAL_BASE, RATIONAL_PRECISION);
-        destroyrat(powRat);
+        powrat(&baseRat, pow.GetPRAT(), RATIONAL_BASE, RATIONAL_PRECISION);
     }
     catch (uint32_t error)
     {
         destroyrat(baseRat);
-        destroyrat(powRat);
         throw(error);
     }
 
-    Rational result{ baseRat };
-    destroyrat(baseRat);
-
-    return result;
+    return Rational::Attach(baseRat);
 }
 
 Rational RationalMath::Root(Rational const& base, Rational const& root)
@@ -86,50 +178,17 @@ Rational RationalMath::Fact(Rational const& rat)
         throw(error);
     }
 
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Rational::Attach(prat);
 }
 
 Rational RationalMath::Exp(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        exprat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { exprat(prat, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::Log(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        lograt(&prat, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { lograt(prat, precision); });
 }
 
 Rational RationalMath::Log10(Rational const& rat)
@@ -144,247 +203,71 @@ Rational RationalMath::Invert(Rational const& rat)
 
 Rational RationalMath::Abs(Rational const& rat)
 {
-    return Rational{ Number{ 1, rat.P().Exp(), rat.P().Mantissa() }, Number{ 1, rat.Q().Exp(), rat.Q().Mantissa() } };
+    PRAT prat = rat.ToPRAT();
+    prat->pp->sign = 1;
+    prat->pq->sign = 1;
+
+    return Rational::Attach(prat);
 }
 
 Rational RationalMath::Sin(Rational const& rat, ANGLE_TYPE angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        sinanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [angletype](PRAT* prat, int32_t precision) { sinanglerat(prat, angletype, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::Cos(Rational const& rat, ANGLE_TYPE angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        cosanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [angletype](PRAT* prat, int32_t precision) { cosanglerat(prat, angletype, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::Tan(Rational const& rat, ANGLE_TYPE angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        tananglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [angletype](PRAT* prat, int32_t precision) { tananglerat(prat, angletype, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::ASin(Rational const& rat, ANGLE_TYPE angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        asinanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [angletype](PRAT* prat, int32_t precision) { asinanglerat(prat, angletype, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::ACos(Rational const& rat, ANGLE_TYPE angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        acosanglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [angletype](PRAT* prat, int32_t precision) { acosanglerat(prat, angletype, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::ATan(Rational const& rat, ANGLE_TYPE angletype)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        atananglerat(&prat, angletype, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [angletype](PRAT* prat, int32_t precision) { atananglerat(prat, angletype, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::Sinh(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        sinhrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { sinhrat(prat, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::Cosh(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        coshrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { coshrat(prat, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::Tanh(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        tanhrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { tanhrat(prat, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::ASinh(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        asinhrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { asinhrat(prat, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::ACosh(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        acoshrat(&prat, RATIONAL_BASE, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { acoshrat(prat, RATIONAL_BASE, precision); });
 }
 
 Rational RationalMath::ATanh(Rational const& rat)
 {
-    PRAT prat = rat.ToPRAT();
-
-    try
-    {
-        atanhrat(&prat, RATIONAL_PRECISION);
-    }
-    catch (uint32_t error)
-    {
-        destroyrat(prat);
-        throw(error);
-    }
-
-    Rational result{ prat };
-    destroyrat(prat);
-
-    return result;
+    return Evaluate(rat, [](PRAT* prat, int32_t precision) { atanhrat(prat, precision); });
 }
 
 /// <summary>
@@ -398,21 +281,16 @@ Rational RationalMath::ATanh(Rational const& rat)
 Rational RationalMath::Mod(Rational const& a, Rational const& b)
 {
     PRAT prat = a.ToPRAT();
-    PRAT pn = b.ToPRAT();
 
     try
     {
-        modrat(&prat, pn);
-        destroyrat(pn);
+        modrat(&prat, b.GetPRAT());
     }
     catch (uint32_t error)
     {
         destroyrat(prat);
-        destroyrat(pn);
         throw(error);
     }
 
-    auto res = Rational{ prat };
-    destroyrat(prat);
-    return res;
+    return Rational::Attach(prat);
 }
@@ -98,7 +98,14 @@ CCalcEngine::CCalcEngine(
     , m_numwidth(QWORD_WIDTH)
     , m_HistoryCollector(pCalcDisplay, pHistoryDisplay, DEFAULT_DEC_SEPARATOR)
     , m_groupSeparator(DEFAULT_GRP_SEPARATOR)
+    , m_lastDisplay{ 0, -1, 0, -1, (NUM_WIDTH)-1, false, false, false }
 {
+    // Every engine keeps its own Ratpack context, so engines on different
+    // threads, or switched between on one, do not see each other's radix
+    // and precision.
+    ChangeBaseConstants(DEFAULT_RADIX, DEFAULT_MAX_DIGITS, DEFAULT_PRECISION);
+    m_ratpakContext = getratpakcontext();
+
     InitChopNumbers();
 
     m_dwWordBitWidth = DwWordBitWidthFromeNumWidth(m_numwidth);
@@ -146,11 +153,14 @@ void CCalcEngine::PersistedMemObject(Rational const& memObject)
 
 void CCalcEngine::SettingsChanged()
 {
+    setratpakcontext(m_ratpakContext);
+
     wchar_t lastDec = m_decimalSeparator;
     wstring decStr = m_resourceProvider->GetCEngineString(L"sDecimal");
     m_decimalSeparator = decStr.empty() ? DEFAULT_DEC_SEPARATOR : decStr.at(0);
     // Until it can be removed, continue to set ratpak decimal here
     SetDecimalSeparator(m_decimalSeparator);
+    m_ratpakContext = getratpakcontext();
 
     wchar_t lastSep = m_groupSeparator;
     wstring sepStr = m_resourceProvider->GetCEngineString(L"sThousand");
@@ -175,8 +185,12 @@ void CCalcEngine::SettingsChanged()
         m_input.SetDecimalSymbol(m_decimalSeparator);
         m_HistoryCollector.SetDecimalSymbol(m_decimalSeparator);
 
-        // put the new decimal symbol into the table used to draw the decimal key
-        s_engineStrings[SIDS_DECIMAL_SEPARATOR] = m_decimalSeparator;
+        // put the new decimal symbol into the table used to draw the decimal key, the table
+        // is shared so only write it when it actually changes
+        if (GetString(SIDS_DECIMAL_SEPARATOR) != wstring_view{ &m_decimalSeparator, 1 })
+        {
+            s_engineStrings[SIDS_DECIMAL_SEPARATOR] = m_decimalSeparator;
+        }
 
         // we need to redraw to update the decimal point button
         numChanged = true;
@@ -93,6 +93,8 @@ void CCalcEngine::ClearDisplay()
 
 void CCalcEngine::ProcessCommand(OpCode wParam)
 {
+    setratpakcontext(m_ratpakContext);
+
     if (wParam == IDC_SET_RESULT)
     {
         wParam = IDC_RECALL;
@@ -752,13 +754,12 @@ void CCalcEngine::ProcessCommandWorker(OpCode wParam)
             auto rat = StringToRat(false, str.str(), false, L"", m_radix, m_precision);
             if (rat != nullptr)
             {
-                m_currentVal = Rational{ rat };
+                m_currentVal = Rational::Attach(rat);
             }
             else
             {
                 m_currentVal = Rational{ 0 };
             }
-            destroyrat(rat);
 
             DisplayNum();
             m_bInv = false;
@@ -1056,6 +1057,7 @@ wstring_view CCalcEngine::OpCodeToBinaryString(int nOpCode, bool isIntegerMode)
 
 bool CCalcEngine::IsCurrentTooBigForTrig()
 {
+    setratpakcontext(m_ratpakContext);
     return m_currentVal >= m_maxTrigonometricNum;
 }
 
@@ -1066,16 +1068,18 @@ int CCalcEngine::GetCurrentRadix()
 
 wstring CCalcEngine::GetCurrentResultForRadix(uint32_t radix, int32_t precision, bool groupDigitsPerRadix)
 {
+    setratpakcontext(m_ratpakContext);
     Rational rat = (m_bRecord ? m_input.ToRational(m_radix, m_precision) : m_currentVal);
 
+    RATPAKCONTEXT savedContext = m_ratpakContext;
     ChangeConstants(m_radix, precision);
+    m_ratpakContext = getratpakcontext();
 
     wstring numberString = GetStringForDisplay(rat, radix);
-    if (!numberString.empty())
-    {
-        // Revert the precision to previously stored precision
-        ChangeConstants(m_radix, m_precision);
-    }
+
+    // Revert the precision to previously stored precision
+    m_ratpakContext = savedContext;
+    setratpakcontext(m_ratpakContext);
 
     if (groupDigitsPerRadix)
     {
@@ -1089,6 +1093,8 @@ wstring CCalcEngine::GetCurrentResultForRadix(uint32_t radix, int32_t precision,
 
 wstring CCalcEngine::GetStringForDisplay(Rational const& rat, uint32_t radix)
 {
+    setratpakcontext(m_ratpakContext);
+
     wstring result{};
     // Check for standard\scientific mode
     if (!m_fIntegerMode)
@@ -33,22 +33,6 @@ constexpr wstring_view c_decPostSepStr = L"]?(\\d*)(?:e[+-]?(\\d*))?$";
 * Updates the following variables:
 *   m_currentVal, m_numberString
 \****************************************************************************/
-//
-// State of calc last time DisplayNum was called
-//
-typedef struct
-{
-    Rational value;
-    int32_t precision;
-    uint32_t radix;
-    int nFE;
-    NUM_WIDTH numwidth;
-    bool fIntMath;
-    bool bRecord;
-    bool bUseSep;
-} LASTDISP;
-
-static LASTDISP gldPrevious = { 0, -1, 0, -1, (NUM_WIDTH)-1, false, false, false };
 
 // Truncates if too big, makes it a non negative - the number in rat. Doesn't do anything if not in INT mode
 CalcEngine::Rational CCalcEngine::TruncateNumForIntMath(CalcEngine::Rational const& rat)
@@ -58,6 +42,15 @@ CalcEngine::Rational CCalcEngine::TruncateNumForIntMath(CalcEngine::Rational con
         return rat;
     }
 
+    // Integers need nothing but their low bits, negative ones in 2's complement form.
+    uint64_t lowBits;
+    bool isNegative;
+    bool isWhole;
+    if (rat.TryGetIntegerBits(lowBits, isNegative, isWhole))
+    {
+        return Rational{ (isNegative ? 0 - lowBits : lowBits) & WordMask() };
+    }
+
     // Truncate to an integer. Do not round here.
     auto result = RationalMath::Integer(rat);
 
@@ -75,6 +68,20 @@ CalcEngine::Rational CCalcEngine::TruncateNumForIntMath(CalcEngine::Rational con
     return result;
 }
 
+uint64_t CCalcEngine::WordMask() const
+{
+    return m_dwWordBitWidth >= 64 ? UINT64_MAX : (uint64_t{ 1 } << m_dwWordBitWidth) - 1;
+}
+
+// Gets the word rat holds if it is one as TruncateNumForIntMath leaves it, otherwise false and rat has to go
+// through Rational.
+bool CCalcEngine::TryGetWord(CalcEngine::Rational const& rat, uint64_t& word) const
+{
+    bool isNegative;
+    bool isWhole;
+    return rat.TryGetIntegerBits(word, isNegative, isWhole) && isWhole && (!isNegative || word == 0) && (word & ~WordMask()) == 0;
+}
+
 void CCalcEngine::DisplayNum(void)
 {
     //
@@ -84,17 +91,17 @@ void CCalcEngine::DisplayNum(void)
     //  something important has changed since the last time DisplayNum was
     //  called.
     //
-    if (m_bRecord || gldPrevious.value != m_currentVal || gldPrevious.precision != m_precision || gldPrevious.radix != m_radix || gldPrevious.nFE != (int)m_nFE
-        || gldPrevious.bUseSep != true || gldPrevious.numwidth != m_numwidth || gldPrevious.fIntMath != m_fIntegerMode || gldPrevious.bRecord != m_bRecord)
+    if (m_bRecord || m_lastDisplay.value != m_currentVal || m_lastDisplay.precision != m_precision || m_lastDisplay.radix != m_radix || m_lastDisplay.nFE != (int)m_nFE
+        || m_lastDisplay.bUseSep != true || m_lastDisplay.numwidth != m_numwidth || m_lastDisplay.fIntMath != m_fIntegerMode || m_lastDisplay.bRecord != m_bRecord)
     {
-        gldPrevious.precision = m_precision;
-        gldPrevious.radix = m_radix;
-        gldPrevious.nFE = (int)m_nFE;
-        gldPrevious.numwidth = m_numwidth;
+        m_lastDisplay.precision = m_precision;
+        m_lastDisplay.radix = m_radix;
+        m_lastDisplay.nFE = (int)m_nFE;
+        m_lastDisplay.numwidth = m_numwidth;
 
-        gldPrevious.fIntMath = m_fIntegerMode;
-        gldPrevious.bRecord = m_bRecord;
-        gldPrevious.bUseSep = true;
+        m_lastDisplay.fIntMath = m_fIntegerMode;
+        m_lastDisplay.bRecord = m_bRecord;
+        m_lastDisplay.bUseSep = true;
 
         if (m_bRecord)
         {
@@ -112,7 +119,7 @@ void CCalcEngine::DisplayNum(void)
         }
 
         // Displayed number can go through transformation. So copy it after transformation
-        gldPrevious.value = m_currentVal;
+        m_lastDisplay.value = m_currentVal;
 
         if ((m_radix == 10) && IsNumberInvalid(m_numberString, MAX_EXPONENT, m_precision, m_radix))
         {
@@ -25,6 +25,14 @@ using namespace CalcEngine::RationalMath;
 /* Routines for more complex mathematical functions/error checking. */
 CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& rat, uint32_t op)
 {
+    // Integer mode bit operations work on the word itself.
+    uint64_t word;
+    uint64_t resultWord;
+    if (m_fIntegerMode && TryGetWord(rat, word) && TryDoWordFunction(op, word, resultWord))
+    {
+        return Rational{ resultWord };
+    }
+
     Rational result{};
     try
     {
@@ -289,6 +297,45 @@ CalcEngine::Rational CCalcEngine::SciCalcFunctions(CalcEngine::Rational const& r
     return result;
 }
 
+// The complement and rotates of SciCalcFunctions on an integer mode word, truncated to the word. Returns false for
+// the other functions, those go through Rational.
+bool CCalcEngine::TryDoWordFunction(uint32_t op, uint64_t word, uint64_t& result)
+{
+    uint64_t mask = WordMask();
+    uint64_t msb = (word >> (m_dwWordBitWidth - 1)) & 1;
+    uint64_t lsb = word & 1;
+
+    switch (op)
+    {
+    case IDC_COM:
+        result = ~word & mask;
+        break;
+
+    case IDC_ROL:
+        result = ((word << 1) | msb) & mask;
+        break;
+
+    case IDC_ROLC:
+        result = ((word << 1) | m_carryBit) & mask;
+        m_carryBit = msb;
+        break;
+
+    case IDC_ROR:
+        result = (word >> 1) | (lsb << (m_dwWordBitWidth - 1));
+        break;
+
+    case IDC_RORC:
+        result = (word >> 1) | (m_carryBit << (m_dwWordBitWidth - 1));
+        m_carryBit = lsb;
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
 /* Routine to display error messages and set m_bError flag.  Errors are */
 /* called with DisplayError (n), where n is a uint32_t   between 0 and 5. */
 
@@ -9,6 +9,26 @@ using namespace CalcEngine::RationalMath;
 // Routines to perform standard operations &|^~<<>>+-/*% and pwr.
 CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rational const& lhs, CalcEngine::Rational const& rhs)
 {
+    // Integer mode operands are words, work on those and leave the result as DisplayNum would.
+    uint64_t lhsWord;
+    uint64_t rhsWord;
+    if (m_fIntegerMode && TryGetWord(lhs, lhsWord) && TryGetWord(rhs, rhsWord))
+    {
+        try
+        {
+            uint64_t resultWord;
+            if (TryDoWordOperation(operation, lhsWord, rhsWord, resultWord))
+            {
+                return Rational{ resultWord };
+            }
+        }
+        catch (uint32_t dwErrCode)
+        {
+            DisplayError(dwErrCode);
+            return lhs;
+        }
+    }
+
     // Remove any variance in how 0 could be represented in rat e.g. -0, 0/n, etc.
     auto result = (lhs != 0 ? lhs : 0);
 
@@ -173,3 +193,108 @@ CalcEngine::Rational CCalcEngine::DoOperation(int operation, CalcEngine::Rationa
 
     return result;
 }
+
+// The operations of DoOperation on integer mode words, truncated to the word. The operands are in the same order,
+// lhs is the number entered last. Returns false for operations integers don't have, those go through Rational.
+bool CCalcEngine::TryDoWordOperation(int operation, uint64_t lhs, uint64_t rhs, uint64_t& result)
+{
+    uint64_t mask = WordMask();
+    uint64_t msb = uint64_t{ 1 } << (m_dwWordBitWidth - 1);
+
+    switch (operation)
+    {
+    case IDC_AND:
+        result = rhs & lhs;
+        break;
+
+    case IDC_OR:
+        result = rhs | lhs;
+        break;
+
+    case IDC_XOR:
+        result = rhs ^ lhs;
+        break;
+
+    case IDC_NAND:
+        result = ~(rhs & lhs) & mask;
+        break;
+
+    case IDC_NOR:
+        result = ~(rhs | lhs) & mask;
+        break;
+
+    case IDC_RSHF:
+    case IDC_RSHFL:
+    case IDC_LSHF:
+        if (lhs >= static_cast<uint64_t>(m_dwWordBitWidth)) // Lsh/Rsh >= than current word size is always 0
+        {
+            throw CALC_E_NORESULT;
+        }
+
+        if (operation == IDC_LSHF)
+        {
+            result = (rhs << lhs) & mask;
+        }
+        else
+        {
+            result = rhs >> lhs;
+            if (operation == IDC_RSHF && (rhs & msb))
+            {
+                // Arithmetic shift, fill with the sign bit.
+                result |= mask & ~(mask >> lhs);
+            }
+        }
+        break;
+
+    case IDC_ADD:
+        result = (rhs + lhs) & mask;
+        break;
+
+    case IDC_SUB:
+        result = (rhs - lhs) & mask;
+        break;
+
+    case IDC_MUL:
+        result = (rhs * lhs) & mask;
+        break;
+
+    case IDC_DIV:
+    case IDC_MOD:
+    {
+        // Signed, rhs divided by lhs, truncated toward zero.
+        bool fNumeratorNegative = (rhs & msb) != 0;
+        bool fDenominatorNegative = (lhs & msb) != 0;
+        uint64_t numerator = fNumeratorNegative ? (0 - rhs) & mask : rhs;
+        uint64_t denominator = fDenominatorNegative ? (0 - lhs) & mask : lhs;
+
+        if (denominator == 0)
+        {
+            throw (operation == IDC_DIV && numerator != 0) ? CALC_E_DIVIDEBYZERO : CALC_E_INDEFINITE;
+        }
+
+        if (operation == IDC_DIV)
+        {
+            result = numerator / denominator;
+            if (fNumeratorNegative != fDenominatorNegative)
+            {
+                result = (0 - result) & mask;
+            }
+        }
+        else
+        {
+            // Programmer mode, the remainder has the sign of the numerator
+            result = numerator % denominator;
+            if (fNumeratorNegative)
+            {
+                result = (0 - result) & mask;
+            }
+        }
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    return true;
+}
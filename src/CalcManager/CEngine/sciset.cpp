@@ -175,5 +175,7 @@ void CCalcEngine::ChangeBaseConstants(uint32_t radix, int maxIntDigits, int32_t
 void CCalcEngine::BaseOrPrecisionChanged()
 {
     UpdateMaxIntDigits();
+    setratpakcontext(m_ratpakContext);
     CCalcEngine::ChangeBaseConstants(m_radix, m_cIntDigitsSav, m_precision);
+    m_ratpakContext = getratpakcontext();
 }
@@ -171,6 +171,7 @@ namespace CalculationManager
         m_currentCalculatorEngine->ProcessCommand(IDC_DEC);
         m_currentCalculatorEngine->ProcessCommand(IDC_CLEAR);
         m_currentCalculatorEngine->ChangePrecision(static_cast<int>(CalculatorPrecision::StandardModePrecision));
+        m_currentCalculatorEngine->ChangeAdaptivePrecision(true);
         UpdateMaxIntDigits();
         m_pHistory = m_pStdHistory.get();
     }
@@ -190,6 +191,7 @@ namespace CalculationManager
         m_currentCalculatorEngine->ProcessCommand(IDC_DEC);
         m_currentCalculatorEngine->ProcessCommand(IDC_CLEAR);
         m_currentCalculatorEngine->ChangePrecision(static_cast<int>(CalculatorPrecision::ScientificModePrecision));
+        m_currentCalculatorEngine->ChangeAdaptivePrecision(true);
         m_pHistory = m_pSciHistory.get();
     }
 
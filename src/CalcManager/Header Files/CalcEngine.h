@@ -41,6 +41,21 @@ enum eNUM_WIDTH
 typedef enum eNUM_WIDTH NUM_WIDTH;
 static constexpr size_t NUM_WIDTH_LENGTH = 4;
 
+//
+// State of calc last time DisplayNum was called
+//
+typedef struct
+{
+    CalcEngine::Rational value;
+    int32_t precision;
+    uint32_t radix;
+    int nFE;
+    NUM_WIDTH numwidth;
+    bool fIntMath;
+    bool bRecord;
+    bool bUseSep;
+} LASTDISP;
+
 namespace CalculationManager
 {
     class IResourceProvider;
@@ -83,7 +98,13 @@ public:
     void ChangePrecision(int32_t precision)
     {
         m_precision = precision;
+        setratpakcontext(m_ratpakContext);
         ChangeConstants(m_radix, precision);
+        m_ratpakContext = getratpakcontext();
+    }
+    void ChangeAdaptivePrecision(bool adaptive)
+    {
+        m_ratpakContext.fadaptive = adaptive;
     }
     std::wstring GroupDigitsPerRadix(std::wstring_view numberString, uint32_t radix);
     std::wstring GetStringForDisplay(CalcEngine::Rational const& rat, uint32_t radix);
@@ -96,11 +117,13 @@ public:
     // returns the ptr to string representing the operator. Mostly same as the button, but few special cases for x^y etc.
     static std::wstring_view GetString(int ids)
     {
-        return s_engineStrings[std::to_wstring(ids)];
+        return GetString(std::to_wstring(ids));
     }
     static std::wstring_view GetString(std::wstring_view ids)
     {
-        return s_engineStrings[ids];
+        // Look up without inserting, engines on other threads may be reading the table.
+        auto it = s_engineStrings.find(ids);
+        return it != s_engineStrings.end() ? std::wstring_view{ it->second } : std::wstring_view{};
     }
     static std::wstring_view OpCodeToString(int nOpCode)
     {
@@ -137,6 +160,7 @@ private:
 
     uint32_t m_radix;
     int32_t m_precision;
+    RATPAKCONTEXT m_ratpakContext; // Ratpack state for m_radix and m_precision, set on the thread by each call that does math
     int m_cIntDigitsSav;
     std::vector<uint32_t> m_decGrouping; // Holds the decimal digit grouping number
 
@@ -164,6 +188,7 @@ private:
     static std::unordered_map<std::wstring_view, std::wstring> s_engineStrings; // the string table shared across all instances
     wchar_t m_decimalSeparator;
     wchar_t m_groupSeparator;
+    LASTDISP m_lastDisplay; // State of calc last time DisplayNum was called
 
 private:
     void ProcessCommandWorker(OpCode wParam);
@@ -179,6 +204,12 @@ private:
     CalcEngine::Rational TruncateNumForIntMath(CalcEngine::Rational const& rat);
     CalcEngine::Rational SciCalcFunctions(CalcEngine::Rational const& rat, uint32_t op);
     CalcEngine::Rational DoOperation(int operation, CalcEngine::Rational const& lhs, CalcEngine::Rational const& rhs);
+
+    // Integer mode on the word itself, in 2's complement form as TruncateNumForIntMath leaves it.
+    uint64_t WordMask() const;
+    bool TryGetWord(CalcEngine::Rational const& rat, uint64_t& word) const;
+    bool TryDoWordOperation(int operation, uint64_t lhs, uint64_t rhs, uint64_t& result);
+    bool TryDoWordFunction(uint32_t op, uint64_t word, uint64_t& result);
     void SetRadixTypeAndNumWidth(RADIX_TYPE radixtype, NUM_WIDTH numwidth);
     int32_t DwWordBitWidthFromeNumWidth(NUM_WIDTH numwidth);
     uint32_t NRadixFromRadixType(RADIX_TYPE radixtype);
@@ -3,11 +3,13 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include "Ratpack/ratpak.h"
 
 namespace CalcEngine
 {
+    // A Ratpack number.  It is never changed once made, so copies share it.
     class Number
     {
     public:
@@ -19,13 +21,15 @@ namespace CalcEngine
 
         int32_t const& Sign() const;
         int32_t const& Exp() const;
-        std::vector<uint32_t> const& Mantissa() const;
+        std::vector<uint32_t> Mantissa() const;
 
         bool IsZero() const;
 
     private:
-        int32_t m_sign;
-        int32_t m_exp;
-        std::vector<uint32_t> m_mantissa;
+        friend class Rational;
+
+        explicit Number(std::shared_ptr<NUMBER const> number) noexcept;
+
+        std::shared_ptr<NUMBER const> m_number;
     };
 }
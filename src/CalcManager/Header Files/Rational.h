@@ -27,8 +27,15 @@ namespace CalcEngine
         explicit Rational(PRAT prat) noexcept;
         PRAT ToPRAT() const;
 
-        Number const& P() const;
-        Number const& Q() const;
+        // Takes over prat without copying it and sets it to nullptr.
+        static Rational Attach(PRAT& prat);
+
+        // The Ratpack rational itself, valid as long as this Rational is neither changed nor destroyed.  Only for
+        // Ratpack functions that leave it as it is, the value may be shared with other copies.
+        PRAT GetPRAT() const noexcept;
+
+        Number P() const;
+        Number Q() const;
 
         Rational operator-() const;
         Rational& operator+=(Rational const& rhs);
@@ -67,8 +74,26 @@ namespace CalcEngine
         std::wstring ToString(uint32_t radix, NUMOBJ_FMT format, int32_t precision) const;
         uint64_t ToUInt64_t() const;
 
+        // For an integer over a one, reads the low 64 bits of its magnitude straight off the digits and says whether
+        // those are all of it. Returns false for anything else.
+        bool TryGetIntegerBits(uint64_t& lowBits, bool& isNegative, bool& isWhole) const;
+
     private:
-        Number m_p;
-        Number m_q;
+        // Copies share the Ratpack rational, the first change to a shared one copies it.  Its q is kept positive so
+        // that Ratpack never has a reason to write to it while it is read as an operand.
+        struct RatStorage;
+
+        explicit Rational(std::shared_ptr<RatStorage> rat) noexcept;
+        static std::shared_ptr<RatStorage> Share(PRAT prat);
+
+        PRAT* GetMutablePRAT();
+
+        // Runs a Ratpack function that changes its first operand on a copy of this Rational's value, and keeps the
+        // result only when it returns.  Ratpack functions can throw after writing part of their operand, divrat has
+        // multiplied out both p and q before it finds a zero divisor, so if it throws this Rational is unchanged.
+        template <typename TOperation>
+        Rational& Update(Rational const& rhs, TOperation operation);
+
+        std::shared_ptr<RatStorage> m_rat;
     };
 }
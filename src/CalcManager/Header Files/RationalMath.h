@@ -7,6 +7,11 @@
 
 namespace CalcEngine::RationalMath
 {
+    // In adaptive mode the functions from Exp on are evaluated at the display precision of the calling thread's
+    // constants plus guard digits, and only at RATIONAL_PRECISION when that result can't be rounded for display.
+    void SetAdaptivePrecision(bool adaptive);
+    bool IsAdaptivePrecision();
+
     Rational Frac(Rational const& rat);
     Rational Integer(Rational const& rat);
 
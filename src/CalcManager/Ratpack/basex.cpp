@@ -15,7 +15,12 @@
 //
 //-----------------------------------------------------------------------------
 #include "ratpak.h"
-#include <cstring> // for memmove
+#include <cstring> // for memmove, memset
+#include <algorithm>
+#include <vector>
+#include <cmath> // for sqrt
+
+using namespace std;
 
 void _mulnumx(PNUMBER* pa, PNUMBER b);
 
@@ -70,81 +75,52 @@ void mulnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b)
 //    RETURN: None, changes first pointer.
 //
 //    DESCRIPTION: Does the number equivalent of *pa *= b.
-//    Assumes the base is BASEX of both numbers.  This algorithm is the
-//    same one you learned in grade school, except the base isn't 10 it's
-//    BASEX.
+//    Assumes the base is BASEX of both numbers.  The mantissas are
+//    multiplied by _mulmantx which picks an algorithm suited to the size
+//    of the operands.  When the product fits in the buffer of *pa it is
+//    written there, the digits of *pa being set aside in a scratch buffer
+//    first as _mulmantx cannot write over its operands.
 //
 //----------------------------------------------------------------------------
 
+// Scratch copy of the multiplicand of an in place _mulnumx, kept per thread
+// so it only grows to the largest operand seen.
+static thread_local vector<MANTTYPE> t_mulscratch;
+
 void _mulnumx(PNUMBER* pa, PNUMBER b)
 
 {
-    PNUMBER c = nullptr;  // c will contain the result.
-    PNUMBER a = nullptr;  // a is the dereferenced number pointer from *pa
-    MANTTYPE* ptra;       // ptra is a pointer to the mantissa of a.
-    MANTTYPE* ptrb;       // ptrb is a pointer to the mantissa of b.
-    MANTTYPE* ptrc;       // ptrc is a pointer to the mantissa of c.
-    MANTTYPE* ptrcoffset; // ptrcoffset, is the anchor location of the next
-                          // single digit multiply partial result.
-    int32_t iadigit = 0;  // Index of digit being used in the first number.
-    int32_t ibdigit = 0;  // Index of digit being used in the second number.
-    MANTTYPE da = 0;      // da is the digit from the fist number.
-    TWO_MANTTYPE cy = 0;  // cy is the carry resulting from the addition of
-                          // a multiplied row into the result.
-    TWO_MANTTYPE mcy = 0; // mcy is the resultant from a single
-                          // multiply, AND the carry of that multiply.
-    int32_t icdigit = 0;  // Index of digit being calculated in final result.
+    PNUMBER c = nullptr; // c will contain the result.
+    PNUMBER a = nullptr; // a is the dereferenced number pointer from *pa
 
     a = *pa;
 
-    ibdigit = a->cdigit + b->cdigit - 1;
-    createnum(c, ibdigit + 1);
-    c->cdigit = ibdigit;
-    c->sign = a->sign * b->sign;
+    const int32_t ca = a->cdigit;
+    const int32_t cb = b->cdigit;
+    const int32_t sign = a->sign * b->sign;
+    const int32_t exp = a->exp + b->exp;
 
-    c->exp = a->exp + b->exp;
-    ptra = a->mant;
-    ptrcoffset = c->mant;
-
-    for (iadigit = a->cdigit; iadigit > 0; iadigit--)
+    if (a->cdigitmax >= ca + cb)
     {
-        da = *ptra++;
-        ptrb = b->mant;
-
-        // Shift ptrc, and ptrcoffset, one for each digit
-        ptrc = ptrcoffset++;
-
-        for (ibdigit = b->cdigit; ibdigit > 0; ibdigit--)
+        if (t_mulscratch.size() < (size_t)ca)
         {
-            cy = 0;
-            mcy = (uint64_t)da * (*ptrb);
-            if (mcy)
-            {
-                icdigit = 0;
-                if (ibdigit == 1 && iadigit == 1)
-                {
-                    c->cdigit++;
-                }
-            }
-
-            // If result is nonzero, or while result of carry is nonzero...
-            while (mcy || cy)
-            {
-                // update carry from addition(s) and multiply.
-                cy += (TWO_MANTTYPE)ptrc[icdigit] + ((uint32_t)mcy & ((uint32_t)~BASEX));
-
-                // update result digit from
-                ptrc[icdigit++] = (MANTTYPE)((uint32_t)cy & ((uint32_t)~BASEX));
-
-                // update carries from
-                mcy >>= BASEXPWR;
-                cy >>= BASEXPWR;
-            }
-
-            ptrb++;
-            ptrc++;
+            t_mulscratch.resize(ca);
         }
+        memcpy(t_mulscratch.data(), a->mant, ca * sizeof(MANTTYPE));
+        c = a;
+        c->mant = MANTBASE(c);
+        // Squaring stays recognizable to _mulmantx when b is a.
+        const MANTTYPE* pb = (b == a) ? t_mulscratch.data() : b->mant;
+        _mulmantx(c->mant, t_mulscratch.data(), ca, pb, cb);
+    }
+    else
+    {
+        createnum(c, ca + cb);
+        _mulmantx(c->mant, a->mant, ca, b->mant, cb);
     }
+    c->cdigit = ca + cb;
+    c->sign = sign;
+    c->exp = exp;
 
     // prevent different kinds of zeros, by stripping leading duplicate zeros.
     // digits are in order of increasing significance.
@@ -153,210 +129,1817 @@ void _mulnumx(PNUMBER* pa, PNUMBER b)
         c->cdigit--;
     }
 
-    destroynum(*pa);
-    *pa = c;
+    // A zero product, make sure no weird exponents creep in.
+    if (c->cdigit == 1 && c->mant[0] == 0)
+    {
+        c->exp = 0;
+    }
+
+    if (c != a)
+    {
+        destroynum(*pa);
+        *pa = c;
+    }
 }
-//-----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
 //
-//    FUNCTION: numpowi32x
+//  Mantissa multiplication kernels.
 //
-//    ARGUMENTS: root as number power as int32_t
-//               number.
+//  These work on raw BASEX mantissas, digits in order of increasing
+//  significance, and never look at sign or exponent.  The product of a ca
+//  digit and a cb digit mantissa always fits in ca + cb digits.
 //
-//    RETURN: None root is changed.
+//----------------------------------------------------------------------------
+
+// Mask for a single BASEX digit held in a TWO_MANTTYPE
+static constexpr TWO_MANTTYPE MANTMASK = (((TWO_MANTTYPE)1) << BASEXPWR) - 1;
+
+// Size, in BASEX digits of the smaller operand, at which _mulmantx switches
+// from schoolbook to Karatsuba and from Karatsuba to Toom-3 multiplication.
+int32_t g_karatsubaThreshold = KARATSUBA_THRESHOLD;
+int32_t g_toom3Threshold = TOOM3_THRESHOLD;
+
+//----------------------------------------------------------------------------
 //
-//    DESCRIPTION: changes numeric representation of root to
-//    root ** power. Assumes base BASEX
-//    decomposes the exponent into it's sums of powers of 2, so on average
-//    it will take n+n/2 multiplies where n is the highest on bit.
+//    FUNCTION: _addmant
 //
-//-----------------------------------------------------------------------------
+//    ARGUMENTS: result mantissa and digit count, mantissa to add and its
+//               digit count.
+//
+//    RETURN: carry out of the top digit of the result.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pc += pb, where pc is at
+//    least as long as pb.
+//
+//----------------------------------------------------------------------------
 
-void numpowi32x(_Inout_ PNUMBER* proot, int32_t power)
+MANTTYPE _addmant(_Inout_ MANTTYPE* pc, int32_t cc, _In_ const MANTTYPE* pb, int32_t cb)
+{
+    TWO_MANTTYPE cy = 0;
+    int32_t i = 0;
+    for (; i < cb; i++)
+    {
+        cy += (TWO_MANTTYPE)pc[i] + pb[i];
+        pc[i] = (MANTTYPE)(cy & MANTMASK);
+        cy >>= BASEXPWR;
+    }
+    for (; cy && i < cc; i++)
+    {
+        cy += pc[i];
+        pc[i] = (MANTTYPE)(cy & MANTMASK);
+        cy >>= BASEXPWR;
+    }
+    return (MANTTYPE)cy;
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _submant
+//
+//    ARGUMENTS: result mantissa and digit count, mantissa to subtract and
+//               its digit count.
+//
+//    RETURN: borrow out of the top digit of the result.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pc -= pb, where pc is at
+//    least as long as pb.
+//
+//----------------------------------------------------------------------------
 
+MANTTYPE _submant(_Inout_ MANTTYPE* pc, int32_t cc, _In_ const MANTTYPE* pb, int32_t cb)
 {
-    PNUMBER lret = i32tonum(1, BASEX);
+    TWO_MANTTYPE bw = 0;
+    int32_t i = 0;
+    for (; i < cb; i++)
+    {
+        TWO_MANTTYPE d = (TWO_MANTTYPE)pc[i] - pb[i] - bw;
+        pc[i] = (MANTTYPE)(d & MANTMASK);
+        bw = (d >> BASEXPWR) & 1;
+    }
+    for (; bw && i < cc; i++)
+    {
+        TWO_MANTTYPE d = (TWO_MANTTYPE)pc[i] - bw;
+        pc[i] = (MANTTYPE)(d & MANTMASK);
+        bw = (d >> BASEXPWR) & 1;
+    }
+    return (MANTTYPE)bw;
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _cmpmant
+//
+//    ARGUMENTS: two mantissas and their digit counts.
+//
+//    RETURN: -1, 0 or 1 as pa is less than, equal to or greater than pb.
+//
+//----------------------------------------------------------------------------
 
-    // Once the power remaining is zero we are done.
-    while (power > 0)
+int32_t _cmpmant(_In_ const MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb)
+{
+    while (ca > 0 && pa[ca - 1] == 0)
     {
-        // If this bit in the power decomposition is on, multiply the result
-        // by the root number.
-        if (power & 1)
+        ca--;
+    }
+    while (cb > 0 && pb[cb - 1] == 0)
+    {
+        cb--;
+    }
+    if (ca != cb)
+    {
+        return (ca < cb) ? -1 : 1;
+    }
+    while (ca-- > 0)
+    {
+        if (pa[ca] != pb[ca])
         {
-            mulnumx(&lret, *proot);
+            return (pa[ca] < pb[ca]) ? -1 : 1;
         }
+    }
+    return 0;
+}
 
-        // multiply the root number by itself to scale for the next bit (i.e.
-        // square it.
-        mulnumx(proot, *proot);
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _mulmantbase
+//
+//    DESCRIPTION: Schoolbook multiplication, pc = pa * pb.  This is the same
+//    algorithm you learned in grade school, except the base is BASEX and a
+//    row is accumulated with a single carry.  The carry never exceeds one
+//    digit since (BASEX-1)^2 + 2*(BASEX-1) < BASEX^2.
+//
+//----------------------------------------------------------------------------
 
-        // move the next bit of the power into place.
-        power >>= 1;
+static void _mulmantbase(MANTTYPE* pc, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb)
+{
+    memset(pc, 0, sizeof(MANTTYPE) * (ca + cb));
+    for (int32_t ia = 0; ia < ca; ia++)
+    {
+        TWO_MANTTYPE da = pa[ia];
+        if (da == 0)
+        {
+            continue;
+        }
+
+        MANTTYPE* ptrc = pc + ia;
+        TWO_MANTTYPE cy = 0;
+        for (int32_t ib = 0; ib < cb; ib++)
+        {
+            cy += ptrc[ib] + da * pb[ib];
+            ptrc[ib] = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+        ptrc[cb] = (MANTTYPE)cy;
     }
-    destroynum(*proot);
-    *proot = lret;
 }
 
-void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision);
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _sqrmantbase
+//
+//    DESCRIPTION: Schoolbook squaring, pc = pa * pa.  Each cross product
+//    a[i]*a[j] with i < j is only computed once, the sum of them is doubled
+//    and then the squares of the digits are added in.
+//
+//----------------------------------------------------------------------------
+
+static void _sqrmantbase(MANTTYPE* pc, const MANTTYPE* pa, int32_t ca)
+{
+    memset(pc, 0, sizeof(MANTTYPE) * 2 * ca);
+    for (int32_t ia = 0; ia < ca - 1; ia++)
+    {
+        TWO_MANTTYPE da = pa[ia];
+        if (da == 0)
+        {
+            continue;
+        }
+
+        MANTTYPE* ptrc = pc + 2 * ia + 1;
+        TWO_MANTTYPE cy = 0;
+        for (int32_t ib = ia + 1; ib < ca; ib++)
+        {
+            cy += *ptrc + da * pa[ib];
+            *ptrc++ = (MANTTYPE)(cy & MANTMASK);
+            cy >>= BASEXPWR;
+        }
+        *ptrc = (MANTTYPE)cy;
+    }
+
+    // Double the cross products.
+    MANTTYPE shiftin = 0;
+    for (int32_t ic = 0; ic < 2 * ca; ic++)
+    {
+        MANTTYPE d = pc[ic];
+        pc[ic] = (MANTTYPE)((((TWO_MANTTYPE)d << 1) | shiftin) & MANTMASK);
+        shiftin = (MANTTYPE)(d >> (BASEXPWR - 1));
+    }
+
+    // Add in the squares of each digit.
+    TWO_MANTTYPE cy = 0;
+    for (int32_t ia = 0; ia < ca; ia++)
+    {
+        TWO_MANTTYPE sq = (TWO_MANTTYPE)pa[ia] * pa[ia];
+        cy += pc[2 * ia] + (sq & MANTMASK);
+        pc[2 * ia] = (MANTTYPE)(cy & MANTMASK);
+        cy >>= BASEXPWR;
+        cy += pc[2 * ia + 1] + (sq >> BASEXPWR);
+        pc[2 * ia + 1] = (MANTTYPE)(cy & MANTMASK);
+        cy >>= BASEXPWR;
+    }
+}
 
 //----------------------------------------------------------------------------
 //
-//    FUNCTION: divnumx
+//    FUNCTION: _mulmantkara
 //
-//    ARGUMENTS: pointer to a number, a second number and precision.
+//    DESCRIPTION: Karatsuba multiplication, pc = pa * pb, for ca >= cb and
+//    cb > ca/2.  Splitting at m digits,
 //
-//    RETURN: None, changes first pointer.
+//        a = a1*BASEX^m + a0, b = b1*BASEX^m + b0
 //
-//    DESCRIPTION: Does the number equivalent of *pa /= b.
-//    Assumes radix is the internal radix representation.
-//    This is a stub which prevents division by 1, this is a big speed
-//    improvement.
+//        a*b = z2*BASEX^2m + z1*BASEX^m + z0 where
+//          z0 = a0*b0, z2 = a1*b1 and z1 = (a0+a1)*(b0+b1) - z0 - z2
+//
+//    so three half size products replace four.
 //
 //----------------------------------------------------------------------------
 
-void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision)
+static void _mulmantkara(MANTTYPE* pc, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb)
+{
+    const bool fsquare = (pa == pb && ca == cb);
+    const int32_t m = ca / 2;
+    const int32_t ca1 = ca - m;
+    const int32_t cb1 = cb - m;
+
+    // z0 goes in the bottom of the result, z2 in the top.
+    _mulmantx(pc, pa, m, pb, m);
+    _mulmantx(pc + 2 * m, pa + m, ca1, pb + m, cb1);
 
+    // sa = a0 + a1, sb = b0 + b1
+    vector<MANTTYPE> sa(ca1 + 1, 0);
+    copy(pa + m, pa + ca, sa.begin());
+    sa[ca1] = _addmant(sa.data(), ca1, pa, m);
+    int32_t csa = ca1 + (sa[ca1] != 0);
+
+    vector<MANTTYPE> sb;
+    int32_t csb = csa;
+    if (!fsquare)
+    {
+        const int32_t clong = max(m, cb1);
+        sb.assign(clong + 1, 0);
+        if (cb1 >= m)
+        {
+            copy(pb + m, pb + cb, sb.begin());
+            sb[clong] = _addmant(sb.data(), clong, pb, m);
+        }
+        else
+        {
+            copy(pb, pb + m, sb.begin());
+            sb[clong] = _addmant(sb.data(), clong, pb + m, cb1);
+        }
+        csb = clong + (sb[clong] != 0);
+    }
+
+    // z1 = sa * sb - z0 - z2
+    vector<MANTTYPE> z1(csa + csb);
+    _mulmantx(z1.data(), sa.data(), csa, fsquare ? sa.data() : sb.data(), csb);
+    _submant(z1.data(), csa + csb, pc, 2 * m);
+    _submant(z1.data(), csa + csb, pc + 2 * m, ca1 + cb1);
+
+    // z1 is known to fit in the remaining digits, so anything past them is zero.
+    int32_t cz1 = min(csa + csb, ca + cb - m);
+    _addmant(pc + m, ca + cb - m, z1.data(), cz1);
+}
+
+//----------------------------------------------------------------------------
+//
+//  Signed mantissa helpers used by the Toom-3 interpolation, where
+//  intermediate values may go negative.
+//
+//----------------------------------------------------------------------------
+
+namespace
 {
-    if (b->cdigit > 1 || b->mant[0] != 1 || b->exp != 0)
+    struct SIGNEDMANT
     {
-        // b is not one.
-        if ((*pa)->cdigit > 1 || (*pa)->mant[0] != 1 || (*pa)->exp != 0)
+        int32_t sign = 1;
+        vector<MANTTYPE> mant;
+    };
+
+    void trimsignedmant(SIGNEDMANT& x)
+    {
+        while (!x.mant.empty() && x.mant.back() == 0)
         {
-            // pa and b are both not one.
-            _divnumx(pa, b, precision);
+            x.mant.pop_back();
+        }
+        if (x.mant.empty())
+        {
+            x.sign = 1;
+        }
+    }
+
+    SIGNEDMANT makesignedmant(const MANTTYPE* p, int32_t c)
+    {
+        SIGNEDMANT x;
+        x.mant.assign(p, p + c);
+        trimsignedmant(x);
+        return x;
+    }
+
+    // x += sign * y
+    void addsignedmant(SIGNEDMANT& x, const SIGNEDMANT& y, int32_t sign = 1)
+    {
+        const int32_t ysign = y.sign * sign;
+        const int32_t cx = static_cast<int32_t>(x.mant.size());
+        const int32_t cy = static_cast<int32_t>(y.mant.size());
+        if (x.mant.empty())
+        {
+            x.mant = y.mant;
+            x.sign = ysign;
+        }
+        else if (x.sign == ysign)
+        {
+            x.mant.resize(max(cx, cy) + 1, 0);
+            _addmant(x.mant.data(), static_cast<int32_t>(x.mant.size()), y.mant.data(), cy);
+        }
+        else if (_cmpmant(x.mant.data(), cx, y.mant.data(), cy) >= 0)
+        {
+            _submant(x.mant.data(), cx, y.mant.data(), cy);
         }
         else
         {
-            // if pa is one and b is not one, just copy b, and adjust the sign.
-            int32_t sign = (*pa)->sign;
-            DUPNUM(*pa, b);
-            (*pa)->sign *= sign;
+            vector<MANTTYPE> diff = y.mant;
+            _submant(diff.data(), cy, x.mant.data(), cx);
+            x.mant.swap(diff);
+            x.sign = ysign;
         }
+        trimsignedmant(x);
     }
-    else
+
+    SIGNEDMANT mulsignedmant(const SIGNEDMANT& x, const SIGNEDMANT& y)
     {
-        // b is one so don't divide, but set the sign.
-        (*pa)->sign *= b->sign;
+        SIGNEDMANT r;
+        if (!x.mant.empty() && !y.mant.empty())
+        {
+            const int32_t cx = static_cast<int32_t>(x.mant.size());
+            const int32_t cy = static_cast<int32_t>(y.mant.size());
+            r.mant.resize(cx + cy);
+            _mulmantx(r.mant.data(), x.mant.data(), cx, y.mant.data(), cy);
+            r.sign = x.sign * y.sign;
+            trimsignedmant(r);
+        }
+        return r;
+    }
+
+    // x *= 2
+    void dblsignedmant(SIGNEDMANT& x)
+    {
+        x.mant.push_back(0);
+        MANTTYPE shiftin = 0;
+        for (auto& d : x.mant)
+        {
+            MANTTYPE next = (MANTTYPE)(d >> (BASEXPWR - 1));
+            d = (MANTTYPE)((((TWO_MANTTYPE)d << 1) | shiftin) & MANTMASK);
+            shiftin = next;
+        }
+        trimsignedmant(x);
+    }
+
+    // x /= divisor, the division is known to be exact.
+    void divexactsignedmant(SIGNEDMANT& x, uint32_t divisor)
+    {
+        TWO_MANTTYPE rem = 0;
+        for (auto it = x.mant.rbegin(); it != x.mant.rend(); ++it)
+        {
+            TWO_MANTTYPE cur = (rem << BASEXPWR) | *it;
+            *it = (MANTTYPE)(cur / divisor);
+            rem = cur % divisor;
+        }
+        trimsignedmant(x);
     }
 }
 
 //----------------------------------------------------------------------------
 //
-//    FUNCTION: _divnumx
+//    FUNCTION: _mulmanttoom3
 //
-//    ARGUMENTS: pointer to a number, a second number and precision.
+//    DESCRIPTION: Toom-3 multiplication, pc = pa * pb.  Both operands are
+//    split into three pieces of k digits,
 //
-//    RETURN: None, changes first pointer.
+//        a(x) = a2*x^2 + a1*x + a0 with x = BASEX^k
 //
-//    DESCRIPTION: Does the number equivalent of *pa /= b.
-//    Assumes radix is the internal radix representation.
+//    the product polynomial is evaluated at 0, 1, -1, -2 and infinity, which
+//    takes five products of a third of the size, and then interpolated with
+//    the sequence from Bodrato and Zanoni which only needs exact divisions
+//    by 2 and 3.
 //
 //----------------------------------------------------------------------------
 
-void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision)
-
+static void _mulmanttoom3(MANTTYPE* pc, const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb)
 {
-    PNUMBER a = nullptr;       // a is the dereferenced number pointer from *pa
-    PNUMBER c = nullptr;       // c will contain the result.
-    PNUMBER lasttmp = nullptr; // lasttmp allows a backup when the algorithm
-                               // guesses one bit too far.
-    PNUMBER tmp = nullptr;     // current guess being worked on for divide.
-    PNUMBER rem = nullptr;     // remainder after applying guess.
-    int32_t cdigits;           // count of digits for answer.
-    MANTTYPE* ptrc;            // ptrc is a pointer to the mantissa of c.
+    const bool fsquare = (pa == pb && ca == cb);
+    const int32_t k = (ca + 2) / 3;
 
-    int32_t thismax = precision + g_ratio; // set a maximum number of internal digits
-                                           // to shoot for in the divide.
+    SIGNEDMANT a0 = makesignedmant(pa, k);
+    SIGNEDMANT a1 = makesignedmant(pa + k, k);
+    SIGNEDMANT a2 = makesignedmant(pa + 2 * k, ca - 2 * k);
+    SIGNEDMANT b0 = makesignedmant(pb, k);
+    SIGNEDMANT b1 = makesignedmant(pb + k, k);
+    SIGNEDMANT b2 = makesignedmant(pb + 2 * k, cb - 2 * k);
 
-    a = *pa;
-    if (thismax < a->cdigit)
-    {
-        // a has more digits than precision specified, bump up digits to shoot
-        // for.
-        thismax = a->cdigit;
-    }
+    // Evaluate a(x) at 1, -1 and -2.
+    //   a(1) = a0 + a1 + a2, a(-1) = a0 - a1 + a2, a(-2) = 2*(a(-1) + a2) - a0
+    SIGNEDMANT am1 = a0;
+    addsignedmant(am1, a2);
+    SIGNEDMANT ap1 = am1;
+    addsignedmant(ap1, a1);
+    addsignedmant(am1, a1, -1);
+    SIGNEDMANT am2 = am1;
+    addsignedmant(am2, a2);
+    dblsignedmant(am2);
+    addsignedmant(am2, a0, -1);
 
-    if (thismax < b->cdigit)
+    SIGNEDMANT r0, r1, rm1, rm2, rinf;
+    if (fsquare)
     {
-        // b has more digits than precision specified, bump up digits to shoot
-        // for.
-        thismax = b->cdigit;
+        r0 = mulsignedmant(a0, a0);
+        r1 = mulsignedmant(ap1, ap1);
+        rm1 = mulsignedmant(am1, am1);
+        rm2 = mulsignedmant(am2, am2);
+        rinf = mulsignedmant(a2, a2);
     }
+    else
+    {
+        SIGNEDMANT bm1 = b0;
+        addsignedmant(bm1, b2);
+        SIGNEDMANT bp1 = bm1;
+        addsignedmant(bp1, b1);
+        addsignedmant(bm1, b1, -1);
+        SIGNEDMANT bm2 = bm1;
+        addsignedmant(bm2, b2);
+        dblsignedmant(bm2);
+        addsignedmant(bm2, b0, -1);
 
-    // Create c (the divide answer) and set up exponent and sign.
-    createnum(c, thismax + 1);
-    c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
-    c->sign = a->sign * b->sign;
-
-    ptrc = c->mant + thismax;
-    cdigits = 0;
+        r0 = mulsignedmant(a0, b0);
+        r1 = mulsignedmant(ap1, bp1);
+        rm1 = mulsignedmant(am1, bm1);
+        rm2 = mulsignedmant(am2, bm2);
+        rinf = mulsignedmant(a2, b2);
+    }
 
-    DUPNUM(rem, a);
-    rem->sign = b->sign;
-    rem->exp = b->cdigit + b->exp - rem->cdigit;
+    // Interpolate, on exit r0, r1, r2, r3 and rinf are the coefficients
+    // of the product polynomial.
+    //   r3 = (r(-2) - r(1)) / 3
+    //   r1 = (r(1) - r(-1)) / 2
+    //   r2 = r(-1) - r(0)
+    //   r3 = (r2 - r3) / 2 + 2 * r(inf)
+    //   r2 = r2 + r1 - r(inf)
+    //   r1 = r1 - r3
+    SIGNEDMANT r3 = rm2;
+    addsignedmant(r3, r1, -1);
+    divexactsignedmant(r3, 3);
+    addsignedmant(r1, rm1, -1);
+    divexactsignedmant(r1, 2);
+    SIGNEDMANT r2 = rm1;
+    addsignedmant(r2, r0, -1);
+    SIGNEDMANT t = r2;
+    addsignedmant(t, r3, -1);
+    divexactsignedmant(t, 2);
+    r3 = rinf;
+    dblsignedmant(r3);
+    addsignedmant(r3, t);
+    addsignedmant(r2, r1);
+    addsignedmant(r2, rinf, -1);
+    addsignedmant(r1, r3, -1);
 
-    while (cdigits++ < thismax && !zernum(rem))
+    // Recompose, all the coefficients are now non negative.
+    const int32_t cc = ca + cb;
+    memset(pc, 0, sizeof(MANTTYPE) * cc);
+    const SIGNEDMANT* coef[] = { &r0, &r1, &r2, &r3, &rinf };
+    for (int32_t i = 0; i < 5; i++)
     {
-        int32_t digit = 0;
-        *ptrc = 0;
-        while (!lessnum(rem, b))
+        const int32_t offset = i * k;
+        const int32_t cr = static_cast<int32_t>(coef[i]->mant.size());
+        if (cr > 0)
         {
-            digit = 1;
-            DUPNUM(tmp, b);
-            destroynum(lasttmp);
-            lasttmp = i32tonum(0, BASEX);
-            while (lessnum(tmp, rem))
-            {
-                destroynum(lasttmp);
-                DUPNUM(lasttmp, tmp);
-                addnum(&tmp, tmp, BASEX);
-                digit *= 2;
-            }
-            if (lessnum(rem, tmp))
-            {
-                // too far, back up...
-                destroynum(tmp);
-                digit /= 2;
-                tmp = lasttmp;
-                lasttmp = nullptr;
-            }
-
-            tmp->sign *= -1;
-            addnum(&rem, tmp, BASEX);
-            destroynum(tmp);
-            destroynum(lasttmp);
-            *ptrc |= digit;
+            _addmant(pc + offset, cc - offset, coef[i]->mant.data(), cr);
         }
-        rem->exp++;
-        ptrc--;
     }
-    cdigits--;
-    if (c->mant != ++ptrc)
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _mulmantx
+//
+//    ARGUMENTS: result mantissa with room for ca + cb digits, and two
+//               mantissas with their digit counts.
+//
+//    RETURN: None, fills in pc.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pc = pa * pb.  The
+//    algorithm is chosen by the size of the smaller operand, schoolbook
+//    below g_karatsubaThreshold, Karatsuba below g_toom3Threshold, Toom-3
+//    below g_nttThreshold and a number theoretic transform above that.
+//    Lopsided operands are multiplied a slice of the larger at a time so
+//    each partial product is balanced.
+//    pc must not overlap pa or pb, pa and pb may be the same mantissa in
+//    which case squaring is used.
+//
+//----------------------------------------------------------------------------
+
+void _mulmantx(_Out_ MANTTYPE* pc, _In_ const MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb)
+{
+    if (ca < cb)
     {
-        memmove(c->mant, ptrc, (int)(cdigits * sizeof(MANTTYPE)));
+        swap(pa, pb);
+        swap(ca, cb);
     }
 
-    if (!cdigits)
+    if (cb >= g_nttThreshold && _fitsntt(ca + cb))
     {
-        // A zero, make sure no weird exponents creep in
-        c->exp = 0;
-        c->cdigit = 1;
+        _mulmantntt(pc, pa, ca, pb, cb);
     }
-    else
+    else if (cb < g_karatsubaThreshold || cb < 2)
+    {
+        if (pa == pb && ca == cb)
+        {
+            _sqrmantbase(pc, pa, ca);
+        }
+        else
+        {
+            _mulmantbase(pc, pa, ca, pb, cb);
+        }
+    }
+    else if (ca >= 2 * cb)
     {
-        c->cdigit = cdigits;
-        c->exp -= cdigits;
-        // prevent different kinds of zeros, by stripping leading duplicate
-        // zeros. digits are in order of increasing significance.
-        while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
+        // Multiply by slices of cb digits and accumulate.
+        memset(pc, 0, sizeof(MANTTYPE) * (ca + cb));
+        vector<MANTTYPE> partial(2 * cb);
+        for (int32_t offset = 0; offset < ca; offset += cb)
         {
-            c->cdigit--;
+            int32_t cslice = min(cb, ca - offset);
+            _mulmantx(partial.data(), pa + offset, cslice, pb, cb);
+            _addmant(pc + offset, ca + cb - offset, partial.data(), cslice + cb);
         }
     }
+    else if (cb >= g_toom3Threshold && cb > 2 * ((ca + 2) / 3))
+    {
+        _mulmanttoom3(pc, pa, ca, pb, cb);
+    }
+    else
+    {
+        _mulmantkara(pc, pa, ca, pb, cb);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _powwindows
+//
+//    ARGUMENTS: power, at least one, an array of MAX_POW_WINDOWS windows and
+//               where to put the window size.
+//
+//    RETURN: Count of windows, most significant first.  The squarings of the
+//            first window are always zero.
+//
+//    DESCRIPTION: Splits power into windows of at most *pwindow bits that
+//    start and end on a one bit, and the runs of zeros between them.  With
+//    the odd powers root^1, root^3, ... root^(2^window - 1) at hand, that
+//    is one multiply per window rather than per one bit.  The window
+//    grows with the power, as the table costs 2^(window - 1) multiplies.
+//
+//-----------------------------------------------------------------------------
+
+int32_t _powwindows(uint32_t power, _Out_ POWWINDOW* windows, _Out_ int32_t* pwindow)
+{
+    int32_t cbits = 0;
+    while (cbits < 32 && (power >> cbits) != 0)
+    {
+        cbits++;
+    }
+    int32_t window = cbits > 24 ? 3 : (cbits > 10 ? 2 : 1);
+    *pwindow = window;
 
-    destroynum(rem);
+    int32_t cwindows = 0;
+    int32_t csquare = 0;
+    for (int32_t bit = cbits - 1; bit >= 0;)
+    {
+        if (((power >> bit) & 1) == 0)
+        {
+            csquare++;
+            bit--;
+            continue;
+        }
 
-    destroynum(*pa);
-    *pa = c;
+        int32_t low = max(bit - window + 1, 0);
+        while (((power >> low) & 1) == 0)
+        {
+            low++;
+        }
+        int32_t width = bit - low + 1;
+        windows[cwindows].csquare = cwindows == 0 ? 0 : csquare + width;
+        windows[cwindows].odd = (power >> low) & ((1u << width) - 1);
+        cwindows++;
+        csquare = 0;
+        bit = low - 1;
+    }
+    if (csquare > 0)
+    {
+        windows[cwindows].csquare = csquare;
+        windows[cwindows].odd = 0;
+        cwindows++;
+    }
+    return cwindows;
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: numpowi32x
+//
+//    ARGUMENTS: root as number power as int32_t
+//               number.
+//
+//    RETURN: None root is changed.
+//
+//    DESCRIPTION: changes numeric representation of root to
+//    root ** power. Assumes base BASEX
+//    The root is split into m * 2^t * BASEX^e with m odd, so the factors of
+//    two and the exponent only scale the exponent and the top digit, and m
+//    alone is raised, by sliding windows over the power.
+//
+//-----------------------------------------------------------------------------
+
+void numpowi32x(_Inout_ PNUMBER* proot, int32_t power)
+
+{
+    PNUMBER root = *proot;
+    if (power <= 0 || zernum(root))
+    {
+        if (power <= 0)
+        {
+            DUPNUM(*proot, num_one);
+        }
+        return;
+    }
+
+    // Shift the zero digits and bits out of the mantissa.
+    int32_t czero = 0;
+    while (root->mant[czero] == 0)
+    {
+        czero++;
+    }
+    int32_t cshift = 0;
+    while (((root->mant[czero] >> cshift) & 1) == 0)
+    {
+        cshift++;
+    }
+    PNUMBER odd = nullptr;
+    int32_t codd = root->cdigit - czero;
+    createnum(odd, codd);
+    for (int32_t i = 0; i < codd; i++)
+    {
+        TWO_MANTTYPE pair = root->mant[czero + i];
+        if (i + 1 < codd)
+        {
+            pair |= (TWO_MANTTYPE)root->mant[czero + i + 1] << BASEXPWR;
+        }
+        odd->mant[i] = (MANTTYPE)(pair >> cshift);
+    }
+    while (codd > 1 && odd->mant[codd - 1] == 0)
+    {
+        codd--;
+    }
+    odd->cdigit = codd;
+    odd->exp = 0;
+    odd->sign = 1;
+
+    PNUMBER lret = nullptr;
+    if (codd == 1 && odd->mant[0] == 1)
+    {
+        DUPNUM(lret, num_one);
+    }
+    else
+    {
+        POWWINDOW windows[MAX_POW_WINDOWS];
+        int32_t window;
+        int32_t cwindows = _powwindows(power, windows, &window);
+
+        // table[i] = odd^(2i + 1)
+        vector<PNUMBER> table(1 << (window - 1), nullptr);
+        DUPNUM(table[0], odd);
+        if (table.size() > 1)
+        {
+            PNUMBER square = nullptr;
+            DUPNUM(square, odd);
+            mulnumx(&square, odd);
+            for (size_t i = 1; i < table.size(); i++)
+            {
+                DUPNUM(table[i], table[i - 1]);
+                mulnumx(&table[i], square);
+            }
+            destroynum(square);
+        }
+
+        DUPNUM(lret, table[windows[0].odd >> 1]);
+        for (int32_t i = 1; i < cwindows; i++)
+        {
+            for (int32_t j = 0; j < windows[i].csquare; j++)
+            {
+                mulnumx(&lret, lret);
+            }
+            if (windows[i].odd != 0)
+            {
+                mulnumx(&lret, table[windows[i].odd >> 1]);
+            }
+        }
+
+        for (PNUMBER entry : table)
+        {
+            destroynum(entry);
+        }
+    }
+
+    // Put back 2^(t * power) * BASEX^(e * power), whole digits of it into the exponent.
+    int64_t cbits = static_cast<int64_t>(cshift) * power;
+    if (cbits % BASEXPWR != 0)
+    {
+        PNUMBER twos = Ui32tonum(1u << (cbits % BASEXPWR), BASEX);
+        mulnumx(&lret, twos);
+        destroynum(twos);
+    }
+    lret->exp += static_cast<int32_t>((static_cast<int64_t>(root->exp) + czero) * power + cbits / BASEXPWR);
+    lret->sign = (power & 1) ? root->sign : 1;
+
+    destroynum(odd);
+    destroynum(*proot);
+    *proot = lret;
+}
+
+void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision);
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: divnumx
+//
+//    ARGUMENTS: pointer to a number, a second number and precision.
+//
+//    RETURN: None, changes first pointer.
+//
+//    DESCRIPTION: Does the number equivalent of *pa /= b.
+//    Assumes radix is the internal radix representation.
+//    This is a stub which prevents division by 1, this is a big speed
+//    improvement.
+//
+//----------------------------------------------------------------------------
+
+void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision)
+
+{
+    if (b->cdigit > 1 || b->mant[0] != 1 || b->exp != 0)
+    {
+        // b is not one.
+        if ((*pa)->cdigit > 1 || (*pa)->mant[0] != 1 || (*pa)->exp != 0)
+        {
+            // pa and b are both not one.
+            _divnumx(pa, b, precision);
+        }
+        else
+        {
+            // if pa is one and b is not one, just copy b, and adjust the sign.
+            int32_t sign = (*pa)->sign;
+            DUPNUM(*pa, b);
+            (*pa)->sign *= sign;
+        }
+    }
+    else
+    {
+        // b is one so don't divide, but set the sign.
+        (*pa)->sign *= b->sign;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _divnumx
+//
+//    ARGUMENTS: pointer to a number, a second number and precision.
+//
+//    RETURN: None, changes first pointer.
+//
+//    DESCRIPTION: Does the number equivalent of *pa /= b.
+//    Assumes radix is the internal radix representation.
+//
+//----------------------------------------------------------------------------
+
+void _divnumx(PNUMBER* pa, PNUMBER b, int32_t precision)
+
+{
+    int32_t thismax = precision + g_ratio; // set a maximum number of internal digits
+                                           // to shoot for in the divide.
+
+    if (thismax < (*pa)->cdigit)
+    {
+        // a has more digits than precision specified, bump up digits to shoot
+        // for.
+        thismax = (*pa)->cdigit;
+    }
+
+    if (thismax < b->cdigit)
+    {
+        // b has more digits than precision specified, bump up digits to shoot
+        // for.
+        thismax = b->cdigit;
+    }
+
+    _divnumtrunc(pa, b, BASEX, thismax);
+}
+
+//----------------------------------------------------------------------------
+//
+//  Mantissa division kernels.
+//
+//  Short divisors, or short quotients, use schoolbook division from
+//  _divmantbase.  Otherwise a reciprocal of the divisor is found by Newton
+//  iteration, which only needs multiplications, and the quotient is taken
+//  from the reciprocal and then corrected against the true remainder.  Each
+//  Newton step doubles the number of correct digits so the reciprocal costs
+//  about as much as two full size multiplications, and the whole division
+//  a small constant multiple of one.
+//
+//----------------------------------------------------------------------------
+
+// Size, in BASEX digits of the divisor and quotient, at which _divmantx
+// switches from schoolbook to Newton division.
+int32_t g_newtonDivThreshold = NEWTON_DIV_THRESHOLD;
+
+static void _divmantnewton(MANTTYPE* pq, MANTTYPE* pr, const MANTTYPE* pn, int32_t cn, const MANTTYPE* pb, int32_t cb);
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _trimmant
+//
+//    DESCRIPTION: Returns the digit count of a mantissa with leading zero
+//    digits removed, never less than one.
+//
+//----------------------------------------------------------------------------
+
+static int32_t _trimmant(const MANTTYPE* p, int32_t c)
+{
+    while (c > 1 && p[c - 1] == 0)
+    {
+        c--;
+    }
+    return c;
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _recipmant
+//
+//    ARGUMENTS: k digit mantissa with a nonzero top digit.
+//
+//    RETURN: v, close to BASEX^2k / b.
+//
+//    DESCRIPTION: Small reciprocals are exact, from schoolbook division.
+//    Otherwise the reciprocal of the top h digits, h a little over k/2, is
+//    scaled up as the starting guess v0 and one Newton step
+//
+//        v = v0 + v0 * (BASEX^2k - b*v0) / BASEX^2k
+//
+//    squares its relative error.  The result is within a few units, which
+//    the callers correct for.
+//
+//----------------------------------------------------------------------------
+
+static vector<MANTTYPE> _recipmant(const MANTTYPE* pb, int32_t k)
+{
+    vector<MANTTYPE> v;
+    if (k < g_newtonDivThreshold || k < 8)
+    {
+        vector<MANTTYPE> n(2 * k + 1, 0);
+        n[2 * k] = 1;
+        v.resize(k + 2);
+        _divmantbase(v.data(), nullptr, n.data(), 2 * k + 1, pb, k, BASEX);
+        v.resize(_trimmant(v.data(), k + 2));
+        return v;
+    }
+
+    // v0 = recip(top h digits) * BASEX^(k-h)
+    const int32_t h = k / 2 + 2;
+    vector<MANTTYPE> vh = _recipmant(pb + (k - h), h);
+    const int32_t cv0 = static_cast<int32_t>(vh.size()) + (k - h);
+    vector<MANTTYPE> v0(cv0, 0);
+    copy(vh.begin(), vh.end(), v0.begin() + (k - h));
+
+    // e = BASEX^2k - b*v0, kept as a magnitude and a sign.
+    vector<MANTTYPE> bv(k + cv0 + 1, 0);
+    _mulmantx(bv.data(), pb, k, v0.data(), cv0);
+    int32_t cbv = _trimmant(bv.data(), k + cv0 + 1);
+    vector<MANTTYPE> one(2 * k + 1, 0);
+    one[2 * k] = 1;
+    vector<MANTTYPE> e;
+    bool fnegative = _cmpmant(bv.data(), cbv, one.data(), 2 * k + 1) > 0;
+    if (fnegative)
+    {
+        e.assign(bv.begin(), bv.begin() + cbv);
+        _submant(e.data(), cbv, one.data(), 2 * k + 1);
+    }
+    else
+    {
+        e = one;
+        _submant(e.data(), 2 * k + 1, bv.data(), cbv);
+    }
+    int32_t ce = _trimmant(e.data(), static_cast<int32_t>(e.size()));
+
+    // correction = v0 * e / BASEX^2k
+    vector<MANTTYPE> prod(cv0 + ce, 0);
+    _mulmantx(prod.data(), v0.data(), cv0, e.data(), ce);
+    vector<MANTTYPE> corr;
+    if (cv0 + ce > 2 * k)
+    {
+        corr.assign(prod.begin() + 2 * k, prod.end());
+    }
+
+    v = v0;
+    v.push_back(0);
+    if (!corr.empty())
+    {
+        const int32_t ccorr = _trimmant(corr.data(), static_cast<int32_t>(corr.size()));
+        if (fnegative)
+        {
+            if (_cmpmant(v.data(), static_cast<int32_t>(v.size()), corr.data(), ccorr) > 0)
+            {
+                _submant(v.data(), static_cast<int32_t>(v.size()), corr.data(), ccorr);
+            }
+        }
+        else
+        {
+            v.resize(max(static_cast<int32_t>(v.size()), ccorr) + 1, 0);
+            _addmant(v.data(), static_cast<int32_t>(v.size()), corr.data(), ccorr);
+        }
+    }
+    v.resize(_trimmant(v.data(), static_cast<int32_t>(v.size())));
+    return v;
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _divmantx
+//
+//    ARGUMENTS: quotient mantissa with room for cn - cb + 1 digits,
+//               remainder mantissa with room for cb digits (may be null),
+//               dividend and divisor mantissas with their digit counts.
+//
+//    RETURN: None, fills in pq and pr.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pq = pn / pb and
+//    pr = pn % pb in BASEX, for cn >= cb and a divisor with a nonzero top
+//    digit.  Picks schoolbook or Newton division by size.
+//
+//----------------------------------------------------------------------------
+
+void _divmantx(_Out_ MANTTYPE* pq, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, _In_ const MANTTYPE* pb, int32_t cb)
+{
+    if (cb < g_newtonDivThreshold || cn - cb + 1 < g_newtonDivThreshold)
+    {
+        _divmantbase(pq, pr, pn, cn, pb, cb, BASEX);
+    }
+    else
+    {
+        _divmantnewton(pq, pr, pn, cn, pb, cb);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _divmantnewton
+//
+//    DESCRIPTION: Newton division.  With k digits of reciprocal, k about the
+//    length of the quotient, the estimate q~ = n * recip(b) is within a few
+//    units of the true quotient.  The remainder n - q~*b is then computed
+//    exactly and the small difference is divided out with _divmantx, which
+//    lands in schoolbook for such a short quotient.  A quotient much longer
+//    than the divisor is found a divisor length at a time in the same way.
+//
+//----------------------------------------------------------------------------
+
+static void _divmantnewton(MANTTYPE* pq, MANTTYPE* pr, const MANTTYPE* pn, int32_t cn, const MANTTYPE* pb, int32_t cb)
+{
+    const int32_t cq = cn - cb + 1;
+    const int32_t k = min(cb, cq + 2);
+
+    // v ~ BASEX^2k / bt where bt is the top k digits of b, so
+    // n / b ~ n * v / BASEX^(k + cb), only the top digits of n matter.
+    vector<MANTTYPE> v = _recipmant(pb + (cb - k), k);
+    const int32_t cv = static_cast<int32_t>(v.size());
+    const int32_t drop = min(max(0, cn - k - 2), k + cb);
+    const int32_t cntop = cn - drop;
+    vector<MANTTYPE> prod(cntop + cv, 0);
+    _mulmantx(prod.data(), pn + drop, cntop, v.data(), cv);
+
+    const int32_t shift = k + cb - drop;
+    vector<MANTTYPE> qest(cq + 1, 0);
+    if (cntop + cv > shift)
+    {
+        const int32_t cest = min(cntop + cv - shift, cq + 1);
+        copy(prod.begin() + shift, prod.begin() + shift + cest, qest.begin());
+    }
+    int32_t cqest = _trimmant(qest.data(), cq + 1);
+
+    // r = n - q~ * b, its sign says which way to correct.
+    vector<MANTTYPE> qb(cqest + cb, 0);
+    _mulmantx(qb.data(), qest.data(), cqest, pb, cb);
+    int32_t cqb = _trimmant(qb.data(), cqest + cb);
+
+    vector<MANTTYPE> rem;
+    vector<MANTTYPE> q(qest);
+    q.push_back(0);
+    if (_cmpmant(qb.data(), cqb, pn, cn) <= 0)
+    {
+        // q~ is not too big, r = n - q~*b and q += r / b.
+        rem.assign(pn, pn + cn);
+        _submant(rem.data(), cn, qb.data(), cqb);
+        int32_t crem = _trimmant(rem.data(), cn);
+        if (_cmpmant(rem.data(), crem, pb, cb) >= 0)
+        {
+            vector<MANTTYPE> dq(crem - cb + 1);
+            vector<MANTTYPE> dr(cb);
+            if (crem < cn)
+            {
+                _divmantx(dq.data(), dr.data(), rem.data(), crem, pb, cb);
+            }
+            else
+            {
+                // No progress was made, which the estimate should never allow.
+                _divmantbase(dq.data(), dr.data(), rem.data(), crem, pb, cb, BASEX);
+            }
+            _addmant(q.data(), static_cast<int32_t>(q.size()), dq.data(), crem - cb + 1);
+            rem.assign(dr.begin(), dr.end());
+        }
+    }
+    else
+    {
+        // q~ is too big, with t = q~*b - n, q -= ceil(t / b).
+        vector<MANTTYPE> t(qb.begin(), qb.begin() + cqb);
+        _submant(t.data(), cqb, pn, min(cn, cqb));
+        int32_t ct = _trimmant(t.data(), cqb);
+        vector<MANTTYPE> dq(max(ct - cb + 1, 1), 0);
+        vector<MANTTYPE> dr(cb, 0);
+        if (ct >= cb)
+        {
+            _divmantx(dq.data(), dr.data(), t.data(), ct, pb, cb);
+        }
+        else
+        {
+            copy(t.begin(), t.begin() + ct, dr.begin());
+        }
+
+        bool fzero = all_of(dr.begin(), dr.end(), [](MANTTYPE digit) { return digit == 0; });
+        rem.assign(pb, pb + cb);
+        if (fzero)
+        {
+            fill(rem.begin(), rem.end(), 0);
+        }
+        else
+        {
+            // Round the correction up, the remainder is b - (t mod b).
+            MANTTYPE one = 1;
+            dq.push_back(0);
+            _addmant(dq.data(), static_cast<int32_t>(dq.size()), &one, 1);
+            _submant(rem.data(), cb, dr.data(), cb);
+        }
+        _submant(q.data(), static_cast<int32_t>(q.size()), dq.data(), static_cast<int32_t>(dq.size()));
+    }
+
+    copy(q.begin(), q.begin() + cq, pq);
+    if (pr != nullptr)
+    {
+        fill(pr, pr + cb, 0);
+        copy(rem.begin(), rem.begin() + min(static_cast<int32_t>(rem.size()), cb), pr);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//  Root kernels.
+//
+//  The root of the top part of the radicand, found recursively, is scaled
+//  up as the starting guess s0 and Newton steps
+//
+//      s = ((k - 1) * s + n / s^(k - 1)) / k
+//
+//  for the kth root are taken until they stop decreasing.  The first step
+//  lands at or above the root, and s0 is already good to about half the
+//  digits, so the root takes a division or two at each level and the whole
+//  root a small constant multiple of one division.
+//
+//----------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _isqrtmant
+//
+//    ARGUMENTS: mantissa with a nonzero top digit and its digit count.
+//
+//    RETURN: floor of the square root of the mantissa.
+//
+//----------------------------------------------------------------------------
+
+static vector<MANTTYPE> _isqrtmant(const MANTTYPE* pn, int32_t cn)
+{
+    if (cn <= 2)
+    {
+        TWO_MANTTYPE n = pn[0];
+        if (cn == 2)
+        {
+            n |= (TWO_MANTTYPE)pn[1] << BASEXPWR;
+        }
+
+        // The double estimate is within a unit or two, fix it up exactly.
+        TWO_MANTTYPE root = min<TWO_MANTTYPE>((TWO_MANTTYPE)sqrt((double)n), MANTMASK);
+        while (root * root > n)
+        {
+            root--;
+        }
+        while (root < MANTMASK && (root + 1) * (root + 1) <= n)
+        {
+            root++;
+        }
+        return vector<MANTTYPE>(1, (MANTTYPE)root);
+    }
+
+    // Root of the top digits, shifted into place, is below the root by less
+    // than BASEX^k.
+    int32_t k = max(1, (cn - 1) / 4);
+    vector<MANTTYPE> root(k, 0);
+    vector<MANTTYPE> top = _isqrtmant(pn + 2 * k, _trimmant(pn + 2 * k, cn - 2 * k));
+    root.insert(root.end(), top.begin(), top.end());
+
+    bool ffirst = true;
+    while (true)
+    {
+        int32_t croot = _trimmant(root.data(), static_cast<int32_t>(root.size()));
+        int32_t cnext = max(cn - croot + 1, croot) + 1;
+        vector<MANTTYPE> next(cnext, 0);
+        _divmantx(next.data(), nullptr, pn, cn, root.data(), croot);
+        _addmant(next.data(), cnext, root.data(), croot);
+        for (int32_t i = 0; i < cnext; i++)
+        {
+            next[i] = (MANTTYPE)((next[i] >> 1) | (i + 1 < cnext ? (TWO_MANTTYPE)next[i + 1] << (BASEXPWR - 1) : 0));
+        }
+        cnext = _trimmant(next.data(), cnext);
+
+        if (!ffirst && _cmpmant(next.data(), cnext, root.data(), croot) >= 0)
+        {
+            root.resize(croot);
+            return root;
+        }
+        next.resize(cnext);
+        root.swap(next);
+        ffirst = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _sqrtmantx
+//
+//    ARGUMENTS: root mantissa with room for (cn + 1) / 2 digits, remainder
+//               mantissa with room for (cn + 1) / 2 + 1 digits (may be
+//               null), radicand mantissa and its digit count.
+//
+//    RETURN: None, fills in ps and pr.
+//
+//    DESCRIPTION: Does the mantissa equivalent of ps = floor(sqrt(pn)) and
+//    pr = pn - ps * ps in BASEX.
+//
+//----------------------------------------------------------------------------
+
+void _sqrtmantx(_Out_ MANTTYPE* ps, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn)
+{
+    int32_t cs = (cn + 1) / 2;
+    fill(ps, ps + cs, 0);
+    cn = _trimmant(pn, cn);
+    vector<MANTTYPE> root(1, 0);
+    if (cn > 1 || pn[0] != 0)
+    {
+        root = _isqrtmant(pn, cn);
+    }
+    copy(root.begin(), root.end(), ps);
+
+    if (pr != nullptr)
+    {
+        int32_t croot = static_cast<int32_t>(root.size());
+        int32_t cr = cs + 1;
+        vector<MANTTYPE> square(2 * croot);
+        _mulmantx(square.data(), root.data(), croot, root.data(), croot);
+        vector<MANTTYPE> rem(pn, pn + cn);
+        _submant(rem.data(), cn, square.data(), _trimmant(square.data(), 2 * croot));
+        fill(pr, pr + cr, 0);
+        copy(rem.begin(), rem.begin() + min(cn, cr), pr);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _powmant
+//
+//    ARGUMENTS: mantissa, power and the most digits the result may have.
+//
+//    RETURN: a^power, or an empty mantissa if that has more than cmax
+//            digits.
+//
+//----------------------------------------------------------------------------
+
+static vector<MANTTYPE> _powmant(const vector<MANTTYPE>& a, int32_t power, int32_t cmax)
+{
+    vector<MANTTYPE> result(1, 1);
+    vector<MANTTYPE> square(a);
+    while (true)
+    {
+        if (power & 1)
+        {
+            int32_t cresult = static_cast<int32_t>(result.size());
+            int32_t csquare = static_cast<int32_t>(square.size());
+            if (cresult + csquare - 1 > cmax)
+            {
+                return vector<MANTTYPE>();
+            }
+            vector<MANTTYPE> product(cresult + csquare);
+            _mulmantx(product.data(), result.data(), cresult, square.data(), csquare);
+            product.resize(_trimmant(product.data(), cresult + csquare));
+            result.swap(product);
+        }
+
+        power >>= 1;
+        if (power == 0)
+        {
+            return result;
+        }
+
+        // Whatever is left of the power multiplies square in at least once.
+        int32_t csquare = static_cast<int32_t>(square.size());
+        if (2 * csquare - 1 > cmax)
+        {
+            return vector<MANTTYPE>();
+        }
+        vector<MANTTYPE> product(2 * csquare);
+        _mulmantx(product.data(), square.data(), csquare, square.data(), csquare);
+        product.resize(_trimmant(product.data(), 2 * csquare));
+        square.swap(product);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _irootmant
+//
+//    ARGUMENTS: mantissa with a nonzero top digit, its digit count and the
+//               root to take, at least 3.
+//
+//    RETURN: floor of the root'th root of the mantissa.
+//
+//----------------------------------------------------------------------------
+
+static vector<MANTTYPE> _irootmant(const MANTTYPE* pn, int32_t cn, int32_t root)
+{
+    vector<MANTTYPE> s;
+    int32_t k = (cn - 1) / (2 * root);
+    if (k > 0)
+    {
+        // Root of the top digits, shifted into place, is below the root by
+        // less than BASEX^k.
+        s.assign(k, 0);
+        vector<MANTTYPE> top = _irootmant(pn + root * k, _trimmant(pn + root * k, cn - root * k), root);
+        s.insert(s.end(), top.begin(), top.end());
+    }
+    else
+    {
+        // The root is at most a few digits, start from a double estimate.
+        double top = pn[cn - 1] + (cn > 1 ? pn[cn - 2] / static_cast<double>(BASEX) : 0);
+        double log2s = (log2(top) + static_cast<double>(cn - 1) * BASEXPWR) / root;
+        int32_t cshift = max(0, (static_cast<int32_t>(log2s) - 52 + static_cast<int32_t>(BASEXPWR) - 1) / static_cast<int32_t>(BASEXPWR));
+        TWO_MANTTYPE estimate = static_cast<TWO_MANTTYPE>(exp2(log2s - static_cast<double>(cshift) * BASEXPWR)) + 1;
+        s.assign(cshift, 0);
+        s.push_back((MANTTYPE)(estimate & MANTMASK));
+        s.push_back((MANTTYPE)(estimate >> BASEXPWR));
+    }
+
+    bool ffirst = true;
+    while (true)
+    {
+        int32_t cs = _trimmant(s.data(), static_cast<int32_t>(s.size()));
+        s.resize(cs);
+
+        // next = ((root - 1) * s + n / s^(root - 1)) / root
+        int32_t cnext = max(cn, cs + 1) + 1;
+        vector<MANTTYPE> next(cnext, 0);
+        vector<MANTTYPE> power = _powmant(s, root - 1, cn);
+        if (!power.empty())
+        {
+            _divmantx(next.data(), nullptr, pn, cn, power.data(), static_cast<int32_t>(power.size()));
+        }
+
+        TWO_MANTTYPE carry = 0;
+        vector<MANTTYPE> scaled(cs + 1);
+        for (int32_t i = 0; i < cs; i++)
+        {
+            carry += (TWO_MANTTYPE)s[i] * (root - 1);
+            scaled[i] = (MANTTYPE)(carry & MANTMASK);
+            carry >>= BASEXPWR;
+        }
+        scaled[cs] = (MANTTYPE)carry;
+        _addmant(next.data(), cnext, scaled.data(), cs + 1);
+
+        TWO_MANTTYPE rem = 0;
+        for (int32_t i = cnext - 1; i >= 0; i--)
+        {
+            rem = (rem << BASEXPWR) | next[i];
+            next[i] = (MANTTYPE)(rem / root);
+            rem %= root;
+        }
+        cnext = _trimmant(next.data(), cnext);
+
+        if (!ffirst && _cmpmant(next.data(), cnext, s.data(), cs) >= 0)
+        {
+            return s;
+        }
+        next.resize(cnext);
+        s.swap(next);
+        ffirst = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _rootmantx
+//
+//    ARGUMENTS: root mantissa with room for (cn + root - 1) / root digits,
+//               remainder mantissa with room for cn digits (may be null),
+//               radicand mantissa, its digit count and the root to take,
+//               at least 2.
+//
+//    RETURN: None, fills in ps and pr.
+//
+//    DESCRIPTION: Does the mantissa equivalent of ps = floor(pn^(1/root))
+//    and pr = pn - ps^root in BASEX.
+//
+//----------------------------------------------------------------------------
+
+void _rootmantx(_Out_ MANTTYPE* ps, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, int32_t root)
+{
+    int32_t cs = (cn + root - 1) / root;
+    fill(ps, ps + cs, 0);
+    int32_t ctrim = _trimmant(pn, cn);
+    vector<MANTTYPE> s(1, 0);
+    if (ctrim > 1 || pn[0] != 0)
+    {
+        s = root == 2 ? _isqrtmant(pn, ctrim) : _irootmant(pn, ctrim, root);
+    }
+    copy(s.begin(), s.end(), ps);
+
+    if (pr != nullptr)
+    {
+        vector<MANTTYPE> power = _powmant(s, root, ctrim);
+        vector<MANTTYPE> rem(pn, pn + ctrim);
+        _submant(rem.data(), ctrim, power.data(), static_cast<int32_t>(power.size()));
+        fill(pr, pr + cn, 0);
+        copy(rem.begin(), rem.end(), pr);
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//  Greatest common divisor kernels.
+//
+//  The main loop picks a step by the size of the operands.  Operands of
+//  very different length take a division step.  Otherwise a Lehmer step
+//  runs Euclid on the leading 62 bits of both operands only, collecting
+//  the quotients into a 2x2 matrix of single digit cofactors, and applies
+//  that matrix to the full operands, which replaces about one BASEX digit
+//  worth of division steps with two linear passes.  Very large operands use
+//  the half gcd, which finds the matrix that halves the operands from the
+//  top halves recursively so that the work is done by _mulmantx.  Once the
+//  operands fit in 64 bits a binary gcd finishes up.
+//
+//  Every step multiplies the operands by a matrix of determinant +/-1,
+//  which never changes their gcd, so the result is exact even if a step
+//  makes less progress than intended.
+//
+//----------------------------------------------------------------------------
+
+// Size, in BASEX digits, at which gcd switches from Lehmer to half gcd steps.
+int32_t g_hgcdThreshold = HGCD_THRESHOLD;
+
+namespace
+{
+    // Row vectors of a 2x2 matrix of signed mantissas.
+    struct GCDMATRIX
+    {
+        SIGNEDMANT r[2][2];
+
+        GCDMATRIX()
+        {
+            r[0][0].mant.assign(1, 1);
+            r[1][1].mant.assign(1, 1);
+        }
+    };
+
+    // Size, in BASEX digits, below which the half gcd recursion bottoms out
+    // in Lehmer steps.
+    constexpr int32_t HGCDBASECASE = 256;
+
+    // Single precision cofactors of a Lehmer step are kept under this so the
+    // inner loop can not overflow, p*x + q*y plus a carry stays under 2^63
+    // for digits below 2^32.
+    constexpr int64_t LEHMERMAXCOFACTOR = (int64_t)1 << 30;
+
+    SIGNEDMANT smallsignedmant(uint64_t value)
+    {
+        SIGNEDMANT x;
+        while (value)
+        {
+            x.mant.push_back((MANTTYPE)(value & MANTMASK));
+            value >>= BASEXPWR;
+        }
+        return x;
+    }
+
+    int32_t bitlength(const SIGNEDMANT& x)
+    {
+        if (x.mant.empty())
+        {
+            return 0;
+        }
+        int32_t bits = static_cast<int32_t>(x.mant.size() - 1) * BASEXPWR;
+        for (MANTTYPE top = x.mant.back(); top; top >>= 1)
+        {
+            bits++;
+        }
+        return bits;
+    }
+
+    // Returns floor(x / 2^shift), which must fit in 64 bits.
+    uint64_t topbits(const SIGNEDMANT& x, int32_t shift)
+    {
+        const int32_t cx = static_cast<int32_t>(x.mant.size());
+        const int32_t idx = shift / BASEXPWR;
+        const int32_t off = shift % BASEXPWR;
+        if (idx >= cx)
+        {
+            return 0;
+        }
+        uint64_t value = 0;
+        for (int32_t i = cx - 1; i > idx; i--)
+        {
+            value = (value << BASEXPWR) | x.mant[i];
+        }
+        return (value << (BASEXPWR - off)) | (x.mant[idx] >> off);
+    }
+
+    int32_t cmpsignedmant(const SIGNEDMANT& x, const SIGNEDMANT& y)
+    {
+        return _cmpmant(x.mant.data(), static_cast<int32_t>(x.mant.size()), y.mant.data(), static_cast<int32_t>(y.mant.size()));
+    }
+
+    // Returns x / BASEX^digits, dropping the low digits.
+    SIGNEDMANT highdigits(const SIGNEDMANT& x, int32_t digits)
+    {
+        SIGNEDMANT high;
+        if (static_cast<int32_t>(x.mant.size()) > digits)
+        {
+            high.mant.assign(x.mant.begin() + digits, x.mant.end());
+        }
+        return high;
+    }
+
+    // (x, y) = (m00*x + m01*y, m10*x + m11*y)
+    void applymatrix(const SIGNEDMANT (&m)[2][2], SIGNEDMANT& x, SIGNEDMANT& y)
+    {
+        SIGNEDMANT nx = mulsignedmant(m[0][0], x);
+        addsignedmant(nx, mulsignedmant(m[0][1], y));
+        SIGNEDMANT ny = mulsignedmant(m[1][0], x);
+        addsignedmant(ny, mulsignedmant(m[1][1], y));
+        x = move(nx);
+        y = move(ny);
+    }
+
+    // r = l * r
+    void leftmulmatrix(const SIGNEDMANT (&l)[2][2], GCDMATRIX& r)
+    {
+        applymatrix(l, r.r[0][0], r.r[1][0]);
+        applymatrix(l, r.r[0][1], r.r[1][1]);
+    }
+
+    // Makes a and b non negative with a >= b, adjusting the matrix rows to
+    // match so it still maps the original operands onto a and b.
+    void normalizegcd(SIGNEDMANT& a, SIGNEDMANT& b, GCDMATRIX* pr)
+    {
+        SIGNEDMANT* vals[2] = { &a, &b };
+        for (int32_t i = 0; i < 2; i++)
+        {
+            if (vals[i]->sign < 0)
+            {
+                vals[i]->sign = 1;
+                if (pr != nullptr)
+                {
+                    pr->r[i][0].sign *= -1;
+                    pr->r[i][1].sign *= -1;
+                    trimsignedmant(pr->r[i][0]);
+                    trimsignedmant(pr->r[i][1]);
+                }
+            }
+        }
+        if (cmpsignedmant(a, b) < 0)
+        {
+            swap(a, b);
+            if (pr != nullptr)
+            {
+                swap(pr->r[0], pr->r[1]);
+            }
+        }
+    }
+
+    // One Euclid step, (a, b) = (b, a mod b).
+    void divstepgcd(SIGNEDMANT& a, SIGNEDMANT& b, GCDMATRIX* pr)
+    {
+        const int32_t ca = static_cast<int32_t>(a.mant.size());
+        const int32_t cb = static_cast<int32_t>(b.mant.size());
+        SIGNEDMANT q;
+        SIGNEDMANT r;
+        q.mant.resize(ca - cb + 1);
+        r.mant.resize(cb);
+        _divmantx(q.mant.data(), r.mant.data(), a.mant.data(), ca, b.mant.data(), cb);
+        trimsignedmant(q);
+        trimsignedmant(r);
+        a = move(b);
+        b = move(r);
+
+        if (pr != nullptr)
+        {
+            // rows become (row1, row0 - q*row1)
+            for (int32_t j = 0; j < 2; j++)
+            {
+                SIGNEDMANT qrow = mulsignedmant(q, pr->r[1][j]);
+                addsignedmant(pr->r[0][j], qrow, -1);
+                swap(pr->r[0][j], pr->r[1][j]);
+            }
+        }
+    }
+
+    // Returns p*x + q*y in a single pass, for |p|, |q| < LEHMERMAXCOFACTOR.
+    SIGNEDMANT lincombsmall(const SIGNEDMANT& x, const SIGNEDMANT& y, int64_t p, int64_t q)
+    {
+        const size_t cx = x.mant.size();
+        const size_t cr = max(cx, y.mant.size());
+        p *= x.sign;
+        q *= y.sign;
+
+        SIGNEDMANT r;
+        for (int32_t pass = 0; pass < 2; pass++)
+        {
+            r.mant.assign(cr + 2, 0);
+            int64_t cy = 0;
+            for (size_t i = 0; i < cr; i++)
+            {
+                const int64_t dx = (i < cx) ? x.mant[i] : 0;
+                const int64_t dy = (i < y.mant.size()) ? y.mant[i] : 0;
+                int64_t t = p * dx + q * dy + cy;
+                r.mant[i] = (MANTTYPE)(t & (int64_t)MANTMASK);
+                cy = t >> BASEXPWR;
+            }
+            if (cy >= 0)
+            {
+                r.mant[cr] = (MANTTYPE)(cy & (int64_t)MANTMASK);
+                r.mant[cr + 1] = (MANTTYPE)(cy >> BASEXPWR);
+                break;
+            }
+
+            // The result is negative, find its magnitude instead.
+            p = -p;
+            q = -q;
+            r.sign = -r.sign;
+        }
+        trimsignedmant(r);
+        return r;
+    }
+
+    // (x, y) = (A*x + B*y, C*x + D*y) for single precision cofactors.
+    void applysmallmatrix(SIGNEDMANT& x, SIGNEDMANT& y, int64_t A, int64_t B, int64_t C, int64_t D)
+    {
+        SIGNEDMANT nx = lincombsmall(x, y, A, B);
+        y = lincombsmall(x, y, C, D);
+        x = move(nx);
+    }
+
+    // Lehmer step, returns false if the leading bits could not settle a
+    // single quotient, in which case the caller should take a division step.
+    bool lehmerstepgcd(SIGNEDMANT& a, SIGNEDMANT& b, GCDMATRIX* pr)
+    {
+        const int32_t shift = max(0, bitlength(a) - 62);
+        int64_t x = (int64_t)topbits(a, shift);
+        int64_t y = (int64_t)topbits(b, shift);
+
+        // Collins' condition, continue while the quotients of the leading
+        // bits with both extreme cofactors agree.
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        while (y + C > 0 && y + D > 0)
+        {
+            int64_t q = (x + A) / (y + C);
+            if (q != (x + B) / (y + D) || q >= LEHMERMAXCOFACTOR)
+            {
+                break;
+            }
+            int64_t nC = A - q * C;
+            int64_t nD = B - q * D;
+            if (nC >= LEHMERMAXCOFACTOR || nC <= -LEHMERMAXCOFACTOR || nD >= LEHMERMAXCOFACTOR || nD <= -LEHMERMAXCOFACTOR)
+            {
+                break;
+            }
+            A = C;
+            B = D;
+            C = nC;
+            D = nD;
+            int64_t t = x - q * y;
+            x = y;
+            y = t;
+        }
+
+        if (B == 0)
+        {
+            return false;
+        }
+
+        applysmallmatrix(a, b, A, B, C, D);
+        if (pr != nullptr)
+        {
+            applysmallmatrix(pr->r[0][0], pr->r[1][0], A, B, C, D);
+            applysmallmatrix(pr->r[0][1], pr->r[1][1], A, B, C, D);
+        }
+        normalizegcd(a, b, pr);
+        return true;
+    }
+
+    // Takes Lehmer or division steps until b has at most target digits.
+    void stepgcd(SIGNEDMANT& a, SIGNEDMANT& b, GCDMATRIX* pr, size_t target)
+    {
+        while (b.mant.size() > target)
+        {
+            if (a.mant.size() > b.mant.size() + 1 || !lehmerstepgcd(a, b, pr))
+            {
+                divstepgcd(a, b, pr);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    //
+    //    FUNCTION: halfgcd
+    //
+    //    DESCRIPTION: Reduces a >= b, with a of n digits, until b has about
+    //    n/2 digits, and if pr is not null multiplies *pr by the matrix that
+    //    did it.  The matrix that reduces the top half of the operands is
+    //    found recursively and applied to the whole operands, which takes
+    //    them down to about 3n/4 digits, and a second recursion on the top
+    //    of what is left takes them the rest of the way.
+    //
+    //------------------------------------------------------------------------
+
+    void halfgcd(SIGNEDMANT& a, SIGNEDMANT& b, GCDMATRIX* pr)
+    {
+        const size_t n = a.mant.size();
+        const size_t target = n / 2 + 1;
+        if (b.mant.size() <= target)
+        {
+            return;
+        }
+
+        if (n < (size_t)max(min(g_hgcdThreshold, HGCDBASECASE), 8))
+        {
+            stepgcd(a, b, pr, target);
+            return;
+        }
+
+        // First half, from the top n - n/2 digits.
+        {
+            const int32_t split = static_cast<int32_t>(n / 2);
+            SIGNEDMANT ahigh = highdigits(a, split);
+            SIGNEDMANT bhigh = highdigits(b, split);
+            GCDMATRIX r1;
+            halfgcd(ahigh, bhigh, &r1);
+            applymatrix(r1.r, a, b);
+            normalizegcd(a, b, &r1);
+            if (pr != nullptr)
+            {
+                leftmulmatrix(r1.r, *pr);
+            }
+        }
+
+        // Second half, from enough of the top of what is left to bring b
+        // down to the target.
+        const int32_t split = static_cast<int32_t>(2 * target) - static_cast<int32_t>(a.mant.size());
+        if (b.mant.size() > target && split > 0)
+        {
+            SIGNEDMANT ahigh = highdigits(a, split);
+            SIGNEDMANT bhigh = highdigits(b, split);
+            GCDMATRIX r2;
+            halfgcd(ahigh, bhigh, &r2);
+            applymatrix(r2.r, a, b);
+            normalizegcd(a, b, &r2);
+            if (pr != nullptr)
+            {
+                leftmulmatrix(r2.r, *pr);
+            }
+        }
+
+        stepgcd(a, b, pr, target);
+    }
+
+    uint64_t binarygcd(uint64_t u, uint64_t v)
+    {
+        if (u == 0 || v == 0)
+        {
+            return u | v;
+        }
+
+        int32_t shift = 0;
+        while (((u | v) & 1) == 0)
+        {
+            u >>= 1;
+            v >>= 1;
+            shift++;
+        }
+        while ((u & 1) == 0)
+        {
+            u >>= 1;
+        }
+        do
+        {
+            while ((v & 1) == 0)
+            {
+                v >>= 1;
+            }
+            if (u > v)
+            {
+                swap(u, v);
+            }
+            v -= u;
+        } while (v != 0);
+        return u << shift;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+//    FUNCTION: _gcdmantx
+//
+//    ARGUMENTS: two mantissas with their digit counts, the first with room
+//               for the result.
+//
+//    RETURN: digit count of the gcd, which is written over pa.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pa = gcd(pa, pb) in BASEX.
+//
+//----------------------------------------------------------------------------
+
+int32_t _gcdmantx(_Inout_ MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb)
+{
+    SIGNEDMANT a = makesignedmant(pa, ca);
+    SIGNEDMANT b = makesignedmant(pb, cb);
+    normalizegcd(a, b, nullptr);
+
+    while (!b.mant.empty())
+    {
+        if (bitlength(a) <= 64)
+        {
+            a = smallsignedmant(binarygcd(topbits(a, 0), topbits(b, 0)));
+            break;
+        }
+
+        const size_t ca = a.mant.size();
+        if (ca > b.mant.size() + 1)
+        {
+            divstepgcd(a, b, nullptr);
+        }
+        else if ((int32_t)b.mant.size() >= g_hgcdThreshold)
+        {
+            halfgcd(a, b, nullptr);
+            if (a.mant.size() >= ca && !b.mant.empty())
+            {
+                divstepgcd(a, b, nullptr);
+            }
+        }
+        else if (!lehmerstepgcd(a, b, nullptr))
+        {
+            divstepgcd(a, b, nullptr);
+        }
+    }
+
+    if (a.mant.empty())
+    {
+        a.mant.push_back(0);
+    }
+    copy(a.mant.begin(), a.mant.end(), pa);
+    return static_cast<int32_t>(a.mant.size());
 }
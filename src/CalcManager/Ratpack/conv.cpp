@@ -20,6 +20,7 @@
 #include <algorithm>
 #include "winerror_cross_platform.h"
 #include <sstream>
+#include <vector>
 #include <cstring> // for memmove, memcpy
 #include "ratpak.h"
 
@@ -32,9 +33,9 @@ static constexpr wstring_view DIGITS = L"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabc
 
 // ratio of internal 'digits' to output 'digits'
 // Calculated elsewhere as part of initialization and when base is changed
-int32_t g_ratio; // int(log(2L^BASEXPWR)/log(radix))
+thread_local int32_t g_ratio; // int(log(2L^BASEXPWR)/log(radix))
 // Default decimal separator
-wchar_t g_decimalSeparator = L'.';
+thread_local wchar_t g_decimalSeparator = L'.';
 
 // The following defines and Calc_ULong* functions were taken from
 // https://github.com/dotnet/coreclr/blob/8b1595b74c943b33fa794e63e440e6f4c9679478/src/pal/inc/rt/intsafe.h
@@ -108,12 +109,215 @@ void SetDecimalSeparator(wchar_t decimalSeparator)
     g_decimalSeparator = decimalSeparator;
 }
 
+//-----------------------------------------------------------------------------
+//
+//  NUMBER and RAT allocation
 //
-// Windows heap allocation
+//     Numbers are created and destroyed at a very high rate, DUPNUM alone is
+//  a free and a calloc, so blocks are kept on per thread freelists instead of
+//  going back to the heap.  Number blocks are grouped in size classes of a
+//  power of two digits, every block carries a small header recording its
+//  class so _destroynum knows which list it belongs on.  Blocks larger than
+//  the biggest class, and blocks beyond the limit kept per class, go
+//  straight back to the heap.
 //
-void* zmalloc(size_t a)
+//     Define RATPAK_NO_POOL to bypass the freelists.
+//
+//-----------------------------------------------------------------------------
+
+namespace
 {
-    return calloc(a, sizeof(unsigned char));
+    union POOLHEADER
+    {
+        POOLHEADER* next;   // Next free block while on a freelist
+        uint32_t sizeclass; // Class of the block while in use
+    };
+
+    constexpr uint32_t POOLMINCLASS = 2;               // Smallest class holds 4 digits
+    constexpr uint32_t POOLCLASSES = 16;               // Classes up to 32768 digits
+    constexpr uint32_t POOLRATCLASS = POOLCLASSES;     // Freelist used for RATs
+    constexpr uint32_t POOLNOCLASS = UINT32_MAX;       // Block always goes back to the heap
+    constexpr size_t POOLMAXBLOCKS = 128;              // Blocks kept per class
+    constexpr size_t POOLMAXBYTES = ((size_t)1) << 20; // Bytes kept per class
+
+    size_t poolblockbytes(uint32_t sizeclass)
+    {
+        if (sizeclass == POOLRATCLASS)
+        {
+            return sizeof(POOLHEADER) + sizeof(RAT);
+        }
+        return sizeof(POOLHEADER) + sizeof(NUMBER) + (((size_t)1) << sizeclass) * sizeof(MANTTYPE);
+    }
+
+    thread_local POOLSTATS t_poolstats = {};
+
+    // Set once the freelists of the thread have been torn down, numbers destroyed
+    // after that point (from other thread local destructors) go to the heap.
+    thread_local bool t_fpoolgone = false;
+
+    void* heapalloc(size_t cb)
+    {
+        void* pv = malloc(cb);
+        if (pv == nullptr)
+        {
+            throw(CALC_E_OUTOFMEMORY);
+        }
+        t_poolstats.cheapalloc++;
+        return pv;
+    }
+
+    void heapfree(void* pv)
+    {
+        t_poolstats.cheapfree++;
+        free(pv);
+    }
+
+    struct FREELISTS
+    {
+        POOLHEADER* head[POOLCLASSES + 1] = {};
+        size_t cfree[POOLCLASSES + 1] = {};
+
+        ~FREELISTS()
+        {
+            release();
+            t_fpoolgone = true;
+        }
+
+        void release()
+        {
+            for (uint32_t i = 0; i <= POOLCLASSES; i++)
+            {
+                while (head[i] != nullptr)
+                {
+                    POOLHEADER* ph = head[i];
+                    head[i] = ph->next;
+                    heapfree(ph);
+                }
+                cfree[i] = 0;
+            }
+        }
+
+        POOLHEADER* pop(uint32_t sizeclass)
+        {
+            POOLHEADER* ph = head[sizeclass];
+            if (ph != nullptr)
+            {
+                head[sizeclass] = ph->next;
+                cfree[sizeclass]--;
+            }
+            return ph;
+        }
+
+        bool push(POOLHEADER* ph, uint32_t sizeclass)
+        {
+            if (cfree[sizeclass] >= std::min(POOLMAXBLOCKS, POOLMAXBYTES / poolblockbytes(sizeclass)))
+            {
+                return false;
+            }
+            ph->next = head[sizeclass];
+            head[sizeclass] = ph;
+            cfree[sizeclass]++;
+            return true;
+        }
+    };
+
+#if !defined(RATPAK_NO_POOL)
+    thread_local FREELISTS t_freelists;
+#endif
+
+    //-----------------------------------------------------------------------------
+    //
+    //    FUNCTION: poolalloc
+    //
+    //    ARGUMENTS: size class, and the number of bytes wanted if the block
+    //               does not belong to a class.
+    //
+    //    RETURN: pointer past the header of a block of at least that size,
+    //            its contents are undefined.
+    //
+    //-----------------------------------------------------------------------------
+
+    void* poolalloc(uint32_t sizeclass, size_t cb, [[maybe_unused]] uint64_t* pchit)
+    {
+        POOLHEADER* ph = nullptr;
+#if !defined(RATPAK_NO_POOL)
+        if (sizeclass != POOLNOCLASS && !t_fpoolgone)
+        {
+            ph = t_freelists.pop(sizeclass);
+            if (ph != nullptr)
+            {
+                (*pchit)++;
+            }
+        }
+#endif
+        if (ph == nullptr)
+        {
+            ph = (POOLHEADER*)heapalloc((sizeclass != POOLNOCLASS) ? poolblockbytes(sizeclass) : sizeof(POOLHEADER) + cb);
+        }
+        ph->sizeclass = sizeclass;
+        return ph + 1;
+    }
+
+    void poolfree(void* pv)
+    {
+        POOLHEADER* ph = ((POOLHEADER*)pv) - 1;
+#if !defined(RATPAK_NO_POOL)
+        if (ph->sizeclass != POOLNOCLASS && !t_fpoolgone && t_freelists.push(ph, ph->sizeclass))
+        {
+            return;
+        }
+#endif
+        heapfree(ph);
+    }
+
+    // Smallest class holding cdigit digits, or POOLNOCLASS if none does.
+    uint32_t numsizeclass(uint32_t cdigit)
+    {
+        uint32_t sizeclass = POOLMINCLASS;
+        while (sizeclass < POOLCLASSES && (((uint32_t)1) << sizeclass) < cdigit)
+        {
+            sizeclass++;
+        }
+        return (sizeclass < POOLCLASSES) ? sizeclass : POOLNOCLASS;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: getpoolstats, resetpoolstats
+//
+//    DESCRIPTION: Reads or clears the allocation counters of the calling
+//    thread.
+//
+//-----------------------------------------------------------------------------
+
+void getpoolstats(_Out_ POOLSTATS* pstats)
+{
+    *pstats = t_poolstats;
+}
+
+void resetpoolstats()
+{
+    t_poolstats = {};
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: trimpool
+//
+//    DESCRIPTION: Returns every block on the freelists of the calling thread
+//    to the heap.
+//
+//-----------------------------------------------------------------------------
+
+void trimpool()
+{
+#if !defined(RATPAK_NO_POOL)
+    if (!t_fpoolgone)
+    {
+        t_freelists.release();
+    }
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -124,13 +328,75 @@ void* zmalloc(size_t a)
 //
 //    RETURN: None
 //
-//    DESCRIPTION: Copies the source to the destination
+//    DESCRIPTION: Copies the source to the start of the buffer of the
+//    destination, which must have room for the digits of the source.  The
+//    destination keeps its own capacity.
 //
 //-----------------------------------------------------------------------------
 
 void _dupnum(_In_ PNUMBER dest, _In_ const NUMBER* const src)
 {
-    memcpy(dest, src, (int)(sizeof(NUMBER) + ((src)->cdigit) * (sizeof(MANTTYPE))));
+    if (dest != src)
+    {
+        dest->sign = src->sign;
+        dest->cdigit = src->cdigit;
+        dest->exp = src->exp;
+        dest->mant = MANTBASE(dest);
+        memcpy(dest->mant, src->mant, src->cdigit * sizeof(MANTTYPE));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: rawtonum
+//
+//    ARGUMENTS: pointer to a number laid out with its digits inline
+//
+//    RETURN: a new number with the same value
+//
+//-----------------------------------------------------------------------------
+
+PNUMBER rawtonum(_In_ const RAWNUMBER* praw)
+{
+    PNUMBER pnum = nullptr;
+    createnum(pnum, praw->cdigit);
+    pnum->sign = praw->sign;
+    pnum->cdigit = praw->cdigit;
+    pnum->exp = praw->exp;
+    memcpy(pnum->mant, praw->mant, praw->cdigit * sizeof(MANTTYPE));
+    return pnum;
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: reservenum
+//
+//    ARGUMENTS: pointer to a number, count of digits
+//
+//    RETURN: None, may change the pointer.
+//
+//    DESCRIPTION: Makes sure the mantissa has room for cdigit digits,
+//    moving it to the start of its buffer, or to a larger buffer, when it
+//    does not.  The value is unchanged.
+//
+//-----------------------------------------------------------------------------
+
+void reservenum(_Inout_ PNUMBER* pa, int32_t cdigit)
+{
+    PNUMBER a = *pa;
+    if (a->cdigitmax < cdigit)
+    {
+        PNUMBER pnum = nullptr;
+        createnum(pnum, cdigit);
+        _dupnum(pnum, a);
+        destroynum(*pa);
+        *pa = pnum;
+    }
+    else if (a->mant + cdigit > MANTBASE(a) + a->cdigitmax)
+    {
+        memmove(MANTBASE(a), a->mant, a->cdigit * sizeof(MANTTYPE));
+        a->mant = MANTBASE(a);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -150,7 +416,7 @@ void _destroynum(_Frees_ptr_opt_ PNUMBER pnum)
 {
     if (pnum != nullptr)
     {
-        free(pnum);
+        poolfree(pnum);
     }
 }
 
@@ -174,7 +440,7 @@ void _destroyrat(_Frees_ptr_opt_ PRAT prat)
     {
         destroynum(prat->pp);
         destroynum(prat->pq);
-        free(prat);
+        poolfree(prat);
     }
 }
 
@@ -186,7 +452,9 @@ void _destroyrat(_Frees_ptr_opt_ PRAT prat)
 //
 //    RETURN: pointer to a number
 //
-//    DESCRIPTION: allocates and zeros out number type.
+//    DESCRIPTION: allocates and zeros out number type.  The capacity
+//    recorded in cdigitmax is that of the block actually handed out, which
+//    for a pooled block is rounded up to its size class.
 //
 //-----------------------------------------------------------------------------
 
@@ -200,11 +468,14 @@ PNUMBER _createnum(_In_ uint32_t size)
     if (SUCCEEDED(Calc_ULongAdd(size, 1, &cbAlloc)) && SUCCEEDED(Calc_ULongMult(cbAlloc, sizeof(MANTTYPE), &cbAlloc))
         && SUCCEEDED(Calc_ULongAdd(cbAlloc, sizeof(NUMBER), &cbAlloc)))
     {
-        pnumret = (PNUMBER)zmalloc(cbAlloc);
-        if (pnumret == nullptr)
-        {
-            throw(CALC_E_OUTOFMEMORY);
-        }
+        uint32_t sizeclass = numsizeclass(size + 1);
+        t_poolstats.cnumcreate++;
+        pnumret = (PNUMBER)poolalloc(sizeclass, cbAlloc, &t_poolstats.cnumhit);
+        memset(pnumret, 0, cbAlloc);
+        pnumret->mant = MANTBASE(pnumret);
+        // Like size, the capacity leaves out the spare digit every number
+        // is allocated with.
+        pnumret->cdigitmax = (sizeclass != POOLNOCLASS) ? (int32_t)((((uint32_t)1) << sizeclass) - 1) : (int32_t)size;
     }
     else
     {
@@ -232,12 +503,8 @@ PRAT _createrat(void)
 {
     PRAT prat = nullptr;
 
-    prat = (PRAT)zmalloc(sizeof(RAT));
-
-    if (prat == nullptr)
-    {
-        throw(CALC_E_OUTOFMEMORY);
-    }
+    t_poolstats.cratcreate++;
+    prat = (PRAT)poolalloc(POOLRATCLASS, sizeof(RAT), &t_poolstats.crathit);
     prat->pp = nullptr;
     prat->pq = nullptr;
     return (prat);
@@ -286,6 +553,209 @@ PRAT numtorat(_In_ PNUMBER pin, uint32_t radix)
     return (pout);
 }
 
+//-----------------------------------------------------------------------------
+//
+//  Radix conversion out of BASEX
+//
+//     An integer mantissa is converted by divide and conquer.  With P(j) the
+//  power of the radix chunk^(2^j), chunk being the largest power of the
+//  radix that fits in one digit, a value below P(j)^2 splits into a quotient
+//  and a remainder by P(j), each below P(j), and the remainder supplies
+//  exactly cchunk * 2^j radix digits.  The divisions use the fast kernels
+//  so the whole conversion costs a few multiplications of the full size
+//  times log n.  Below g_radixConvThreshold digits the mantissa is divided
+//  by chunk one digit at a time instead.
+//
+//     The powers only depend on the radix so they are kept per thread and
+//  grown by squaring as longer numbers come along.
+//
+//     Radices that are a power of two need no arithmetic at all, the output
+//  digits are read straight out of the bits.
+//
+//-----------------------------------------------------------------------------
+
+// Size, in BASEX digits, at which radix conversion switches from short
+// division to divide and conquer.
+int32_t g_radixConvThreshold = RADIX_CONV_THRESHOLD;
+
+namespace
+{
+    struct RADIXPOWERS
+    {
+        uint32_t radix;
+        MANTTYPE chunk;                  // Largest power of radix that fits in a digit
+        int32_t cchunk;                  // Radix digits in chunk
+        vector<vector<MANTTYPE>> powers; // powers[j] is chunk^(2^j)
+    };
+
+    // One entry per radix seen on this thread.
+    thread_local vector<RADIXPOWERS> t_radixpowers;
+
+    int32_t trimmant(const MANTTYPE* p, int32_t c)
+    {
+        while (c > 0 && p[c - 1] == 0)
+        {
+            c--;
+        }
+        return c;
+    }
+
+    // Powers of the radix up to at least P(j), all of them kept in the cache.
+    const RADIXPOWERS& radixpowers(uint32_t radix, int32_t j)
+    {
+        auto it = find_if(t_radixpowers.begin(), t_radixpowers.end(), [radix](const RADIXPOWERS& rp) { return rp.radix == radix; });
+        if (it == t_radixpowers.end())
+        {
+            RADIXPOWERS rp{ radix, 1, 0, {} };
+            while ((TWO_MANTTYPE)rp.chunk * radix < BASEX)
+            {
+                rp.chunk *= radix;
+                rp.cchunk++;
+            }
+            rp.powers.push_back({ rp.chunk });
+            t_radixpowers.push_back(move(rp));
+            it = t_radixpowers.end() - 1;
+        }
+
+        auto& powers = it->powers;
+        while (static_cast<int32_t>(powers.size()) <= j)
+        {
+            const vector<MANTTYPE>& last = powers.back();
+            int32_t clast = static_cast<int32_t>(last.size());
+            vector<MANTTYPE> square(2 * clast);
+            _mulmantx(square.data(), last.data(), clast, last.data(), clast);
+            square.resize(trimmant(square.data(), 2 * clast));
+            powers.push_back(move(square));
+        }
+        return *it;
+    }
+
+    // Writes the cout low radix digits of p, digit by digit of p.
+    void radixconvbase(const RADIXPOWERS& rp, const MANTTYPE* p, int32_t cp, MANTTYPE* pout, int32_t cout)
+    {
+        vector<MANTTYPE> t(p, p + cp);
+        MANTTYPE* pend = pout + cout;
+        cp = trimmant(t.data(), cp);
+        while (cp > 0 && pout < pend)
+        {
+            TWO_MANTTYPE rem = 0;
+            for (int32_t i = cp - 1; i >= 0; i--)
+            {
+                rem = (rem << BASEXPWR) | t[i];
+                t[i] = (MANTTYPE)(rem / rp.chunk);
+                rem %= rp.chunk;
+            }
+            cp = trimmant(t.data(), cp);
+            for (int32_t i = 0; i < rp.cchunk && pout < pend; i++)
+            {
+                *pout++ = (MANTTYPE)(rem % rp.radix);
+                rem /= rp.radix;
+            }
+        }
+        fill(pout, pend, (MANTTYPE)0);
+    }
+
+    // Writes the cout low radix digits of p, p below P(j+1).
+    void radixconv(const RADIXPOWERS& rp, const MANTTYPE* p, int32_t cp, int32_t j, MANTTYPE* pout, int32_t cout)
+    {
+        cp = trimmant(p, cp);
+        if (j < 0 || cp < g_radixConvThreshold)
+        {
+            radixconvbase(rp, p, cp, pout, cout);
+            return;
+        }
+
+        const vector<MANTTYPE>& power = rp.powers[j];
+        int32_t cpower = static_cast<int32_t>(power.size());
+        int32_t clow = rp.cchunk << j;
+        if (_cmpmant(p, cp, power.data(), cpower) < 0)
+        {
+            radixconv(rp, p, cp, j - 1, pout, clow);
+            fill(pout + clow, pout + cout, (MANTTYPE)0);
+            return;
+        }
+
+        vector<MANTTYPE> quot(cp - cpower + 1);
+        vector<MANTTYPE> rem(cpower);
+        _divmantx(quot.data(), rem.data(), p, cp, power.data(), cpower);
+        radixconv(rp, rem.data(), cpower, j - 1, pout, clow);
+        radixconv(rp, quot.data(), cp - cpower + 1, j - 1, pout + clow, cout - clow);
+    }
+
+    // Splits the bits of p into radix digits, radix being 2^cbits.
+    void radixconvbits(const MANTTYPE* p, int32_t cp, uint32_t cbits, MANTTYPE* pout, int32_t cout)
+    {
+        const MANTTYPE mask = (((MANTTYPE)1) << cbits) - 1;
+        for (int32_t i = 0; i < cout; i++)
+        {
+            uint64_t bit = (uint64_t)i * cbits;
+            int32_t idigit = static_cast<int32_t>(bit / BASEXPWR);
+            uint32_t shift = static_cast<uint32_t>(bit % BASEXPWR);
+            TWO_MANTTYPE window = p[idigit] >> shift;
+            if (shift + cbits > BASEXPWR && idigit + 1 < cp)
+            {
+                window |= (TWO_MANTTYPE)p[idigit + 1] << (BASEXPWR - shift);
+            }
+            pout[i] = (MANTTYPE)window & mask;
+        }
+    }
+
+    // Integer p in BASEX to a number in radix.
+    PNUMBER radixconvnum(const MANTTYPE* p, int32_t cp, uint32_t radix)
+    {
+        cp = trimmant(p, cp);
+        if (cp == 0)
+        {
+            return i32tonum(0, radix);
+        }
+
+        vector<MANTTYPE> digits;
+        uint32_t cbits = 0;
+        while ((((uint32_t)1) << cbits) < radix)
+        {
+            cbits++;
+        }
+
+        if ((((uint32_t)1) << cbits) == radix)
+        {
+            digits.resize(((uint64_t)cp * BASEXPWR + cbits - 1) / cbits);
+            radixconvbits(p, cp, cbits, digits.data(), static_cast<int32_t>(digits.size()));
+        }
+        else
+        {
+            // Find the smallest P(j) whose square is longer than p.
+            int32_t j = -1;
+            if (cp >= g_radixConvThreshold)
+            {
+                j = 0;
+                while (2 * static_cast<int32_t>(radixpowers(radix, j).powers[j].size()) - 2 < cp)
+                {
+                    j++;
+                }
+            }
+            const RADIXPOWERS& rp = radixpowers(radix, max(j, 0));
+
+            // radix^(cchunk+1) is at least BASEX, which bounds the digits of p.
+            int32_t cout = cp * (rp.cchunk + 1);
+            if (j >= 0)
+            {
+                cout = max(cout, rp.cchunk << (j + 1));
+            }
+            digits.resize(cout);
+            radixconv(rp, p, cp, j, digits.data(), cout);
+        }
+
+        int32_t cdigit = max(trimmant(digits.data(), static_cast<int32_t>(digits.size())), 1);
+        PNUMBER pnumret = nullptr;
+        createnum(pnumret, cdigit);
+        pnumret->cdigit = cdigit;
+        pnumret->sign = 1;
+        pnumret->exp = 0;
+        memcpy(pnumret->mant, digits.data(), cdigit * sizeof(MANTTYPE));
+        return pnumret;
+    }
+}
+
 //----------------------------------------------------------------------------
 //
 //    FUNCTION: nRadixxtonum
@@ -303,12 +773,11 @@ PRAT numtorat(_In_ PNUMBER pin, uint32_t radix)
 PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
 
 {
-    uint32_t bitmask;
     uint32_t cdigits;
-    MANTTYPE* ptr;
 
-    PNUMBER sum = i32tonum(0, radix);
-    PNUMBER powofnRadix = i32tonum(BASEX, radix);
+    // BASEX itself is one more than fits in 32 bits, so double BASEX/2.
+    PNUMBER powofnRadix = Ui32tonum(static_cast<uint32_t>(BASEX / 2), radix);
+    addnum(&powofnRadix, powofnRadix, radix);
 
     // A large penalty is paid for conversion of digits no one will see anyway.
     // limit the digits to the minimum of the existing precision or the
@@ -322,26 +791,174 @@ PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
     // scale by the internal base to the internal exponent offset of the LSD
     numpowi32(&powofnRadix, a->exp + (a->cdigit - cdigits), radix, precision);
 
-    // Loop over all the relative digits from MSD to LSD
-    for (ptr = &(a->mant[a->cdigit - 1]); cdigits > 0; ptr--, cdigits--)
+    // Convert the relative digits as an integer.
+    PNUMBER sum = radixconvnum(&(a->mant[a->cdigit - cdigits]), cdigits, radix);
+
+    // Scale answer by power of internal exponent.
+    mulnum(&sum, powofnRadix, radix);
+
+    destroynum(powofnRadix);
+    sum->sign = a->sign;
+    return (sum);
+}
+
+//-----------------------------------------------------------------------------
+//
+//  Radix conversion into BASEX
+//
+//     The digits of the radix are packed cchunk at a time into one BASEX
+//  digit, so a short number is built with one multiply by chunk and one add
+//  per cchunk input digits.  Above g_radixConvThreshold BASEX digits the
+//  digits are split in two at cchunk * 2^j, with P(j) the same cached power
+//  used for output, both halves are converted and the result is
+//  high * P(j) + low with the fast multiply.
+//
+//     Radices that are a power of two again need no arithmetic, the digits
+//  are written straight into the bits.
+//
+//-----------------------------------------------------------------------------
+
+namespace
+{
+    // Value of the count radix digits at p, LSD first, count at most cchunk.
+    MANTTYPE radixchunk(uint32_t radix, const MANTTYPE* p, int32_t count)
     {
-        // Loop over all the bits from MSB to LSB
-        for (bitmask = BASEX / 2; bitmask > 0; bitmask /= 2)
+        MANTTYPE chunk = 0;
+        while (count-- > 0)
+        {
+            chunk = chunk * radix + p[count];
+        }
+        return chunk;
+    }
+
+    // Writes the value of the cdigit radix digits at p into pout, cout digits long.
+    void radixinbase(const RADIXPOWERS& rp, const MANTTYPE* p, int32_t cdigit, MANTTYPE* pout, int32_t cout)
+    {
+        fill(pout, pout + cout, (MANTTYPE)0);
+        int32_t cp = 0;
+
+        // The most significant chunk may be short, the rest are full.
+        int32_t ctop = cdigit % rp.cchunk;
+        if (ctop == 0)
         {
-            addnum(&sum, sum, radix);
-            if (*ptr & bitmask)
+            ctop = rp.cchunk;
+        }
+        for (int32_t idigit = cdigit - ctop; idigit >= 0; idigit -= rp.cchunk)
+        {
+            TWO_MANTTYPE cy = radixchunk(rp.radix, p + idigit, idigit + rp.cchunk > cdigit ? ctop : rp.cchunk);
+            for (int32_t i = 0; i < cp; i++)
+            {
+                cy += (TWO_MANTTYPE)pout[i] * rp.chunk;
+                pout[i] = (MANTTYPE)cy;
+                cy >>= BASEXPWR;
+            }
+            if (cy)
             {
-                sum->mant[0] |= 1;
+                pout[cp++] = (MANTTYPE)cy;
             }
         }
     }
 
-    // Scale answer by power of internal exponent.
-    mulnum(&sum, powofnRadix, radix);
+    // Writes the value of the cdigit radix digits at p into pout, cout digits
+    // long, cdigit at most cchunk * 2^(j+1).
+    void radixin(const RADIXPOWERS& rp, const MANTTYPE* p, int32_t cdigit, int32_t j, MANTTYPE* pout, int32_t cout)
+    {
+        if (j < 0 || cdigit / rp.cchunk < g_radixConvThreshold)
+        {
+            radixinbase(rp, p, cdigit, pout, cout);
+            return;
+        }
 
-    destroynum(powofnRadix);
-    sum->sign = a->sign;
-    return (sum);
+        int32_t clow = rp.cchunk << j;
+        if (cdigit <= clow)
+        {
+            radixin(rp, p, cdigit, j - 1, pout, cout);
+            return;
+        }
+
+        // Both halves are below P(j), the extra digit is room for the
+        // products one level down.
+        const vector<MANTTYPE>& power = rp.powers[j];
+        int32_t cpower = static_cast<int32_t>(power.size());
+        vector<MANTTYPE> low(cpower + 1);
+        vector<MANTTYPE> high(cpower + 1);
+        radixin(rp, p, clow, j - 1, low.data(), cpower + 1);
+        radixin(rp, p + clow, cdigit - clow, j - 1, high.data(), cpower + 1);
+
+        int32_t chigh = max(trimmant(high.data(), cpower), 1);
+        fill(pout, pout + cout, (MANTTYPE)0);
+        _mulmantx(pout, high.data(), chigh, power.data(), cpower);
+        _addmant(pout, cout, low.data(), cpower);
+    }
+
+    // Packs radix digits of cbits bits each into p, cp digits long.
+    void radixinbits(const MANTTYPE* pdigit, int32_t cdigit, uint32_t cbits, MANTTYPE* p, int32_t cp)
+    {
+        fill(p, p + cp, (MANTTYPE)0);
+        for (int32_t i = 0; i < cdigit; i++)
+        {
+            uint64_t bit = (uint64_t)i * cbits;
+            int32_t idigit = static_cast<int32_t>(bit / BASEXPWR);
+            uint32_t shift = static_cast<uint32_t>(bit % BASEXPWR);
+            TWO_MANTTYPE window = (TWO_MANTTYPE)pdigit[i] << shift;
+            p[idigit] |= (MANTTYPE)window;
+            if (shift + cbits > BASEXPWR)
+            {
+                p[idigit + 1] |= (MANTTYPE)(window >> BASEXPWR);
+            }
+        }
+    }
+
+    // Integer made of the cdigit radix digits at p, LSD first, to a number in BASEX.
+    PNUMBER radixinnum(const MANTTYPE* p, int32_t cdigit, uint32_t radix)
+    {
+        vector<MANTTYPE> mant;
+        uint32_t cbits = 0;
+        while ((((uint32_t)1) << cbits) < radix)
+        {
+            cbits++;
+        }
+
+        if ((((uint32_t)1) << cbits) == radix)
+        {
+            mant.resize(((uint64_t)cdigit * cbits + BASEXPWR - 1) / BASEXPWR);
+            radixinbits(p, cdigit, cbits, mant.data(), static_cast<int32_t>(mant.size()));
+        }
+        else
+        {
+            // Find the smallest j with cdigit at most cchunk * 2^(j+1).
+            const RADIXPOWERS& rp0 = radixpowers(radix, 0);
+            int32_t j = -1;
+            if (cdigit / rp0.cchunk >= g_radixConvThreshold)
+            {
+                j = 0;
+                while ((static_cast<int64_t>(rp0.cchunk) << (j + 1)) < cdigit)
+                {
+                    j++;
+                }
+            }
+            const RADIXPOWERS& rp = radixpowers(radix, max(j, 0));
+
+            // Each chunk of digits adds at most one BASEX digit, and the
+            // product tree needs room for high * P(j).
+            int32_t cout = cdigit / rp.cchunk + 1;
+            if (j >= 0)
+            {
+                cout = max(cout, 2 * static_cast<int32_t>(rp.powers[j].size()));
+            }
+            mant.resize(cout);
+            radixin(rp, p, cdigit, j, mant.data(), cout);
+        }
+
+        int32_t cmant = max(trimmant(mant.data(), static_cast<int32_t>(mant.size())), 1);
+        PNUMBER pnumret = nullptr;
+        createnum(pnumret, cmant);
+        pnumret->cdigit = cmant;
+        pnumret->sign = 1;
+        pnumret->exp = 0;
+        memcpy(pnumret->mant, mant.data(), cmant * sizeof(MANTTYPE));
+        return pnumret;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -360,28 +977,11 @@ PNUMBER nRadixxtonum(_In_ PNUMBER a, uint32_t radix, int32_t precision)
 
 PNUMBER numtonRadixx(_In_ PNUMBER a, uint32_t radix)
 {
-    PNUMBER pnumret = i32tonum(0, BASEX); // pnumret is the number in internal form.
-    PNUMBER num_radix = i32tonum(radix, BASEX);
-    MANTTYPE* ptrdigit = a->mant; // pointer to digit being worked on.
-
-    // Digits are in reverse order, back over them LSD first.
-    ptrdigit += a->cdigit - 1;
-
-    PNUMBER thisdigit = nullptr; // thisdigit holds the current digit of a
-                                 // being summed into result.
-    int32_t idigit;              // idigit is the iterate of digits in a.
-    for (idigit = 0; idigit < a->cdigit; idigit++)
-    {
-        mulnumx(&pnumret, num_radix);
-        // WARNING:
-        // This should just smack in each digit into a 'special' thisdigit.
-        // and not do the overhead of recreating the number type each time.
-        thisdigit = i32tonum(*ptrdigit--, BASEX);
-        addnum(&pnumret, thisdigit, BASEX);
-        destroynum(thisdigit);
-    }
+    // Convert the digits as an integer, pnumret is the number in internal form.
+    PNUMBER pnumret = radixinnum(a->mant, a->cdigit, radix);
 
     // Calculate the exponent of the external base for scaling.
+    PNUMBER num_radix = i32tonum(radix, BASEX);
     numpowi32x(&num_radix, a->exp);
 
     // ... and scale the result.
@@ -395,6 +995,63 @@ PNUMBER numtonRadixx(_In_ PNUMBER a, uint32_t radix)
     return (pnumret);
 }
 
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _divmantradix
+//
+//    ARGUMENTS: as _divmantbase.
+//
+//    RETURN: true if the remainder is zero, fills in pq and pr.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pq = pn / pb and
+//    pr = pn % pb in radix, for cn >= cb and a divisor with a nonzero top
+//    digit.  A BASEX digit holds g_ratio digits of radix, so long division
+//    in radix does about g_ratio^2 times the work of the same division in
+//    BASEX.  Both numbers are converted into BASEX, divided there with
+//    _divmantx, which is Newton division when they are long, and the
+//    quotient is converted back, all of which cost a few multiplications.
+//    The remainder is only converted when pr is given.
+//
+//-----------------------------------------------------------------------------
+
+bool _divmantradix(_Out_ MANTTYPE* pq, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, _In_ const MANTTYPE* pb, int32_t cb, uint32_t radix)
+{
+    PNUMBER n = radixinnum(pn, cn, radix);
+    PNUMBER b = radixinnum(pb, cb, radix);
+
+    // The dividend may have fewer BASEX digits than the divisor, when it is
+    // the smaller of the two the quotient is zero.
+    int32_t cqx = max(n->cdigit - b->cdigit + 1, 1);
+    vector<MANTTYPE> q(cqx, 0);
+    vector<MANTTYPE> r(b->mant, b->mant + b->cdigit);
+    if (n->cdigit >= b->cdigit)
+    {
+        _divmantx(q.data(), r.data(), n->mant, n->cdigit, b->mant, b->cdigit);
+    }
+    else
+    {
+        fill(r.begin(), r.end(), (MANTTYPE)0);
+        copy(n->mant, n->mant + n->cdigit, r.begin());
+    }
+    destroynum(b);
+    destroynum(n);
+
+    PNUMBER qradix = radixconvnum(q.data(), cqx, radix);
+    fill(pq, pq + (cn - cb + 1), (MANTTYPE)0);
+    copy(qradix->mant, qradix->mant + qradix->cdigit, pq);
+    destroynum(qradix);
+
+    if (pr != nullptr)
+    {
+        PNUMBER rradix = radixconvnum(r.data(), static_cast<int32_t>(r.size()), radix);
+        fill(pr, pr + cb, (MANTTYPE)0);
+        copy(rradix->mant, rradix->mant + rradix->cdigit, pr);
+        destroynum(rradix);
+    }
+
+    return all_of(r.begin(), r.end(), [](MANTTYPE digit) { return digit == 0; });
+}
+
 //-----------------------------------------------------------------------------
 //
 //  FUNCTION: StringToRat
@@ -809,33 +1466,22 @@ PRAT Ui32torat(uint32_t inui32)
 //
 //-----------------------------------------------------------------------------
 
-PNUMBER i32tonum(int32_t ini32, uint32_t radix)
+PNUMBER i32tonum(int32_t ini32, uint64_t radix)
 
 {
-    MANTTYPE* pmant;
     PNUMBER pnumret = nullptr;
 
-    createnum(pnumret, MAX_LONG_SIZE);
-    pmant = pnumret->mant;
-    pnumret->cdigit = 0;
-    pnumret->exp = 0;
+    // The magnitude is taken unsigned so INT32_MIN converts too.
     if (ini32 < 0)
     {
+        pnumret = Ui32tonum(0u - static_cast<uint32_t>(ini32), radix);
         pnumret->sign = -1;
-        ini32 *= -1;
     }
     else
     {
-        pnumret->sign = 1;
+        pnumret = Ui32tonum(static_cast<uint32_t>(ini32), radix);
     }
 
-    do
-    {
-        *pmant++ = (MANTTYPE)(ini32 % radix);
-        ini32 /= radix;
-        pnumret->cdigit++;
-    } while (ini32);
-
     return (pnumret);
 }
 
@@ -853,7 +1499,7 @@ PNUMBER i32tonum(int32_t ini32, uint32_t radix)
 //
 //-----------------------------------------------------------------------------
 
-PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix)
+PNUMBER Ui32tonum(uint32_t ini32, uint64_t radix)
 {
     MANTTYPE* pmant;
     PNUMBER pnumret = nullptr;
@@ -867,7 +1513,7 @@ PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix)
     do
     {
         *pmant++ = (MANTTYPE)(ini32 % radix);
-        ini32 /= radix;
+        ini32 = static_cast<uint32_t>(ini32 / radix);
         pnumret->cdigit++;
     } while (ini32);
 
@@ -956,12 +1602,24 @@ uint32_t rattoUi32(_In_ PRAT prat, uint32_t radix, int32_t precision)
 //    DESCRIPTION: returns the 64 bit (irrespective of which processor this is running in) representation of the
 //    number input.  Assumes that the number is in the internal
 //    base. Can throw exception if the number exceeds 2^64
-//    Implementation by getting the HI & LO 32 bit words and concatenating them, as the
-//    internal base chosen happens to be 2^32, this is easier.
+//    Implementation by getting the HI & LO 32 bit words and concatenating them.
 //-----------------------------------------------------------------------------
 
 uint64_t rattoUi64(_In_ PRAT prat, uint32_t radix, int32_t precision)
 {
+    // A nonnegative integer over a one is read straight off its low digits.
+    PNUMBER pnum = prat->pp;
+    PNUMBER pden = prat->pq;
+    if (pden->cdigit == 1 && pden->mant[0] == 1 && pden->exp == 0 && (zernum(pnum) || (pnum->sign * pden->sign > 0 && pnum->exp >= 0)))
+    {
+        uint64_t lret = 0;
+        for (int32_t i = 0; i < pnum->cdigit && i + pnum->exp < 2; i++)
+        {
+            lret |= static_cast<uint64_t>(pnum->mant[i]) << ((i + pnum->exp) * BASEXPWR);
+        }
+        return lret;
+    }
+
     PRAT pint = nullptr;
 
     // first get the LO 32 bit word
@@ -995,9 +1653,10 @@ uint64_t rattoUi64(_In_ PRAT prat, uint32_t radix, int32_t precision)
 //    base   claimed.
 //
 //-----------------------------------------------------------------------------
-int32_t numtoi32(_In_ PNUMBER pnum, uint32_t radix)
+int32_t numtoi32(_In_ PNUMBER pnum, uint64_t radix)
 {
-    int32_t lret = 0;
+    // Accumulate unsigned, only the low 32 bits matter and radix may be BASEX.
+    uint32_t lret = 0;
 
     MANTTYPE* pmant = pnum->mant;
     pmant += pnum->cdigit - 1;
@@ -1005,17 +1664,20 @@ int32_t numtoi32(_In_ PNUMBER pnum, uint32_t radix)
     int32_t expt = pnum->exp;
     for (int32_t length = pnum->cdigit; length > 0 && length + expt > 0; length--)
     {
-        lret *= radix;
+        lret = static_cast<uint32_t>(lret * radix);
         lret += *(pmant--);
     }
 
     while (expt-- > 0)
     {
-        lret *= radix;
+        lret = static_cast<uint32_t>(lret * radix);
+    }
+    if (pnum->sign < 0)
+    {
+        lret = 0u - lret;
     }
-    lret *= pnum->sign;
 
-    return lret;
+    return static_cast<int32_t>(lret);
 }
 
 //-----------------------------------------------------------------------------
@@ -1059,11 +1721,8 @@ bool stripzeroesnum(_Inout_ PNUMBER pnum, int32_t starting)
     // If there are zeros to remove.
     if (fstrip)
     {
-        // Remove them.
-        memmove(pnum->mant, pmant, (int)(cdigits * sizeof(MANTTYPE)));
-        // And adjust exponent and digit count accordingly.
-        pnum->exp += (pnum->cdigit - cdigits);
-        pnum->cdigit = cdigits;
+        // Remove them, adjusting exponent and digit count accordingly.
+        TRIMLOW(pnum, pnum->cdigit - cdigits);
     }
     return (fstrip);
 }
@@ -1303,6 +1962,58 @@ wstring RatToString(_Inout_ PRAT& prat, int format, uint32_t radix, int32_t prec
     return result;
 }
 
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: RatToStringx
+//
+//  ARGUMENTS:  as RatToString.
+//
+//  RETURN: string
+//
+//  DESCRIPTION: returns a string representation of the rational number
+//  passed in, like RatToString, but divides p by q in BASEX first with
+//  RatToNumberx.  RatToString converts all of p and q to radix and divides
+//  there, which costs more than the number needs when p and q are long.
+//  Here the quotient is scaled by a power of radix until its integer part has more
+//  than precision digits, the fraction is dropped, and only that integer is
+//  converted.  The digits can differ from RatToString's where the number
+//  lies within a unit of the truncated quotient of a rounding point.
+//
+//-----------------------------------------------------------------------------
+wstring RatToStringx(_In_ PRAT prat, int format, uint32_t radix, int32_t precision)
+{
+    PNUMBER p = RatToNumberx(prat, (precision + 2) / g_ratio + 2);
+
+    int32_t scaleby = 0;
+    if (!zernum(p))
+    {
+        // p is at least BASEX^clog, and a BASEX digit holds between g_ratio
+        // and g_ratio + 1 digits of radix.
+        int32_t clog = LOGNUM2(p) - 1;
+        scaleby = max<int32_t>(precision + 2 - clog * (clog < 0 ? g_ratio + 1 : g_ratio), 0);
+        if (scaleby > 0)
+        {
+            PNUMBER pow = i32tonum(radix, BASEX);
+            numpowi32x(&pow, scaleby);
+            mulnumx(&p, pow);
+            destroynum(pow);
+        }
+        if (p->exp < 0)
+        {
+            TRIMLOW(p, -p->exp);
+        }
+    }
+
+    PNUMBER pnum = nRadixxtonum(p, radix, precision);
+    destroynum(p);
+    pnum->exp -= scaleby;
+
+    wstring result = NumberToString(pnum, format, radix, precision);
+    destroynum(pnum);
+
+    return result;
+}
+
 PNUMBER RatToNumber(_In_ PRAT prat, uint32_t radix, int32_t precision)
 {
     PRAT temprat = nullptr;
@@ -1320,13 +2031,53 @@ PNUMBER RatToNumber(_In_ PRAT prat, uint32_t radix, int32_t precision)
 
     destroyrat(temprat);
 
-    // finally take the time hit to actually divide.
+    // finally divide, in BASEX once p and q are long, see _divnumtrunc.
+    // Dividing in BASEX before converting would save converting p and q,
+    // but NumberToString strips zeros and rounds on exactly the digits this
+    // division leaves, so the quotient has to keep them.
     divnum(&p, q, radix, precision);
     destroynum(q);
 
     return p;
 }
 
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: RatToNumberx
+//
+//  ARGUMENTS:  rational number in internal base and the number of BASEX
+//              digits wanted.
+//
+//  RETURN: number in internal base.
+//
+//  DESCRIPTION: returns p / q to about cdigit digits.  Dividing all of p by
+//  all of q costs as much as their length whatever the precision asked for,
+//  so only cdigit + 1 leading digits of each are divided, which leaves a
+//  relative error of about two units in the last digit.
+//
+//-----------------------------------------------------------------------------
+
+PNUMBER RatToNumberx(_In_ PRAT prat, int32_t cdigit)
+{
+    PNUMBER p = nullptr;
+    PNUMBER q = nullptr;
+    DUPNUM(p, prat->pp);
+    DUPNUM(q, prat->pq);
+    if (p->cdigit > cdigit + 1)
+    {
+        TRIMLOW(p, p->cdigit - cdigit - 1);
+    }
+    if (q->cdigit > cdigit + 1)
+    {
+        TRIMLOW(q, q->cdigit - cdigit - 1);
+    }
+
+    divnum(&p, q, BASEX, cdigit);
+    destroynum(q);
+
+    return p;
+}
+
 // Converts a PRAT to a PNUMBER and back to a PRAT, flattening/simplifying the rational in the process
 void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision)
 {
@@ -1348,9 +2099,13 @@ void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision)
 //
 //  RETURN: Greatest common divisor in internal BASEX PNUMBER form.
 //
-//  DESCRIPTION: gcd uses remainders to find the greatest common divisor.
+//  DESCRIPTION: gcd uses _gcdmantx to find the greatest common divisor,
+//  see basex.cpp for the algorithms.  The result is always a new positive
+//  number the caller owns.
 //
-//  ASSUMPTIONS: gcd assumes inputs are integers.
+//  ASSUMPTIONS: gcd assumes inputs are integers.  Inputs that are not are
+//  still handled exactly as Euclid would, by working in units of the
+//  smaller of the two exponents.
 //
 //  NOTE: Before it was found that the TRIM macro actually kept the
 //        size down cheaper than GCD, this routine was used extensively.
@@ -1361,107 +2116,269 @@ void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision)
 PNUMBER gcd(_In_ PNUMBER a, _In_ PNUMBER b)
 {
     PNUMBER r = nullptr;
-    PNUMBER larger = nullptr;
-    PNUMBER smaller = nullptr;
 
-    if (zernum(a))
+    if (zernum(a) || zernum(b))
     {
-        return b;
+        DUPNUM(r, zernum(a) ? b : a);
+        r->sign = 1;
+        return r;
     }
-    else if (zernum(b))
+
+    // gcd(A*BASEX^ea, B*BASEX^eb) is gcd(A*BASEX^(ea-e), B*BASEX^(eb-e))*BASEX^e
+    // where e is the smaller exponent.
+    const int32_t exp = min(a->exp, b->exp);
+    const int32_t ca = a->cdigit + a->exp - exp;
+    const int32_t cb = b->cdigit + b->exp - exp;
+    vector<MANTTYPE> mantb(cb, 0);
+    copy(b->mant, b->mant + b->cdigit, mantb.begin() + (b->exp - exp));
+
+    createnum(r, ca);
+    memset(r->mant, 0, ca * sizeof(MANTTYPE));
+    memcpy(r->mant + (a->exp - exp), a->mant, a->cdigit * sizeof(MANTTYPE));
+    r->cdigit = _gcdmantx(r->mant, ca, mantb.data(), cb);
+    r->exp = exp;
+    r->sign = 1;
+    return r;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  Integer products
+//
+//     A run of consecutive integers is multiplied as a balanced tree, so the
+//  fast multiply always sees halves of about equal size, and the leaves pack
+//  as many integers as fit into 64 bits.
+//
+//     Factorials use the split recursive method.  With n!! the product of
+//  the odd numbers up to n,
+//
+//     n! = n!! * 2^(n/2) * (n/2)!
+//
+//  so the odd part of n! is the product of (n >> i)!! over all i, and each
+//  of those extends the one before it by a product of odd numbers.  The
+//  power of two, n minus the number of one bits of n, is a shift.
+//
+//-----------------------------------------------------------------------------
+
+namespace
+{
+    PNUMBER ui64tonumx(uint64_t value)
     {
-        return a;
+        PNUMBER pnum = nullptr;
+        createnum(pnum, 2);
+        pnum->sign = 1;
+        pnum->exp = 0;
+        pnum->mant[0] = (MANTTYPE)value;
+        pnum->mant[1] = (MANTTYPE)(value >> BASEXPWR);
+        pnum->cdigit = pnum->mant[1] ? 2 : 1;
+        return pnum;
     }
 
-    if (lessnum(a, b))
+    int32_t bitwidth(uint64_t value)
     {
-        DUPNUM(larger, b);
-        DUPNUM(smaller, a);
+        int32_t cbits = 0;
+        while (value)
+        {
+            value >>= 1;
+            cbits++;
+        }
+        return cbits;
     }
-    else
+
+    // Product of first, first + step, ... count integers in all, count > 0.
+    PNUMBER prodnumx(uint64_t first, uint64_t count, uint64_t step)
     {
-        DUPNUM(larger, a);
-        DUPNUM(smaller, b);
+        uint64_t last = first + (count - 1) * step;
+        if (count * bitwidth(last) <= 64)
+        {
+            uint64_t prod = 1;
+            for (uint64_t i = first; i <= last; i += step)
+            {
+                prod *= i;
+            }
+            return ui64tonumx(prod);
+        }
+
+        uint64_t half = count / 2;
+        PNUMBER prod = prodnumx(first, half, step);
+        PNUMBER high = prodnumx(first + half * step, count - half, step);
+        mulnumx(&prod, high);
+        destroynum(high);
+        return prod;
     }
 
-    while (!zernum(smaller))
+    // Folds the exponent of an integer into its mantissa.
+    void unexpnum(_Inout_ PNUMBER* pnum)
     {
-        remnum(&larger, smaller, BASEX);
-        // swap larger and smaller
-        r = larger;
-        larger = smaller;
-        smaller = r;
+        PNUMBER a = *pnum;
+        if (a->exp > 0)
+        {
+            PNUMBER b = nullptr;
+            createnum(b, a->cdigit + a->exp);
+            memset(b->mant, 0, a->exp * sizeof(MANTTYPE));
+            memcpy(b->mant + a->exp, a->mant, a->cdigit * sizeof(MANTTYPE));
+            b->cdigit = a->cdigit + a->exp;
+            b->sign = a->sign;
+            b->exp = 0;
+            destroynum(*pnum);
+            *pnum = b;
+        }
+    }
+
+    // Converts an integer in internal base to radix, all of its digits.
+    PNUMBER inttonum(_Inout_ PNUMBER* pnum, uint32_t radix)
+    {
+        if (radix == BASEX)
+        {
+            PNUMBER ret = *pnum;
+            *pnum = nullptr;
+            return ret;
+        }
+        unexpnum(pnum);
+        PNUMBER ret = nRadixxtonum(*pnum, radix, (*pnum)->cdigit);
+        destroynum(*pnum);
+        return ret;
     }
-    destroynum(smaller);
-    return larger;
 }
 
 //-----------------------------------------------------------------------------
 //
-//  FUNCTION: i32factnum
+//  FUNCTION: i32factnumx
 //
 //  ARGUMENTS:
-//              int32_t integer to factorialize.
-//              int32_t integer representing base   of answer.
-//              uint32_t integer for radix
+//              int32_t integer to factorialize, at least 0.
 //
-//  RETURN: Factorial of input in radix PNUMBER form.
-//
-//  NOTE:  Not currently used.
+//  RETURN: Factorial of input in internal base PNUMBER form.
 //
 //-----------------------------------------------------------------------------
 
-PNUMBER i32factnum(int32_t ini32, uint32_t radix)
+PNUMBER i32factnumx(int32_t ini32)
 
 {
-    PNUMBER lret = nullptr;
-    PNUMBER tmp = nullptr;
+    uint64_t n = static_cast<uint64_t>(ini32);
+    PNUMBER odd = ui64tonumx(1);
+    PNUMBER lret = ui64tonumx(1);
 
-    lret = i32tonum(1, radix);
+    // odd holds m!! for the largest m reached so far.
+    uint64_t m = 1;
+    for (int32_t shift = bitwidth(n) - 1; shift >= 0; shift--)
+    {
+        uint64_t top = n >> shift;
+        if (top >= m + 2)
+        {
+            uint64_t first = m + 2;
+            PNUMBER tmp = prodnumx(first, (top - first) / 2 + 1, 2);
+            mulnumx(&odd, tmp);
+            destroynum(tmp);
+            m = first + ((top - first) / 2) * 2;
+        }
+        mulnumx(&lret, odd);
+    }
+    destroynum(odd);
 
-    while (ini32 > 0)
+    // Shift in the power of two, whole BASEX digits go into the exponent.
+    uint64_t twos = n;
+    for (uint64_t bits = n; bits; bits &= bits - 1)
     {
-        tmp = i32tonum(ini32--, radix);
-        mulnum(&lret, tmp, radix);
-        destroynum(tmp);
+        twos--;
     }
+    lret->exp += static_cast<int32_t>(twos / BASEXPWR);
+    PNUMBER tmp = ui64tonumx(1ULL << (twos % BASEXPWR));
+    mulnumx(&lret, tmp);
+    destroynum(tmp);
     return (lret);
 }
 
 //-----------------------------------------------------------------------------
 //
-//  FUNCTION: i32prodnum
+//  FUNCTION: i32prodnumx
 //
 //  ARGUMENTS:
-//              int32_t integer to factorialize.
-//              int32_t integer representing base of answer.
-//              uint32_t integer for radix
+//              int32_t first integer of the product.
+//              int32_t last integer of the product.
 //
-//  RETURN: Factorial of input in base PNUMBER form.
+//  RETURN: Product of the nonzero integers from start to stop in internal
+//          base PNUMBER form, one if there are none.
 //
 //-----------------------------------------------------------------------------
 
-PNUMBER i32prodnum(int32_t start, int32_t stop, uint32_t radix)
+PNUMBER i32prodnumx(int32_t start, int32_t stop)
 
 {
-    PNUMBER lret = nullptr;
-    PNUMBER tmp = nullptr;
-
-    lret = i32tonum(1, radix);
+    if (start > stop)
+    {
+        return ui64tonumx(1);
+    }
 
-    while (start <= stop)
+    // Zero is skipped, so a run through it is the product of two runs up
+    // from one.
+    int64_t first = start;
+    int64_t last = stop;
+    PNUMBER lret = nullptr;
+    if (first <= 0 && last >= 0)
     {
-        if (start)
+        lret = last > 0 ? prodnumx(1, last, 1) : ui64tonumx(1);
+        if (first < 0)
         {
-            tmp = i32tonum(start, radix);
-            mulnum(&lret, tmp, radix);
+            PNUMBER tmp = prodnumx(1, -first, 1);
+            mulnumx(&lret, tmp);
             destroynum(tmp);
         }
-        start++;
+    }
+    else
+    {
+        uint64_t low = static_cast<uint64_t>(first > 0 ? first : -last);
+        uint64_t high = static_cast<uint64_t>(first > 0 ? last : -first);
+        lret = prodnumx(low, high - low + 1, 1);
+    }
+
+    if (first < 0 && (min<int64_t>(last, -1) - first + 1) % 2)
+    {
+        lret->sign = -1;
     }
     return (lret);
 }
 
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: i32factnum
+//
+//  ARGUMENTS:
+//              int32_t integer to factorialize.
+//              uint32_t integer for radix
+//
+//  RETURN: Factorial of input in radix PNUMBER form.
+//
+//-----------------------------------------------------------------------------
+
+PNUMBER i32factnum(int32_t ini32, uint32_t radix)
+
+{
+    PNUMBER lret = i32factnumx(max(ini32, 0));
+    return (inttonum(&lret, radix));
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: i32prodnum
+//
+//  ARGUMENTS:
+//              int32_t first integer of the product.
+//              int32_t last integer of the product.
+//              uint32_t integer for radix
+//
+//  RETURN: Product of the nonzero integers from start to stop in radix
+//          PNUMBER form.
+//
+//-----------------------------------------------------------------------------
+
+PNUMBER i32prodnum(int32_t start, int32_t stop, uint32_t radix)
+
+{
+    PNUMBER lret = i32prodnumx(start, stop);
+    return (inttonum(&lret, radix));
+}
+
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: numpowi32
@@ -1473,22 +2390,67 @@ PNUMBER i32prodnum(int32_t start, int32_t stop, uint32_t radix)
 //
 //    DESCRIPTION: changes numeric representation of root to
 //    root ** power. Assumes radix is the radix of root.
+//    Sliding windows over the power, see _powwindows, BASEX roots go to
+//    numpowi32x.
 //
 //-----------------------------------------------------------------------------
 
-void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t precision)
+void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint64_t radix, int32_t precision)
 {
-    PNUMBER lret = i32tonum(1, radix);
+    if (radix == BASEX)
+    {
+        numpowi32x(proot, power);
+        return;
+    }
 
-    while (power > 0)
+    PNUMBER lret = nullptr;
+    if (power <= 0)
+    {
+        lret = i32tonum(1, radix);
+    }
+    else
     {
-        if (power & 1)
+        POWWINDOW windows[MAX_POW_WINDOWS];
+        int32_t window;
+        int32_t cwindows = _powwindows(power, windows, &window);
+
+        // table[i] = root^(2i + 1)
+        vector<PNUMBER> table(1 << (window - 1), nullptr);
+        DUPNUM(table[0], *proot);
+        if (table.size() > 1)
         {
-            mulnum(&lret, *proot, radix);
+            PNUMBER square = nullptr;
+            DUPNUM(square, *proot);
+            mulnum(&square, *proot, radix);
+            TRIMNUM(square, precision);
+            for (size_t i = 1; i < table.size(); i++)
+            {
+                DUPNUM(table[i], table[i - 1]);
+                mulnum(&table[i], square, radix);
+                TRIMNUM(table[i], precision);
+            }
+            destroynum(square);
+        }
+
+        DUPNUM(lret, table[windows[0].odd >> 1]);
+        for (int32_t i = 1; i < cwindows; i++)
+        {
+            for (int32_t j = 0; j < windows[i].csquare; j++)
+            {
+                mulnum(&lret, lret, radix);
+                TRIMNUM(lret, precision);
+            }
+            if (windows[i].odd != 0)
+            {
+                mulnum(&lret, table[windows[i].odd >> 1], radix);
+                TRIMNUM(lret, precision);
+            }
+        }
+
+        for (PNUMBER entry : table)
+        {
+            destroynum(entry);
         }
-        mulnum(proot, *proot, radix);
-        TRIMNUM(*proot, precision);
-        power >>= 1;
     }
     destroynum(*proot);
     *proot = lret;
@@ -1504,6 +2466,11 @@ void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t pr
 //
 //    DESCRIPTION: changes rational representation of root to
 //    root ** power.
+//    trimit keeps all of a rational while the shorter of its numerator and
+//    denominator fits the precision.  When that holds for the result, as it
+//    always does for integers, numerator and denominator are raised exactly
+//    and on their own by numpowi32x.  Otherwise sliding windows over the
+//    power multiply rationals trimmed to the precision.
 //
 //-----------------------------------------------------------------------------
 
@@ -1519,23 +2486,54 @@ void ratpowi32(_Inout_ PRAT* proot, int32_t power, int32_t precision)
         (*proot)->pp = (*proot)->pq;
         (*proot)->pq = pnumtemp;
     }
+    else if (power == 0)
+    {
+        DUPRAT(*proot, rat_one);
+    }
+    else if (g_ftrueinfinite || min(_log2num((*proot)->pp), _log2num((*proot)->pq)) * power <= (precision / g_ratio + 1.0) * BASEXPWR)
+    {
+        numpowi32x(&((*proot)->pp), power);
+        numpowi32x(&((*proot)->pq), power);
+    }
     else
     {
-        PRAT lret = nullptr;
-
-        lret = i32torat(1);
+        POWWINDOW windows[MAX_POW_WINDOWS];
+        int32_t window;
+        int32_t cwindows = _powwindows(power, windows, &window);
+
+        // table[i] = root^(2i + 1)
+        vector<PRAT> table(1 << (window - 1), nullptr);
+        DUPRAT(table[0], *proot);
+        if (table.size() > 1)
+        {
+            PRAT square = nullptr;
+            DUPRAT(square, *proot);
+            mulrat(&square, *proot, precision);
+            for (size_t i = 1; i < table.size(); i++)
+            {
+                DUPRAT(table[i], table[i - 1]);
+                mulrat(&table[i], square, precision);
+            }
+            destroyrat(square);
+        }
 
-        while (power > 0)
+        PRAT lret = nullptr;
+        DUPRAT(lret, table[windows[0].odd >> 1]);
+        for (int32_t i = 1; i < cwindows; i++)
         {
-            if (power & 1)
+            for (int32_t j = 0; j < windows[i].csquare; j++)
+            {
+                mulrat(&lret, lret, precision);
+            }
+            if (windows[i].odd != 0)
             {
-                mulnumx(&(lret->pp), (*proot)->pp);
-                mulnumx(&(lret->pq), (*proot)->pq);
+                mulrat(&lret, table[windows[i].odd >> 1], precision);
             }
-            mulrat(proot, *proot, precision);
-            trimit(&lret, precision);
-            trimit(proot, precision);
-            power >>= 1;
+        }
+
+        for (PRAT entry : table)
+        {
+            destroyrat(entry);
         }
         destroyrat(*proot);
         *proot = lret;
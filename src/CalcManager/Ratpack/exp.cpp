@@ -37,11 +37,30 @@
 //   thisterm  = X ;  and stop when thisterm < precision used.
 //           0                              n
 //
+//   At high precision X is first divided by 2^k, k picked by _reducesteps,
+//   and the sum squared k times.
+//
 //-----------------------------------------------------------------------------
 
 void _exprat(_Inout_ PRAT* px, int32_t precision)
 
 {
+    if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_EXP, precision);
+        return;
+    }
+
+    // exp(x) = exp(x/2^k)^(2^k), at high precision the series is summed
+    // for x/2^k and squared back up k times, each squaring costs a bit.
+    int32_t steps = _reducesteps(*px, 2, precision);
+    int32_t outprecision = precision;
+    if (steps > 0)
+    {
+        _reducerat(px, 2, steps);
+        precision += _reduceguard(steps);
+    }
+
     CREATETAYLOR();
 
     addnum(&(pret->pp), num_one, BASEX);
@@ -56,6 +75,15 @@ void _exprat(_Inout_ PRAT* px, int32_t precision)
     } while (!SMALL_ENOUGH_RAT(thisterm, precision));
 
     DESTROYTAYLOR();
+
+    if (steps > 0)
+    {
+        for (int32_t i = 0; i < steps; i++)
+        {
+            mulrat(px, *px, precision);
+        }
+        trimit(px, outprecision);
+    }
 }
 
 void exprat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
@@ -150,6 +178,90 @@ void _lograt(PRAT* px, int32_t precision)
     DESTROYTAYLOR();
 }
 
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _logagmrat
+//
+//  ARGUMENTS: x PRAT representation of number to logarithim, x >= 1
+//
+//  RETURN: log  of x in PRAT form.
+//
+//  EXPLANATION: This uses the arithmetic-geometric mean
+//
+//                     pi
+//   log(s) = ------------------ + O(1/s^2)
+//             2 * AGM(1, 4 / s)
+//
+//   with s = x * BASEX^k large enough for the error term to be below
+//   precision, and log(x) = log(s) - k * BASEXPWR * ln(2).  The AGM
+//   converges quadratically, so this takes O(log(precision)) square roots
+//   and multiplications instead of O(precision) series terms.
+//
+//   The cached pi and ln_two carry one BASEX digit beyond precision, which
+//   covers the bits lost multiplying ln_two by k * BASEXPWR.
+//
+//-----------------------------------------------------------------------------
+
+// Precision, in BASEX digits, at which lograt uses the arithmetic-geometric
+// mean instead of the Taylor series.
+int32_t g_logAgmThreshold = LOG_AGM_THRESHOLD;
+
+void _logagmrat(_Inout_ PRAT* px, int32_t precision)
+
+{
+    int32_t wprecision = precision + g_ratio;
+    int32_t wbits = (wprecision / g_ratio) * BASEXPWR;
+    int32_t k = wprecision / g_ratio / 2 + 2;
+
+    // a = 1, b = 4 / s
+    PRAT a = nullptr;
+    PRAT b = nullptr;
+    PRAT ab = nullptr;
+    PRAT diff = nullptr;
+    DUPRAT(a, rat_one);
+    createrat(b);
+    DUPNUM(b->pp, (*px)->pq);
+    DUPNUM(b->pq, (*px)->pp);
+    b->pq->exp += k;
+    mulrat(&b, rat_two, wprecision);
+    mulrat(&b, rat_two, wprecision);
+
+    while (true)
+    {
+        // Once a and b agree to half the bits one more arithmetic mean gets
+        // all of them.
+        DUPRAT(diff, a);
+        subrat(&diff, b, wprecision);
+        if (zerrat(diff) || _log2num(diff->pp) - _log2num(diff->pq) - _log2num(a->pp) + _log2num(a->pq) < -wbits / 2)
+        {
+            break;
+        }
+
+        DUPRAT(ab, a);
+        mulrat(&ab, b, wprecision);
+        sqrtrat(&ab, wprecision);
+        addrat(&a, b, wprecision);
+        divrat(&a, rat_two, wprecision);
+        DUPRAT(b, ab);
+    }
+    addrat(&a, b, wprecision);
+
+    // a now holds twice the AGM, log(x) = pi / a - k * BASEXPWR * ln(2).
+    DUPRAT(*px, pi);
+    divrat(px, a, wprecision);
+
+    PRAT pwr = i32torat(k * BASEXPWR);
+    mulrat(&pwr, ln_two, wprecision);
+    subrat(px, pwr, wprecision);
+    trimit(px, precision);
+
+    destroyrat(pwr);
+    destroyrat(diff);
+    destroyrat(ab);
+    destroyrat(b);
+    destroyrat(a);
+}
+
 void lograt(_Inout_ PRAT* px, int32_t precision)
 
 {
@@ -163,6 +275,12 @@ void lograt(_Inout_ PRAT* px, int32_t precision)
         throw(CALC_E_DOMAIN);
     }
 
+    if (rat_equ(*px, rat_one, precision))
+    {
+        DUPRAT(*px, rat_zero);
+        return;
+    }
+
     // Get number > 1, for scaling
     fneglog = rat_lt(*px, rat_one, precision);
     if (fneglog)
@@ -194,15 +312,35 @@ void lograt(_Inout_ PRAT* px, int32_t precision)
         DUPRAT(pwr, rat_zero);
     }
 
+    // The AGM is accurate to the cached constants in absolute terms, so close
+    // to one, where the log is small, the series on x - 1 takes over.  It
+    // needs few terms there.
+    bool fagm = precision / g_ratio >= g_logAgmThreshold;
+    if (fagm)
+    {
+        PRAT xm1 = nullptr;
+        DUPRAT(xm1, *px);
+        subrat(&xm1, rat_one, precision);
+        fagm = LOGRAT2(xm1) > -LOG_NEAR_ONE_DIGITS;
+        destroyrat(xm1);
+    }
+
     DUPRAT(offset, rat_zero);
-    // Scale the number between 1 and e_to_one_half, for the small scale.
-    while (rat_gt(*px, e_to_one_half, precision))
+    if (fagm)
     {
-        divrat(px, e_to_one_half, precision);
-        addrat(&offset, rat_one, precision);
+        _logagmrat(px, precision);
     }
+    else
+    {
+        // Scale the number between 1 and e_to_one_half, for the small scale.
+        while (rat_gt(*px, e_to_one_half, precision))
+        {
+            divrat(px, e_to_one_half, precision);
+            addrat(&offset, rat_one, precision);
+        }
 
-    _lograt(px, precision);
+        _lograt(px, precision);
+    }
 
     // Add the large and small scaling factors, take into account
     // small scaling was done in e_to_one_half chunks.
@@ -308,9 +446,10 @@ void powratNumeratorDenominator(_Inout_ PRAT* px, _In_ PRAT y, uint32_t radix, i
     // px ^ (yNum/yDenom) == px ^ yNum ^ (1/yDenom)
     // 1. For px ^ yNum, we call powratcomp directly which will call ratpowi32
     //    and store the result in pxPowNum
-    // 2. For pxPowNum ^ (1/yDenom), we call powratcomp
-    // 3. Validate the result of 2 by adding/subtracting 0.5, flooring and call powratcomp with yDenom
-    //    on the floored result.
+    // 2. For pxPowNum ^ (1/yDenom), we call ratrooti32 when yDenom fits an int32_t, otherwise
+    //    we call powratcomp
+    // 3. Validate the result of powratcomp by adding/subtracting 0.5, flooring and call powratcomp
+    //    with yDenom on the floored result.
 
     // 1. Initialize result.
     PRAT pxPow = nullptr;
@@ -325,7 +464,13 @@ void powratNumeratorDenominator(_Inout_ PRAT* px, _In_ PRAT y, uint32_t radix, i
 
     // 2. Calculate pxPowNumDenom = pxPowNum ^ (1/yDenominator),
     // if yDenominator is not 1
-    if (!rat_equ(yDenominator, rat_one, precision))
+    if (rat_gt(yDenominator, rat_one, precision) && rat_le(yDenominator, rat_max_i32, precision))
+    {
+        // ratrooti32 finds perfect powers exactly, there is nothing to round.
+        ratrooti32(&pxPow, rattoi32(yDenominator, radix, precision), precision);
+        DUPRAT(*px, pxPow);
+    }
+    else if (!rat_equ(yDenominator, rat_one, precision))
     {
         // Calculate 1 over y
         PRAT oneoveryDenom = nullptr;
@@ -14,10 +14,152 @@
 //
 //-----------------------------------------------------------------------------
 #include "ratpak.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
 
 #define ABSRAT(x) (((x)->pp->sign = 1), ((x)->pq->sign = 1))
 #define NEGATE(x) ((x)->pp->sign *= -1)
 
+namespace
+{
+    // Keeps the cdigit most significant digits of a, the rest go into its
+    // exponent.
+    void truncnum(PNUMBER a, int32_t cdigit)
+    {
+        if (a->cdigit > cdigit)
+        {
+            TRIMLOW(a, a->cdigit - cdigit);
+        }
+    }
+
+    // Computes P/Q, the product of (p - kq)/q over k in [k1, k2), by a
+    // balanced tree whose partial products are kept to cdigit digits.
+    void fallingsplit(PNUMBER p, PNUMBER q, uint32_t k1, uint32_t k2, int32_t cdigit, PNUMBER* pP, PNUMBER* pQ)
+    {
+        if (k2 - k1 == 1)
+        {
+            PNUMBER kq = Ui32tonum(k1, BASEX);
+            mulnumx(&kq, q);
+            kq->sign = -1;
+            *pP = nullptr;
+            DUPNUM(*pP, p);
+            addnum(pP, kq, BASEX);
+            destroynum(kq);
+            *pQ = nullptr;
+            DUPNUM(*pQ, q);
+            return;
+        }
+
+        uint32_t km = k1 + (k2 - k1) / 2;
+        PNUMBER Pr = nullptr;
+        PNUMBER Qr = nullptr;
+        fallingsplit(p, q, k1, km, cdigit, pP, pQ);
+        fallingsplit(p, q, km, k2, cdigit, &Pr, &Qr);
+        mulnumx(pP, Pr);
+        mulnumx(pQ, Qr);
+        truncnum(*pP, cdigit);
+        truncnum(*pQ, cdigit);
+        destroynum(Pr);
+        destroynum(Qr);
+    }
+
+    // Spouge's coefficients for one radix and precision.
+    typedef struct _spougecoeffs
+    {
+        int32_t a;          // Terms, the relative error is below (2 pi)^-a
+        int32_t wprecision; // Precision the coefficients and the sum are taken to
+        vector<PRAT> c;     // c[0] = sqrt(2 pi) and c[k] for 0 < k < a
+    } SPOUGECOEFFS;
+
+    constexpr double LN_TWO_PI = 1.8378770664093454836;
+
+    mutex s_spougelock;
+    map<pair<uint32_t, int32_t>, unique_ptr<SPOUGECOEFFS>> s_spouge;
+
+    void buildspouge(SPOUGECOEFFS* ps, uint32_t radix, int32_t precision)
+    {
+        // The terms alternate, the sum loses as many digits as its largest
+        // term has.
+        double lnradix = log(static_cast<double>(radix));
+        int32_t a = static_cast<int32_t>(ceil(precision * lnradix / LN_TWO_PI)) + 1;
+        double lnmax = 0;
+        for (int32_t k = 1; k < a; k++)
+        {
+            lnmax = max(lnmax, (k - 0.5) * log(static_cast<double>(a - k)) + (a - k) - lgamma(static_cast<double>(k)));
+        }
+        int32_t wprecision = precision + static_cast<int32_t>(ceil(lnmax / lnradix)) + g_ratio;
+        ps->a = a;
+        ps->wprecision = wprecision;
+
+        const RATCONSTANTS* pc = getconstants(radix, wprecision);
+        PRAT c0 = nullptr;
+        DUPRAT(c0, pc->two_pi);
+        sqrtrat(&c0, wprecision);
+        ps->c.assign(a, nullptr);
+        ps->c[0] = c0;
+
+        // c[k] = (-1)^(k-1) (a-k)^(k-1/2) e^(a-k) / (k-1)!, from k = a-1 down
+        // so the powers of e build up one multiply at a time.
+        PRAT e = nullptr;
+        DUPRAT(e, pc->rat_exp);
+        PRAT etothe = nullptr;
+        DUPRAT(etothe, rat_one);
+        PRAT fact = nullptr;
+        for (int32_t k = a - 1; k > 0; k--)
+        {
+            mulrat(&etothe, e, wprecision);
+
+            PRAT ck = i32torat(a - k);
+            ratpowi32(&ck, 2 * k - 1, wprecision);
+            sqrtrat(&ck, wprecision);
+            mulrat(&ck, etothe, wprecision);
+            destroyrat(fact);
+            createrat(fact);
+            fact->pp = i32factnumx(k - 1);
+            DUPNUM(fact->pq, num_one);
+            divrat(&ck, fact, wprecision);
+            if ((k & 1) == 0)
+            {
+                ck->pp->sign *= -1;
+            }
+            ps->c[k] = ck;
+        }
+        destroyrat(fact);
+        destroyrat(etothe);
+        destroyrat(e);
+    }
+
+    const SPOUGECOEFFS* getspouge(uint32_t radix, int32_t precision)
+    {
+        lock_guard<mutex> lock(s_spougelock);
+        unique_ptr<SPOUGECOEFFS>& entry = s_spouge[{ radix, precision }];
+        if (entry == nullptr)
+        {
+            auto ps = make_unique<SPOUGECOEFFS>();
+            try
+            {
+                buildspouge(ps.get(), radix, precision);
+            }
+            catch (...)
+            {
+                for (PRAT ck : ps->c)
+                {
+                    destroyrat(ck);
+                }
+                s_spouge.erase({ radix, precision });
+                throw;
+            }
+            entry = move(ps);
+        }
+        return entry.get();
+    }
+}
+
 //-----------------------------------------------------------------------------
 //
 //  FUNCTION: factrat, _gamma, gamma
@@ -51,10 +193,16 @@
 //  A = ln(Base         /n)+1
 //  A += n*ln(A)  This is close enough for precision > base and n < 1.5
 //
+//  factrat skips the series for integers, and numbers within precision of
+//  one, with the exact product tree factorial from i32factnumx.  For other
+//  positive x the product x (x - 1) ... down to the fractional part of x
+//  is a balanced tree too, kept to precision, and _gammaspouge does the
+//  rest.  Below -1 x reflects onto a positive argument.  The series above
+//  is kept as the reference _gammaspouge is checked against.
 //
 //-----------------------------------------------------------------------------
 
-void _gamma(PRAT* pn, uint32_t radix, int32_t precision)
+void _gamma(_Inout_ PRAT* pn, uint32_t radix, int32_t precision)
 
 {
     PRAT factorial = nullptr;
@@ -181,6 +329,8 @@ void _gamma(PRAT* pn, uint32_t radix, int32_t precision)
     destroyrat(a2);
     destroyrat(tmp);
     destroyrat(one_pt_five);
+    destroyrat(mpy);
+    destroyrat(ratRadix);
 
     destroynum(count);
 
@@ -190,6 +340,75 @@ void _gamma(PRAT* pn, uint32_t radix, int32_t precision)
     destroyrat(sum);
 }
 
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _gammaspouge
+//
+//  ARGUMENTS:  x PRAT representation of a number greater than zero.
+//
+//  RETURN: gamma of x in PRAT form.
+//
+//  EXPLANATION: Spouge's approximation, with z = x - 1
+//
+//                  z+1/2  -(z+a)                  a-1    c
+//     G(z+1) = (z+a)     e       [ sqrt(2 pi) +   \   ----- ]
+//                                                 /__   z+k
+//                                                 k=1
+//
+//                 k-1         k-1/2  a-k
+//     c  =  (-1)     (a - k)      e     / (k-1)!
+//      k
+//
+//  has a relative error below (2 pi)^-a, so a follows from the precision
+//  alone.  The coefficients are built once per radix and precision and
+//  kept, a call is a log, an exp and a divisions.
+//
+//-----------------------------------------------------------------------------
+
+void _gammaspouge(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
+
+{
+    const SPOUGECOEFFS* ps = getspouge(radix, precision);
+    int32_t wprecision = ps->wprecision;
+
+    // sum = sqrt(2 pi) + c[1]/x + c[2]/(x+1) + ...
+    PRAT sum = nullptr;
+    PRAT term = nullptr;
+    PRAT zk = nullptr;
+    DUPRAT(sum, ps->c[0]);
+    DUPRAT(zk, *px);
+    for (int32_t k = 1; k < ps->a; k++)
+    {
+        DUPRAT(term, ps->c[k]);
+        divrat(&term, zk, wprecision);
+        addrat(&sum, term, wprecision);
+        addrat(&zk, rat_one, wprecision);
+    }
+
+    // (z+a)^(z+1/2) e^-(z+a) = exp((x-1/2) log(x+a-1) - (x+a-1))
+    PRAT t = nullptr;
+    DUPRAT(t, *px);
+    PRAT ratashift = i32torat(ps->a - 1);
+    addrat(&t, ratashift, precision + g_ratio);
+    PRAT ln = nullptr;
+    DUPRAT(ln, t);
+    lograt(&ln, precision + g_ratio);
+    subrat(px, rat_half, precision + g_ratio);
+    mulrat(&ln, *px, precision + g_ratio);
+    subrat(&ln, t, precision + g_ratio);
+    exprat(&ln, radix, precision + g_ratio);
+
+    mulrat(&sum, ln, precision);
+    DUPRAT(*px, sum);
+
+    destroyrat(ln);
+    destroyrat(ratashift);
+    destroyrat(t);
+    destroyrat(zk);
+    destroyrat(term);
+    destroyrat(sum);
+}
+
 void factrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 
 {
@@ -211,15 +430,51 @@ void factrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
     DUPRAT(frac, *px);
     fracrat(&frac, radix, precision);
 
-    // Check for negative integers and throw an error.
-    if ((zerrat(frac) || (LOGRATRADIX(frac) <= -precision)) && (SIGN(*px) == -1))
+    if (zerrat(frac) || (LOGRATRADIX(frac) <= -precision))
     {
-        throw CALC_E_DOMAIN;
+        // Check for negative integers and throw an error.
+        if (SIGN(*px) == -1)
+        {
+            throw CALC_E_DOMAIN;
+        }
+
+        // Integers, and numbers close enough to them, get the exact integer
+        // factorial from a product tree.
+        int32_t n = rattoi32(*px, radix, precision);
+        destroyrat(*px);
+        createrat(*px);
+        (*px)->pp = i32factnumx(n);
+        DUPNUM((*px)->pq, num_one);
+
+        destroyrat(fact);
+        destroyrat(frac);
+        destroyrat(neg_rat_one);
+        return;
     }
-    while (rat_gt(*px, rat_zero, precision) && (LOGRATRADIX(*px) > -precision))
+    if (rat_gt(*px, rat_zero, precision))
     {
-        mulrat(&fact, *px, precision);
-        subrat(px, rat_one, precision);
+        // fact = x (x - 1) ... (x - n + 1) down to the fractional part of x,
+        // kept to precision with a couple of guard digits for the roundings.
+        PRAT count = nullptr;
+        DUPRAT(count, *px);
+        intrat(&count, radix, precision);
+        addrat(&count, rat_one, precision);
+        uint32_t n = static_cast<uint32_t>(rattoi32(count, radix, precision));
+
+        PNUMBER p = nullptr;
+        PNUMBER q = nullptr;
+        DUPNUM(p, (*px)->pp);
+        DUPNUM(q, (*px)->pq);
+        p->sign = 1;
+        q->sign = 1;
+        destroyrat(fact);
+        createrat(fact);
+        fallingsplit(p, q, 0, n, precision / g_ratio + 3, &(fact->pp), &(fact->pq));
+        subrat(px, count, precision);
+
+        destroynum(p);
+        destroynum(q);
+        destroyrat(count);
     }
 
     // Added to make numbers 'close enough' to integers use integer factorial.
@@ -229,16 +484,40 @@ void factrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
         intrat(&fact, radix, precision);
     }
 
-    while (rat_lt(*px, neg_rat_one, precision))
+    if (rat_lt(*px, neg_rat_one, precision))
     {
-        addrat(px, rat_one, precision);
-        divrat(&fact, *px, precision);
+        // Reflect, with y = -x = n + f
+        //
+        //     x! = pi / (sin(pi y) (y-1)!)   and   sin(pi y) = (-1)^n sin(pi f)
+        PRAT y = nullptr;
+        DUPRAT(y, *px);
+        NEGATE(y);
+        DUPRAT(*px, y);
+        subrat(px, rat_one, precision);
+        factrat(px, radix, precision);
+
+        PRAT n = nullptr;
+        DUPRAT(n, y);
+        intrat(&n, radix, precision);
+        bool fodd = (rattoi32(n, radix, precision) & 1) != 0;
+        subrat(&y, n, precision);
+        mulrat(&y, pi, precision);
+        sinanglerat(&y, ANGLE_RAD, radix, precision);
+        if (fodd)
+        {
+            NEGATE(y);
+        }
+        mulrat(&y, *px, precision);
+        DUPRAT(*px, pi);
+        divrat(px, y, precision);
+
+        destroyrat(n);
+        destroyrat(y);
     }
-
-    if (rat_neq(*px, rat_zero, precision))
+    else if (rat_neq(*px, rat_zero, precision))
     {
         addrat(px, rat_one, precision);
-        _gamma(px, radix, precision);
+        _gammaspouge(px, radix, precision);
         mulrat(px, fact, precision);
     }
     else
@@ -61,9 +61,15 @@ void ascalerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, int32_t precision)
 //
 //-----------------------------------------------------------------------------
 
-void _asinrat(PRAT* px, int32_t precision)
+void _asinrat(_Inout_ PRAT* px, int32_t precision)
 
 {
+    if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_ASIN, precision);
+        return;
+    }
+
     CREATETAYLOR();
     DUPRAT(pret, *px);
     DUPRAT(thisterm, *px);
@@ -259,6 +265,12 @@ void atananglerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_
 void _atanrat(PRAT* px, int32_t precision)
 
 {
+    if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_ATAN, precision);
+        return;
+    }
+
     CREATETAYLOR();
 
     DUPRAT(pret, *px);
@@ -65,6 +65,10 @@ void asinhrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
         lograt(px, precision);
         destroyrat(ptmp);
     }
+    else if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_ASINH, precision);
+    }
     else
     {
         CREATETAYLOR();
@@ -17,11 +17,136 @@
 
 using namespace std;
 
+//---------------------------------------------------------------------------
+//
+//  Integer kernels
+//
+//     Programmer mode only ever holds integers, and those are p over a one
+//  with no exponent.  The shifts and logical operations below take such
+//  rationals word by word on the mantissa of p, so they cost a pass over
+//  the digits rather than a multiply or divide of rationals.  Anything
+//  else goes the general way through intrat.
+//
+//---------------------------------------------------------------------------
+
+namespace
+{
+    // Whether x is an integer over a power of BASEX.
+    bool isintratx(PRAT x)
+    {
+        PNUMBER q = x->pq;
+        return q->cdigit == 1 && q->mant[0] == 1 && (zernum(x->pp) || x->pp->exp >= q->exp);
+    }
+
+    // Whether x is an integer from 0 to INT32_MAX, and if so its value.
+    bool smallintrat(PRAT x, _Out_ int32_t* pvalue)
+    {
+        PNUMBER p = x->pp;
+        if (!isintratx(x) || p->cdigit != 1 || p->mant[0] > INT32_MAX || (p->mant[0] != 0 && (p->sign * x->pq->sign < 0 || p->exp != x->pq->exp)))
+        {
+            return false;
+        }
+        *pvalue = static_cast<int32_t>(p->mant[0]);
+        return true;
+    }
+
+    // Folds the exponent of the denominator of an isintratx rational into
+    // the numerator, so the mantissa of p is the integer.
+    void unitrat(PRAT x)
+    {
+        x->pp->exp -= x->pq->exp;
+        x->pq->exp = 0;
+    }
+
+    // Moves the zero digits at the bottom of the mantissa into the exponent.
+    void trimlownum(PNUMBER a)
+    {
+        int32_t czero = 0;
+        while (czero < a->cdigit - 1 && a->mant[czero] == 0)
+        {
+            czero++;
+        }
+        if (czero > 0)
+        {
+            TRIMLOW(a, czero);
+        }
+    }
+
+    // *pa *= 2^bits, for negative bits the bits shifted out must be zero.
+    void shiftnum(PNUMBER* pa, int32_t bits)
+    {
+        PNUMBER a = *pa;
+        if (zernum(a))
+        {
+            return;
+        }
+
+        // Right shifts are a left shift by what is left of whole digits.
+        int32_t cdigitshift = bits >= 0 ? bits / static_cast<int32_t>(BASEXPWR) : -static_cast<int32_t>((-bits + BASEXPWR - 1) / BASEXPWR);
+        uint32_t shift = static_cast<uint32_t>(bits - cdigitshift * static_cast<int32_t>(BASEXPWR));
+        if (shift != 0)
+        {
+            PNUMBER c = nullptr;
+            createnum(c, a->cdigit + 1);
+            MANTTYPE carry = 0;
+            for (int32_t i = 0; i < a->cdigit; i++)
+            {
+                c->mant[i] = (a->mant[i] << shift) | carry;
+                carry = a->mant[i] >> (BASEXPWR - shift);
+            }
+            c->mant[a->cdigit] = carry;
+            c->cdigit = a->cdigit + (carry != 0 ? 1 : 0);
+            c->exp = a->exp;
+            c->sign = a->sign;
+            destroynum(*pa);
+            *pa = c;
+            a = c;
+        }
+        a->exp += cdigitshift;
+        if (bits < 0)
+        {
+            trimlownum(a);
+        }
+    }
+
+    // Count of zero bits at the bottom of the nonzero integer a.
+    int32_t lowzerobits(PNUMBER a)
+    {
+        int32_t czero = 0;
+        while (a->mant[czero] == 0)
+        {
+            czero++;
+        }
+        int32_t cbits = 0;
+        while (((a->mant[czero] >> cbits) & 1) == 0)
+        {
+            cbits++;
+        }
+        return (a->exp + czero) * BASEXPWR + cbits;
+    }
+}
+
 void lshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision)
 
 {
     PRAT pwr = nullptr;
     int32_t intb;
+    int32_t maxshift;
+
+    if (isintratx(*pa) && smallintrat(b, &intb) && smallintrat(rat_max_exp, &maxshift))
+    {
+        if (!zernum((*pa)->pp))
+        {
+            if (intb > maxshift)
+            {
+                // Don't attempt lsh of anything big
+                throw(CALC_E_DOMAIN);
+            }
+            unitrat(*pa);
+            shiftnum(&((*pa)->pp), intb);
+        }
+        return;
+    }
 
     intrat(pa, radix, precision);
     if (!zernum((*pa)->pp))
@@ -46,6 +171,20 @@ void rshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision)
     PRAT pwr = nullptr;
     int32_t intb;
 
+    if (isintratx(*pa) && smallintrat(b, &intb))
+    {
+        if (!zernum((*pa)->pp))
+        {
+            // The zero bits of p shift out, the rest stays as a power of two
+            // under it.
+            unitrat(*pa);
+            int32_t cbits = min(lowzerobits((*pa)->pp), intb);
+            shiftnum(&((*pa)->pp), -cbits);
+            shiftnum(&((*pa)->pq), intb - cbits);
+        }
+        return;
+    }
+
     intrat(pa, radix, precision);
     if (!zernum((*pa)->pp))
     {
@@ -100,12 +239,20 @@ void xorrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision)
 //    RETURN: None, changes pointer.
 //
 //    DESCRIPTION: Does the rational equivalent of *pa op= b;
+//    Integers over a one go straight to boolnum.
 //
 //---------------------------------------------------------------------------
 
 void boolrat(PRAT* pa, PRAT b, int func, uint32_t radix, int32_t precision)
 
 {
+    if (isintratx(*pa) && isintratx(b) && b->pq->exp == 0)
+    {
+        unitrat(*pa);
+        boolnum(&((*pa)->pp), b->pp, func);
+        return;
+    }
+
     PRAT tmp = nullptr;
     intrat(pa, radix, precision);
     DUPRAT(tmp, b);
@@ -126,6 +273,8 @@ void boolrat(PRAT* pa, PRAT b, int func, uint32_t radix, int32_t precision)
 //    DESCRIPTION: Does the number equivalent of *pa &= b.
 //    radix doesn't matter for logicals.
 //    WARNING: Assumes numbers are unsigned.
+//    The digits of a are copied into place and b is combined into them
+//    a whole word at a time, an and only spans the digits both have.
 //
 //---------------------------------------------------------------------------
 
@@ -133,46 +282,81 @@ void boolnum(PNUMBER* pa, PNUMBER b, int func)
 
 {
     PNUMBER c = nullptr;
-    PNUMBER a = nullptr;
-    MANTTYPE* pcha;
-    MANTTYPE* pchb;
-    MANTTYPE* pchc;
-    int32_t cdigits;
+    PNUMBER a = *pa;
     int32_t mexp;
-    MANTTYPE da;
-    MANTTYPE db;
-
-    a = *pa;
-    cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - min(a->exp, b->exp);
-    createnum(c, cdigits);
-    c->exp = min(a->exp, b->exp);
-    mexp = c->exp;
-    c->cdigit = cdigits;
-    pcha = a->mant;
-    pchb = b->mant;
-    pchc = c->mant;
-    for (; cdigits > 0; cdigits--, mexp++)
+    int32_t mtop;
+
+    // Zero is a single zero digit whatever its exponent, keep it out of the
+    // alignment.
+    int32_t aexp = zernum(a) ? b->exp : a->exp;
+    int32_t bexp = zernum(b) ? aexp : b->exp;
+    int32_t atop = aexp + a->cdigit;
+    int32_t btop = bexp + b->cdigit;
+    if (func == FUNC_AND)
+    {
+        mexp = max(aexp, bexp);
+        mtop = min(atop, btop);
+    }
+    else
+    {
+        mexp = min(aexp, bexp);
+        mtop = max(atop, btop);
+    }
+
+    if (mtop <= mexp)
+    {
+        createnum(c, 1);
+        c->cdigit = 1;
+    }
+    else
     {
-        da = (((mexp >= a->exp) && (cdigits + a->exp - c->exp > (c->cdigit - a->cdigit))) ? *pcha++ : 0);
-        db = (((mexp >= b->exp) && (cdigits + b->exp - c->exp > (c->cdigit - b->cdigit))) ? *pchb++ : 0);
+        createnum(c, mtop - mexp);
+        c->cdigit = mtop - mexp;
+        c->exp = mexp;
+
+        int32_t lo = max(aexp, mexp);
+        int32_t hi = min(atop, mtop);
+        if (lo < hi)
+        {
+            memcpy(c->mant + (lo - mexp), a->mant + (lo - aexp), (hi - lo) * sizeof(MANTTYPE));
+        }
+
+        lo = max(bexp, mexp);
+        hi = min(btop, mtop);
+        MANTTYPE* pchc = c->mant + (lo - mexp);
+        const MANTTYPE* pchb = b->mant + (lo - bexp);
         switch (func)
         {
         case FUNC_AND:
-            *pchc++ = da & db;
+            for (int32_t i = lo; i < hi; i++)
+            {
+                *pchc++ &= *pchb++;
+            }
             break;
         case FUNC_OR:
-            *pchc++ = da | db;
+            for (int32_t i = lo; i < hi; i++)
+            {
+                *pchc++ |= *pchb++;
+            }
             break;
         case FUNC_XOR:
-            *pchc++ = da ^ db;
+            for (int32_t i = lo; i < hi; i++)
+            {
+                *pchc++ ^= *pchb++;
+            }
             break;
         }
+
+        while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
+        {
+            c->cdigit--;
+        }
+        if (zernum(c))
+        {
+            c->exp = 0;
+        }
     }
     c->sign = a->sign;
-    while (c->cdigit > 1 && *(--pchc) == 0)
-    {
-        c->cdigit--;
-    }
     destroynum(*pa);
     *pa = c;
 }
@@ -248,7 +432,8 @@ void modrat(_Inout_ PRAT* pa, _In_ PRAT b)
 
     if (needAdjust && !zerrat(*pa))
     {
-        addrat(pa, b, BASEX);
+        // There is no precision here, make sure the addition doesn't trim.
+        addrat(pa, b, INT32_MAX);
     }
 
     // Get *pa back in the integer over integer form.
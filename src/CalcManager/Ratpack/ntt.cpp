@@ -0,0 +1,312 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           ntt.cpp
+//
+//
+//  Description
+//
+//     Contains number theoretic transform multiplication of BASEX mantissas,
+//  used for very high precision where even Toom-3 is too slow.
+//
+//     Each mantissa is treated as a polynomial in BASEX, the product of the
+//  polynomials is computed exactly modulo three NTT friendly primes and the
+//  coefficients are recovered with the chinese remainder theorem before the
+//  carries are propagated.  A coefficient of the product is at most
+//  min(ca,cb) * (BASEX-1)^2 which is less than the product of the primes for
+//  every transform size the primes support.
+//
+//-----------------------------------------------------------------------------
+#include "ratpak.h"
+#include <vector>
+
+using namespace std;
+
+// Size, in BASEX digits of the smaller operand, at which _mulmantx switches
+// to NTT multiplication.
+int32_t g_nttThreshold = NTT_THRESHOLD;
+
+namespace
+{
+    // The primes are all of the form k*2^n + 1 with 3 as a primitive root.
+    constexpr uint32_t NTTPRIME0 = 998244353; //  119 * 2^23 + 1
+    constexpr uint32_t NTTPRIME1 = 167772161; //    5 * 2^25 + 1
+    constexpr uint32_t NTTPRIME2 = 469762049; //    7 * 2^26 + 1
+    constexpr uint32_t NTTROOT = 3;
+
+    // Largest transform all three primes support.
+    constexpr int32_t NTTMAXLOG = 23;
+
+    constexpr TWO_MANTTYPE MANTMASK = (((TWO_MANTTYPE)1) << BASEXPWR) - 1;
+
+    uint32_t mulmod(uint32_t a, uint32_t b, uint32_t mod)
+    {
+        return (uint32_t)(((uint64_t)a * b) % mod);
+    }
+
+    uint32_t powmod(uint32_t base, uint32_t power, uint32_t mod)
+    {
+        uint32_t result = 1;
+        while (power)
+        {
+            if (power & 1)
+            {
+                result = mulmod(result, base, mod);
+            }
+            base = mulmod(base, base, mod);
+            power >>= 1;
+        }
+        return result;
+    }
+
+    //-----------------------------------------------------------------------------
+    //
+    //  Montgomery arithmetic modulo one of the primes with R = 2^32, this
+    //  avoids a 64 bit division in the inner loop of the transform.
+    //  montmul(a, b) is a*b/R mod p, so multiplying by a twiddle factor kept
+    //  in Montgomery form, w*R, gives a*w directly.
+    //
+    //-----------------------------------------------------------------------------
+
+    struct MONTGOMERY
+    {
+        uint32_t mod;
+        uint32_t modneginv; // -mod^-1 mod 2^32
+        uint32_t r2;        // R^2 mod mod
+
+        explicit MONTGOMERY(uint32_t m)
+            : mod(m)
+        {
+            uint32_t inv = m; // Newton iteration, each step doubles the correct bits.
+            for (int i = 0; i < 4; i++)
+            {
+                inv *= 2 - m * inv;
+            }
+            modneginv = 0 - inv;
+            uint64_t r = ((uint64_t)1 << 32) % m;
+            r2 = (uint32_t)((r * r) % m);
+        }
+
+        uint32_t reduce(uint64_t t) const
+        {
+            uint32_t q = (uint32_t)t * modneginv;
+            uint32_t u = (uint32_t)((t + (uint64_t)q * mod) >> 32);
+            return (u >= mod) ? u - mod : u;
+        }
+
+        uint32_t montmul(uint32_t a, uint32_t b) const
+        {
+            return reduce((uint64_t)a * b);
+        }
+
+        uint32_t tomont(uint32_t a) const
+        {
+            return montmul(a, r2);
+        }
+    };
+
+    //-----------------------------------------------------------------------------
+    //
+    //    FUNCTION: ntt
+    //
+    //    ARGUMENTS: vector of residues whose size is a power of two, the
+    //               modulus and whether the inverse transform is wanted.
+    //
+    //    DESCRIPTION: In place iterative radix 2 transform.  The division by
+    //    the transform size on the inverse is left to the caller.
+    //
+    //-----------------------------------------------------------------------------
+
+    void ntt(vector<uint32_t>& a, const MONTGOMERY& mg, bool finverse)
+    {
+        const size_t n = a.size();
+        const uint32_t mod = mg.mod;
+
+        // Bit reversal permutation.
+        for (size_t i = 1, j = 0; i < n; i++)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                swap(a[i], a[j]);
+            }
+        }
+
+        vector<uint32_t> roots(n / 2 + 1);
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            uint32_t w = powmod(NTTROOT, (mod - 1) / (uint32_t)len, mod);
+            if (finverse)
+            {
+                w = powmod(w, mod - 2, mod);
+            }
+
+            // Twiddle factors in Montgomery form.
+            const size_t half = len / 2;
+            const uint32_t wmont = mg.tomont(w);
+            roots[0] = mg.tomont(1);
+            for (size_t i = 1; i < half; i++)
+            {
+                roots[i] = mg.montmul(roots[i - 1], wmont);
+            }
+
+            for (size_t i = 0; i < n; i += len)
+            {
+                uint32_t* lo = &a[i];
+                uint32_t* hi = &a[i + half];
+                for (size_t j = 0; j < half; j++)
+                {
+                    uint32_t u = lo[j];
+                    uint32_t v = mg.montmul(hi[j], roots[j]);
+                    lo[j] = (u + v >= mod) ? u + v - mod : u + v;
+                    hi[j] = (u >= v) ? u - v : u + mod - v;
+                }
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------
+    //
+    //    FUNCTION: nttconvolve
+    //
+    //    DESCRIPTION: Returns the cyclic convolution of the two mantissas, of
+    //    length n, reduced modulo mod.  When pb is null the mantissa is
+    //    squared, which saves a forward transform.
+    //
+    //-----------------------------------------------------------------------------
+
+    vector<uint32_t> nttconvolve(const MANTTYPE* pa, int32_t ca, const MANTTYPE* pb, int32_t cb, size_t n, uint32_t mod)
+    {
+        const MONTGOMERY mg(mod);
+
+        vector<uint32_t> fa(n, 0);
+        for (int32_t i = 0; i < ca; i++)
+        {
+            fa[i] = pa[i] % mod;
+        }
+        ntt(fa, mg, false);
+
+        // The pointwise products come out divided by R, which is folded
+        // into the final scaling along with 1/n.
+        if (pb == nullptr)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                fa[i] = mg.montmul(fa[i], fa[i]);
+            }
+        }
+        else
+        {
+            vector<uint32_t> fb(n, 0);
+            for (int32_t i = 0; i < cb; i++)
+            {
+                fb[i] = pb[i] % mod;
+            }
+            ntt(fb, mg, false);
+            for (size_t i = 0; i < n; i++)
+            {
+                fa[i] = mg.montmul(fa[i], fb[i]);
+            }
+        }
+
+        ntt(fa, mg, true);
+
+        // Multiply by R/n, montmul with (R/n)*R gives exactly that.
+        const uint32_t scale = mg.tomont(mg.tomont(powmod((uint32_t)(n % mod), mod - 2, mod)));
+        for (auto& x : fa)
+        {
+            x = mg.montmul(x, scale);
+        }
+        return fa;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _fitsntt
+//
+//    ARGUMENTS: digit count of the product.
+//
+//    RETURN: true if _mulmantntt can compute a product that long.
+//
+//-----------------------------------------------------------------------------
+
+bool _fitsntt(int32_t cc)
+{
+    return cc > 0 && cc <= (1 << NTTMAXLOG);
+}
+
+//-----------------------------------------------------------------------------
+//
+//    FUNCTION: _mulmantntt
+//
+//    ARGUMENTS: result mantissa with room for ca + cb digits, and two
+//               mantissas with their digit counts.
+//
+//    RETURN: None, fills in pc.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pc = pa * pb using three
+//    modular transforms.  The caller must check _fitsntt(ca + cb) first.
+//
+//    The residues r0, r1, r2 of each coefficient are combined with Garner's
+//    method, x = r0 + p0*t1 + p0*p1*t2 with t1 < p1 and t2 < p2, which keeps
+//    every intermediate within 64 bits while x is built up as three BASEX
+//    digits.
+//
+//-----------------------------------------------------------------------------
+
+void _mulmantntt(_Out_ MANTTYPE* pc, _In_ const MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb)
+{
+    const int32_t cc = ca + cb;
+    size_t n = 1;
+    while (n < (size_t)cc)
+    {
+        n <<= 1;
+    }
+
+    const MANTTYPE* pbconv = (pa == pb && ca == cb) ? nullptr : pb;
+    vector<uint32_t> r0 = nttconvolve(pa, ca, pbconv, cb, n, NTTPRIME0);
+    vector<uint32_t> r1 = nttconvolve(pa, ca, pbconv, cb, n, NTTPRIME1);
+    vector<uint32_t> r2 = nttconvolve(pa, ca, pbconv, cb, n, NTTPRIME2);
+
+    const uint32_t p0invp1 = powmod(NTTPRIME0 % NTTPRIME1, NTTPRIME1 - 2, NTTPRIME1);
+    const uint32_t p0p1invp2 = powmod(mulmod(NTTPRIME0 % NTTPRIME2, NTTPRIME1 % NTTPRIME2, NTTPRIME2), NTTPRIME2 - 2, NTTPRIME2);
+    const TWO_MANTTYPE p0p1 = (TWO_MANTTYPE)NTTPRIME0 * NTTPRIME1;
+    const TWO_MANTTYPE p0p1lo = p0p1 & MANTMASK;
+    const TWO_MANTTYPE p0p1hi = p0p1 >> BASEXPWR;
+
+    // The carry into the next digit is itself up to three digits long.
+    TWO_MANTTYPE cy0 = 0;
+    TWO_MANTTYPE cy1 = 0;
+    TWO_MANTTYPE cy2 = 0;
+    for (int32_t i = 0; i < cc; i++)
+    {
+        uint32_t x0 = r0[i];
+        uint32_t t1 = mulmod((r1[i] + NTTPRIME1 - x0 % NTTPRIME1) % NTTPRIME1, p0invp1, NTTPRIME1);
+        uint32_t x01 = (uint32_t)((x0 + (uint64_t)NTTPRIME0 * t1) % NTTPRIME2);
+        uint32_t t2 = mulmod((r2[i] + NTTPRIME2 - x01) % NTTPRIME2, p0p1invp2, NTTPRIME2);
+
+        // x = x0 + p0*t1 + p0p1*t2 as three digits v0, v1, v2.
+        TWO_MANTTYPE acc = (TWO_MANTTYPE)x0 + (TWO_MANTTYPE)NTTPRIME0 * t1 + p0p1lo * t2;
+        TWO_MANTTYPE v0 = acc & MANTMASK;
+        acc = (acc >> BASEXPWR) + p0p1hi * t2;
+        TWO_MANTTYPE v1 = acc & MANTMASK;
+        TWO_MANTTYPE v2 = acc >> BASEXPWR;
+
+        // Add x to the carry, the low digit is the result digit.
+        acc = cy0 + v0;
+        pc[i] = (MANTTYPE)(acc & MANTMASK);
+        acc = (acc >> BASEXPWR) + cy1 + v1;
+        cy0 = acc & MANTMASK;
+        acc = (acc >> BASEXPWR) + cy2 + v2;
+        cy1 = acc & MANTMASK;
+        cy2 = acc >> BASEXPWR;
+    }
+}
@@ -17,8 +17,9 @@
 //
 //
 //-----------------------------------------------------------------------------
-#include <list>
+#include <algorithm>
 #include <cstring> // for memmove
+#include <vector>
 #include "ratpak.h"
 
 using namespace std;
@@ -41,9 +42,9 @@ using namespace std;
 //
 //----------------------------------------------------------------------------
 
-void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix);
+void _addnum(PNUMBER* pa, PNUMBER b, uint64_t radix);
 
-void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
+void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix)
 
 {
     if (b->cdigit > 1 || b->mant[0] != 0)
@@ -59,7 +60,7 @@ void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
     }
 }
 
-void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
+void _addnum(PNUMBER* pa, PNUMBER b, uint64_t radix)
 
 {
     PNUMBER c = nullptr; // c will contain the result.
@@ -72,30 +73,73 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
     int32_t mexp;        // mexp is the exponent of the result.
     MANTTYPE da;         // da is a single 'digit' after possible padding.
     MANTTYPE db;         // db is a single 'digit' after possible padding.
-    MANTTYPE cy = 0;     // cy is the value of a carry after adding two 'digits'
+    TWO_MANTTYPE cy = 0; // cy is the value of a carry after adding two 'digits'
     int32_t fcompla = 0; // fcompla is a flag to signal a is negative.
     int32_t fcomplb = 0; // fcomplb is a flag to signal b is negative.
 
     a = *pa;
 
+    // A sum of two digits is split with a shift and mask in BASEX, which is
+    // cheaper than a division.
+    const bool fbasex = (radix == BASEX);
+
     // Calculate the overlap of the numbers after alignment, this includes
     // necessary padding 0's
     cdigits = max(a->cdigit + a->exp, b->cdigit + b->exp) - min(a->exp, b->exp);
 
-    createnum(c, cdigits + 1);
-    c->exp = min(a->exp, b->exp);
-    mexp = c->exp;
+    if (a->cdigitmax >= cdigits + 1)
+    {
+        // The sum fits in a, so it is written over a.  Digits of the result
+        // are produced no faster than digits of a are read once a is aligned
+        // to the exponent of the result, which takes padding a with zeros
+        // when b has the lower exponent.  Digits trimmed off the bottom of a
+        // leave room for the padding, failing that, or when the sum would
+        // run off the end of the buffer, a moves to the start of it.
+        int32_t cpad = max(a->exp - b->exp, 0);
+        int32_t ctrimmed = (int32_t)(a->mant - MANTBASE(a));
+        MANTTYPE* pmant = MANTBASE(a);
+        if (ctrimmed >= cpad && ctrimmed - cpad + cdigits + 1 <= a->cdigitmax)
+        {
+            pmant += ctrimmed - cpad;
+        }
+        else
+        {
+            memmove(pmant + cpad, a->mant, a->cdigit * sizeof(MANTTYPE));
+        }
+        memset(pmant, 0, cpad * sizeof(MANTTYPE));
+        a->mant = pmant;
+        a->cdigit += cpad;
+        a->exp -= cpad;
+        c = a;
+    }
+    else
+    {
+        createnum(c, cdigits + 1);
+    }
+
+    // The shape of a and b is captured up front, as the result may be a, and
+    // b may be a as well.
+    const int32_t expa = a->exp;
+    const int32_t cdigita = a->cdigit;
+    const int32_t signa = a->sign;
+    const int32_t expb = b->exp;
+    const int32_t cdigitb = b->cdigit;
+    const int32_t signb = b->sign;
+    const int32_t expc = min(expa, expb);
+
+    mexp = expc;
+    c->exp = expc;
     c->cdigit = cdigits;
     pcha = a->mant;
     pchb = b->mant;
     pchc = c->mant;
 
     // Figure out the sign of the numbers
-    if (a->sign != b->sign)
+    if (signa != signb)
     {
         cy = 1;
-        fcompla = (a->sign == -1);
-        fcomplb = (b->sign == -1);
+        fcompla = (signa == -1);
+        fcomplb = (signb == -1);
     }
 
     // Loop over all the digits, real and 0 padded. Here we know a and b are
@@ -103,38 +147,38 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
     for (; cdigits > 0; cdigits--, mexp++)
     {
         // Get digit from a, taking padding into account.
-        da = (((mexp >= a->exp) && (cdigits + a->exp - c->exp > (c->cdigit - a->cdigit))) ? *pcha++ : 0);
+        da = (((mexp >= expa) && (cdigits + expa - expc > (c->cdigit - cdigita))) ? *pcha++ : 0);
         // Get digit from b, taking padding into account.
-        db = (((mexp >= b->exp) && (cdigits + b->exp - c->exp > (c->cdigit - b->cdigit))) ? *pchb++ : 0);
+        db = (((mexp >= expb) && (cdigits + expb - expc > (c->cdigit - cdigitb))) ? *pchb++ : 0);
 
         // Handle complementing for a and b digit. Might be a better way, but
         // haven't found it yet.
         if (fcompla)
         {
-            da = (MANTTYPE)(radix)-1 - da;
+            da = (MANTTYPE)(radix - 1) - da;
         }
         if (fcomplb)
         {
-            db = (MANTTYPE)(radix)-1 - db;
+            db = (MANTTYPE)(radix - 1) - db;
         }
 
         // Update carry as necessary
-        cy = da + db + cy;
-        *pchc++ = (MANTTYPE)(cy % (MANTTYPE)radix);
-        cy /= (MANTTYPE)radix;
+        cy = (TWO_MANTTYPE)da + db + cy;
+        *pchc++ = (MANTTYPE)(fbasex ? cy : cy % radix);
+        cy = fbasex ? cy >> BASEXPWR : cy / radix;
     }
 
     // Handle carry from last sum as extra digit
     if (cy && !(fcompla || fcomplb))
     {
-        *pchc++ = cy;
+        *pchc++ = (MANTTYPE)cy;
         c->cdigit++;
     }
 
     // Compute sign of result
     if (!(fcompla || fcomplb))
     {
-        c->sign = a->sign;
+        c->sign = signa;
     }
     else
     {
@@ -152,9 +196,9 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
             cy = 1;
             for ((cdigits = c->cdigit), (pchc = c->mant); cdigits > 0; cdigits--)
             {
-                cy = (MANTTYPE)radix - (MANTTYPE)1 - *pchc + cy;
-                *pchc++ = (MANTTYPE)(cy % (MANTTYPE)radix);
-                cy /= (MANTTYPE)radix;
+                cy = radix - 1 - *pchc + cy;
+                *pchc++ = (MANTTYPE)(fbasex ? cy : cy % radix);
+                cy = fbasex ? cy >> BASEXPWR : cy / radix;
             }
         }
     }
@@ -165,8 +209,11 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
     {
         c->cdigit--;
     }
-    destroynum(*pa);
-    *pa = c;
+    if (c != a)
+    {
+        destroynum(*pa);
+        *pa = c;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -184,9 +231,9 @@ void _addnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 //
 //----------------------------------------------------------------------------
 
-void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix);
+void _mulnum(PNUMBER* pa, PNUMBER b, uint64_t radix);
 
-void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
+void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix)
 
 {
     if (b->cdigit > 1 || b->mant[0] != 1 || b->exp != 0)
@@ -208,7 +255,7 @@ void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
     }
 }
 
-void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
+void _mulnum(PNUMBER* pa, PNUMBER b, uint64_t radix)
 
 {
     PNUMBER c = nullptr;  // c will contain the result.
@@ -283,6 +330,12 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
         c->cdigit--;
     }
 
+    // A zero product, make sure no weird exponents creep in.
+    if (c->cdigit == 1 && c->mant[0] == 0)
+    {
+        c->exp = 0;
+    }
+
     destroynum(*pa);
     *pa = c;
 }
@@ -302,7 +355,7 @@ void _mulnum(PNUMBER* pa, PNUMBER b, uint32_t radix)
 //
 //----------------------------------------------------------------------------
 
-void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
+void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix)
 
 {
     PNUMBER tmp = nullptr;     // tmp is the working remainder.
@@ -363,9 +416,9 @@ void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix)
 //
 //---------------------------------------------------------------------------
 
-void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision);
+void _divnum(PNUMBER* pa, PNUMBER b, uint64_t radix, int32_t precision);
 
-void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t precision)
+void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix, int32_t precision)
 
 {
     if (b->cdigit > 1 || b->mant[0] != 1 || b->exp != 0)
@@ -379,13 +432,12 @@ void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t precisi
     }
 }
 
-void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision)
+void _divnum(PNUMBER* pa, PNUMBER b, uint64_t radix, int32_t precision)
 {
-    PNUMBER a = *pa;
     int32_t thismax = precision + 2;
-    if (thismax < a->cdigit)
+    if (thismax < (*pa)->cdigit)
     {
-        thismax = a->cdigit;
+        thismax = (*pa)->cdigit;
     }
 
     if (thismax < b->cdigit)
@@ -393,87 +445,269 @@ void _divnum(PNUMBER* pa, PNUMBER b, uint32_t radix, int32_t precision)
         thismax = b->cdigit;
     }
 
+    _divnumtrunc(pa, b, radix, thismax);
+}
+
+// Size, in digits of the radix, of both the divisor and the quotient at
+// which _divnumtrunc converts to BASEX to divide.
+int32_t g_radixDivThreshold = RADIX_DIV_THRESHOLD;
+
+//---------------------------------------------------------------------------
+//
+//    FUNCTION: _divnumtrunc
+//
+//    ARGUMENTS: pointer to a number a second number, the radix and the
+//               number of quotient digits to produce.
+//
+//    RETURN: None, changes first pointer.
+//
+//    DESCRIPTION: Does the number equivalent of *pa /= b, truncated to
+//    thismax digits counting from the most significant possible digit of
+//    the quotient.  thismax must be at least the digit count of both
+//    numbers.  When the division is exact only the significant digits are
+//    kept.
+//
+//    ALGORITHM: Writing a = A*radix^ea and b = B*radix^eb the highest
+//    possible quotient digit is at position (ea + A->cdigit) -
+//    (eb + B->cdigit), so the truncated quotient is the integer quotient
+//    of A shifted up enough digits to produce thismax digits, divided by B.
+//    In a radix other than BASEX that division is long division, so once
+//    the divisor and quotient are long enough it is done in BASEX by
+//    _divmantradix.
+//
+//---------------------------------------------------------------------------
+
+void _divnumtrunc(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix, int32_t thismax)
+{
+    PNUMBER a = *pa;
     PNUMBER c = nullptr;
+
+    // Strip any leading zeros from the divisor, the division kernels need
+    // a nonzero top digit.
+    int32_t cb = b->cdigit;
+    while (cb > 1 && b->mant[cb - 1] == 0)
+    {
+        cb--;
+    }
+    if (cb == 1 && b->mant[0] == 0)
+    {
+        throw(CALC_E_DIVIDEBYZERO);
+    }
+
     createnum(c, thismax + 1);
-    c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1;
     c->sign = a->sign * b->sign;
+    c->exp = (a->cdigit + a->exp) - (b->cdigit + b->exp) + 1 - thismax;
 
-    MANTTYPE* ptrc = c->mant + thismax;
-    PNUMBER rem = nullptr;
-    PNUMBER tmp = nullptr;
-    DUPNUM(rem, a);
-    DUPNUM(tmp, b);
-    tmp->sign = a->sign;
-    rem->exp = b->cdigit + b->exp - rem->cdigit;
+    // The shifted dividend, shift >= b->cdigit - 1 since thismax >= a->cdigit.
+    const int32_t shift = thismax - a->cdigit + b->cdigit - 1;
+    const int32_t cn = a->cdigit + shift;
+    vector<MANTTYPE> n(cn, 0);
+    copy(a->mant, a->mant + a->cdigit, n.begin() + shift);
 
-    // Build a table of multiplications of the divisor, this is quicker for
-    // more than radix 'digits'
-    list<PNUMBER> numberList{ i32tonum(0L, radix) };
-    for (uint32_t i = 1; i < radix; i++)
+    int32_t cq = 0;
+    bool fexact = true;
+    if (cn >= cb)
     {
-        PNUMBER newValue = nullptr;
-        DUPNUM(newValue, numberList.front());
-        addnum(&newValue, tmp, radix);
+        // The quotient has cn - cb + 1 digits, which is at most thismax + 1.
+        cq = cn - cb + 1;
+        vector<MANTTYPE> q(cq);
+        if (radix != BASEX && cb >= g_radixDivThreshold && cq >= g_radixDivThreshold)
+        {
+            // Only whether the remainder is zero is needed, which saves
+            // converting it back.
+            fexact = _divmantradix(q.data(), nullptr, n.data(), cn, b->mant, cb, static_cast<uint32_t>(radix));
+        }
+        else
+        {
+            vector<MANTTYPE> r(cb);
+            if (radix == BASEX)
+            {
+                _divmantx(q.data(), r.data(), n.data(), cn, b->mant, cb);
+            }
+            else
+            {
+                _divmantbase(q.data(), r.data(), n.data(), cn, b->mant, cb, radix);
+            }
+            fexact = all_of(r.begin(), r.end(), [](MANTTYPE digit) { return digit == 0; });
+        }
 
-        numberList.emplace_front(newValue);
+        // The quotient is less than radix^thismax.
+        cq = min(cq, thismax);
+        copy(q.begin(), q.begin() + cq, c->mant);
+    }
+
+    // prevent different kinds of zeros, by stripping leading duplicate
+    // zeros. digits are in order of increasing significance.
+    while (cq > 0 && c->mant[cq - 1] == 0)
+    {
+        cq--;
     }
-    destroynum(tmp);
 
-    int32_t digit;
-    int32_t cdigits = 0;
-    while (cdigits++ < thismax && !zernum(rem))
+    if (!cq)
     {
-        digit = radix - 1;
-        PNUMBER multiple = nullptr;
-        for (const auto& num : numberList)
+        // A zero, make sure no weird exponents creep in
+        c->cdigit = 1;
+        c->mant[0] = 0;
+        c->exp = 0;
+    }
+    else
+    {
+        // An exact quotient keeps only its significant digits.
+        int32_t ctrail = 0;
+        if (fexact)
         {
-            if (!lessnum(rem, num) || !--digit)
+            while (c->mant[ctrail] == 0)
             {
-                multiple = num;
-                break;
+                ctrail++;
             }
         }
+        c->cdigit = cq;
+        TRIMLOW(c, ctrail);
+    }
 
-        if (digit)
+    destroynum(*pa);
+    *pa = c;
+}
+
+//---------------------------------------------------------------------------
+//
+//    FUNCTION: _divmantbase
+//
+//    ARGUMENTS: quotient mantissa with room for cn - cb + 1 digits,
+//               remainder mantissa with room for cb digits (may be null),
+//               dividend and divisor mantissas with their digit counts,
+//               and the radix.
+//
+//    RETURN: None, fills in pq and pr.
+//
+//    DESCRIPTION: Does the mantissa equivalent of pq = pn / pb and
+//    pr = pn % pb, for cn >= cb and a divisor with a nonzero top digit.
+//
+//    ALGORITHM: Schoolbook long division (Knuth, vol 2, algorithm D).  Both
+//    numbers are first scaled so the top digit of the divisor is at least
+//    radix/2, then each quotient digit is estimated from the top two digits
+//    of the running remainder and is off by at most two.
+//
+//---------------------------------------------------------------------------
+
+void _divmantbase(_Out_ MANTTYPE* pq, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, _In_ const MANTTYPE* pb, int32_t cb, uint64_t radix)
+{
+    const TWO_MANTTYPE tradix = radix;
+
+    // Splitting a double digit into digits is a shift and mask for BASEX,
+    // which is much cheaper than a division.
+    int32_t radixpwr = -1;
+    if ((radix & (radix - 1)) == 0)
+    {
+        radixpwr = 0;
+        while (((TWO_MANTTYPE)1 << radixpwr) < tradix)
         {
-            multiple->sign *= -1;
-            addnum(&rem, multiple, radix);
-            multiple->sign *= -1;
+            radixpwr++;
         }
-        rem->exp++;
-        *ptrc-- = (MANTTYPE)digit;
     }
-    cdigits--;
+    auto hidigit = [=](TWO_MANTTYPE x) { return (radixpwr >= 0) ? x >> radixpwr : x / tradix; };
+    auto lodigit = [=](TWO_MANTTYPE x) { return (radixpwr >= 0) ? x & (tradix - 1) : x % tradix; };
 
-    if (c->mant != ++ptrc)
+    if (cb == 1)
     {
-        memmove(c->mant, ptrc, (int)(cdigits * sizeof(MANTTYPE)));
+        // Single digit divisor, no estimates needed.
+        const TWO_MANTTYPE divisor = pb[0];
+        TWO_MANTTYPE rem = 0;
+        for (int32_t i = cn - 1; i >= 0; i--)
+        {
+            TWO_MANTTYPE cur = rem * tradix + pn[i];
+            pq[i] = (MANTTYPE)(cur / divisor);
+            rem = cur % divisor;
+        }
+        if (pr != nullptr)
+        {
+            pr[0] = (MANTTYPE)rem;
+        }
+        return;
     }
 
-    // Cleanup table structure
-    for (auto& num : numberList)
+    // Normalize, u = n * d and v = b * d where v's top digit is >= radix/2.
+    const TWO_MANTTYPE d = tradix / ((TWO_MANTTYPE)pb[cb - 1] + 1);
+    vector<MANTTYPE> u(cn + 1);
+    vector<MANTTYPE> v(cb);
+    TWO_MANTTYPE cy = 0;
+    for (int32_t i = 0; i < cn; i++)
     {
-        destroynum(num);
+        cy += pn[i] * d;
+        u[i] = (MANTTYPE)lodigit(cy);
+        cy = hidigit(cy);
     }
-
-    if (!cdigits)
+    u[cn] = (MANTTYPE)cy;
+    cy = 0;
+    for (int32_t i = 0; i < cb; i++)
     {
-        c->cdigit = 1;
-        c->exp = 0;
+        cy += pb[i] * d;
+        v[i] = (MANTTYPE)lodigit(cy);
+        cy = hidigit(cy);
     }
-    else
+
+    const TWO_MANTTYPE vtop = v[cb - 1];
+    const TWO_MANTTYPE vnext = v[cb - 2];
+    for (int32_t j = cn - cb; j >= 0; j--)
     {
-        c->cdigit = cdigits;
-        c->exp -= cdigits;
-        while (c->cdigit > 1 && c->mant[c->cdigit - 1] == 0)
+        // Estimate the quotient digit from the top of the remainder.
+        TWO_MANTTYPE num = u[j + cb] * tradix + u[j + cb - 1];
+        TWO_MANTTYPE qhat = num / vtop;
+        TWO_MANTTYPE rhat = num % vtop;
+        while (qhat >= tradix || qhat * vnext > rhat * tradix + u[j + cb - 2])
+        {
+            qhat--;
+            rhat += vtop;
+            if (rhat >= tradix)
+            {
+                break;
+            }
+        }
+
+        // u -= qhat * v, shifted j digits.
+        TWO_MANTTYPE mulcy = 0;
+        int64_t borrow = 0;
+        for (int32_t i = 0; i < cb; i++)
+        {
+            TWO_MANTTYPE prod = qhat * v[i] + mulcy;
+            mulcy = hidigit(prod);
+            int64_t diff = (int64_t)u[i + j] - (int64_t)lodigit(prod) - borrow;
+            borrow = (diff < 0) ? 1 : 0;
+            u[i + j] = (MANTTYPE)(diff + borrow * (int64_t)tradix);
+        }
+        int64_t diff = (int64_t)u[j + cb] - (int64_t)mulcy - borrow;
+        if (diff < 0)
         {
-            c->cdigit--;
+            // The estimate was one too large, add v back in.
+            qhat--;
+            u[j + cb] = (MANTTYPE)(diff + (int64_t)tradix);
+            cy = 0;
+            for (int32_t i = 0; i < cb; i++)
+            {
+                cy += (TWO_MANTTYPE)u[i + j] + v[i];
+                u[i + j] = (MANTTYPE)lodigit(cy);
+                cy = hidigit(cy);
+            }
+            u[j + cb] = (MANTTYPE)((u[j + cb] + cy) % tradix);
         }
+        else
+        {
+            u[j + cb] = (MANTTYPE)diff;
+        }
+        pq[j] = (MANTTYPE)qhat;
     }
-    destroynum(rem);
 
-    destroynum(*pa);
-    *pa = c;
+    if (pr != nullptr)
+    {
+        // Undo the normalization on the remainder.
+        TWO_MANTTYPE rem = 0;
+        for (int32_t i = cb - 1; i >= 0; i--)
+        {
+            TWO_MANTTYPE cur = rem * tradix + u[i];
+            pr[i] = (MANTTYPE)(cur / d);
+            rem = cur % d;
+        }
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -590,10 +824,9 @@ bool lessnum(_In_ PNUMBER a, _In_ PNUMBER b)
             {
                 da = ((cdigits > (ccdigits - a->cdigit)) ? *pa-- : 0);
                 db = ((cdigits > (ccdigits - b->cdigit)) ? *pb-- : 0);
-                diff = da - db;
-                if (diff)
+                if (da != db)
                 {
-                    return (diff < 0);
+                    return (da < db);
                 }
             }
             // In this case, they are equal.
@@ -17,6 +17,7 @@
 //-----------------------------------------------------------------------------
 
 #include "ratpak.h"
+#include <cmath> // for floor, exp2
 
 using namespace std;
 
@@ -115,7 +116,7 @@ void mulrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
     }
 
 #ifdef MULGCD
-    gcdrat(pa);
+    gcdrat(pa, precision);
 #endif
 }
 
@@ -165,7 +166,7 @@ void divrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
     }
 
 #ifdef DIVGCD
-    gcdrat(pa);
+    gcdrat(pa, precision);
 #endif
 }
 
@@ -185,9 +186,11 @@ void divrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
 void subrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
 
 {
-    b->pp->sign *= -1;
+    // a - b == -(-a + b), b may be a shared constant so leave it alone.  The
+    // outer negation must not turn a - a into a negative zero.
+    (*pa)->pp->sign *= -1;
     addrat(pa, b, precision);
-    b->pp->sign *= -1;
+    (*pa)->pp->sign = zernum((*pa)->pp) ? 1 : -(*pa)->pp->sign;
 }
 
 //-----------------------------------------------------------------------------
@@ -203,11 +206,26 @@ void subrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
 //
 //-----------------------------------------------------------------------------
 
+namespace
+{
+    // Holds the cross term of addrat between calls, so its buffer is only
+    // allocated again when a larger term comes along.
+    struct CROSSTERM
+    {
+        PNUMBER pnum = nullptr;
+
+        ~CROSSTERM()
+        {
+            destroynum(pnum);
+        }
+    };
+
+    thread_local CROSSTERM t_crossterm;
+}
+
 void addrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
 
 {
-    PNUMBER bot = nullptr;
-
     if (equnum((*pa)->pq, b->pq))
     {
         // Very special case, q's match.,
@@ -216,20 +234,25 @@ void addrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
         // working with the top half of the rationals.
         (*pa)->pp->sign *= (*pa)->pq->sign;
         (*pa)->pq->sign = 1;
-        b->pp->sign *= b->pq->sign;
-        b->pq->sign = 1;
+        if (b->pq->sign != 1)
+        {
+            // Only write b when it needs it, b may be a shared constant.
+            b->pp->sign *= b->pq->sign;
+            b->pq->sign = 1;
+        }
         addnum(&((*pa)->pp), b->pp, BASEX);
     }
     else
     {
-        // Usual case q's aren't the same.
-        DUPNUM(bot, (*pa)->pq);
-        mulnumx(&bot, b->pq);
+        // Usual case q's aren't the same.  All three products fit in the
+        // buffers they are written to once those have grown, so a series
+        // adding term after term stops allocating.
+        PNUMBER& cross = t_crossterm.pnum;
+        DUPNUM(cross, (*pa)->pq);
+        mulnumx(&cross, b->pp);
         mulnumx(&((*pa)->pp), b->pq);
-        mulnumx(&((*pa)->pq), b->pp);
-        addnum(&((*pa)->pp), (*pa)->pq, BASEX);
-        destroynum((*pa)->pq);
-        (*pa)->pq = bot;
+        mulnumx(&((*pa)->pq), b->pq);
+        addnum(&((*pa)->pp), cross, BASEX);
         trimit(pa, precision);
 
         // Get rid of negative zeros here.
@@ -238,7 +261,7 @@ void addrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
     }
 
 #ifdef ADDGCD
-    gcdrat(pa);
+    gcdrat(pa, precision);
 #endif
 }
 
@@ -251,12 +274,24 @@ void addrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision)
 //
 //  RETURN: bth root of a in rat form.
 //
-//  EXPLANATION: This is now a stub function to powrat().
+//  EXPLANATION: Integer roots go to ratrooti32, anything else is a stub
+//  to powrat().
 //
 //-----------------------------------------------------------------------------
 
 void rootrat(_Inout_ PRAT* py, _In_ PRAT n, uint32_t radix, int32_t precision)
 {
+    PRAT nint = nullptr;
+    DUPRAT(nint, n);
+    intrat(&nint, radix, precision);
+    bool fintroot = rat_equ(nint, n, precision) && rat_ge(n, rat_two, precision) && rat_le(n, rat_max_i32, precision);
+    destroyrat(nint);
+    if (fintroot)
+    {
+        ratrooti32(py, rattoi32(n, radix, precision), precision);
+        return;
+    }
+
     // Initialize 1/n
     PRAT oneovern = nullptr;
     DUPRAT(oneovern, rat_one);
@@ -267,6 +302,239 @@ void rootrat(_Inout_ PRAT* py, _In_ PRAT n, uint32_t radix, int32_t precision)
     destroyrat(oneovern);
 }
 
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: sqrtrat
+//
+//  PARAMETERS: x prat representation of a nonnegative number.
+//
+//  RETURN: square root of x in rat form.
+//
+//  EXPLANATION: x is scaled by an even power of BASEX, BASEX^2e, so that
+//  its integer part n has about twice as many digits as precision asks
+//  for, and sqrt(x) = sqrt(n) / BASEX^e with the root of n taken on the
+//  mantissa by _sqrtmantx.
+//
+//-----------------------------------------------------------------------------
+
+void sqrtrat(_Inout_ PRAT* px, int32_t precision)
+{
+    if (zerrat(*px))
+    {
+        return;
+    }
+    if (SIGN(*px) < 0)
+    {
+        throw(CALC_E_DOMAIN);
+    }
+
+    PNUMBER pp = (*px)->pp;
+    PNUMBER pq = (*px)->pq;
+    int32_t digits = precision / g_ratio + 2;
+    int32_t e = digits - LOGRAT2(*px) / 2;
+
+    // n = pp * BASEX^shift / pq, shifting the denominator instead if shift
+    // comes out negative.
+    int32_t shift = pp->exp + 2 * e - pq->exp;
+    PNUMBER num = nullptr;
+    PNUMBER den = nullptr;
+    createnum(num, pp->cdigit + max(shift, 0));
+    createnum(den, pq->cdigit + max(-shift, 0));
+    num->cdigit = pp->cdigit + max(shift, 0);
+    den->cdigit = pq->cdigit + max(-shift, 0);
+    memcpy(num->mant + max(shift, 0), pp->mant, pp->cdigit * sizeof(MANTTYPE));
+    memcpy(den->mant + max(-shift, 0), pq->mant, pq->cdigit * sizeof(MANTTYPE));
+
+    PNUMBER n = nullptr;
+    createnum(n, num->cdigit - den->cdigit + 1);
+    n->cdigit = num->cdigit - den->cdigit + 1;
+    _divmantx(n->mant, nullptr, num->mant, num->cdigit, den->mant, den->cdigit);
+
+    PNUMBER root = nullptr;
+    createnum(root, (n->cdigit + 1) / 2);
+    root->cdigit = (n->cdigit + 1) / 2;
+    root->sign = 1;
+    _sqrtmantx(root->mant, nullptr, n->mant, n->cdigit);
+    while (root->cdigit > 1 && root->mant[root->cdigit - 1] == 0)
+    {
+        root->cdigit--;
+    }
+
+    destroynum(n);
+    destroynum(den);
+    destroynum(num);
+
+    destroynum((*px)->pp);
+    destroynum((*px)->pq);
+    (*px)->pp = root;
+    (*px)->pq = i32tonum(1L, BASEX);
+    if (e >= 0)
+    {
+        (*px)->pq->exp = e;
+    }
+    else
+    {
+        (*px)->pp->exp = -e;
+    }
+    trimit(px, precision);
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _exactrootnum
+//
+//  PARAMETERS: pointer to a number and the root to take.
+//
+//  RETURN: true, with the number replaced by its root, if the number is a
+//  perfect power.  false, with the number untouched, otherwise.
+//
+//-----------------------------------------------------------------------------
+
+static bool _exactrootnum(_Inout_ PNUMBER* pnum, int32_t root)
+{
+    // Fold the part of the exponent root does not divide into the mantissa.
+    PNUMBER a = *pnum;
+    int32_t shift = ((a->exp % root) + root) % root;
+    int32_t cn = a->cdigit + shift;
+    PNUMBER n = nullptr;
+    createnum(n, cn);
+    memcpy(n->mant + shift, a->mant, a->cdigit * sizeof(MANTTYPE));
+
+    int32_t cs = (cn + root - 1) / root;
+    PNUMBER s = nullptr;
+    PNUMBER r = nullptr;
+    createnum(s, cs);
+    createnum(r, cn);
+    _rootmantx(s->mant, r->mant, n->mant, cn, root);
+
+    bool fexact = all_of(r->mant, r->mant + cn, [](MANTTYPE digit) { return digit == 0; });
+    if (fexact)
+    {
+        while (cs > 1 && s->mant[cs - 1] == 0)
+        {
+            cs--;
+        }
+        s->cdigit = cs;
+        s->sign = a->sign;
+        s->exp = (a->exp - shift) / root;
+        destroynum(*pnum);
+        *pnum = s;
+    }
+    else
+    {
+        destroynum(s);
+    }
+
+    destroynum(r);
+    destroynum(n);
+    return fexact;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: ratrooti32
+//
+//  PARAMETERS: y prat representation of number to take the root of
+//              root as int32_t, at least 2.
+//
+//  RETURN: root'th root of y in rat form.
+//
+//  EXPLANATION: A perfect power over a perfect power, once their gcd is
+//  divided out, has its root taken exactly on the mantissas.  Otherwise
+//  square roots come from sqrtrat, and higher roots from Newton iteration
+//
+//       y = ((root - 1) * y + x / y^(root - 1)) / root
+//
+//  started from a double estimate, doubling the precision at each step.
+//  Odd roots of negative numbers are negative.
+//
+//-----------------------------------------------------------------------------
+
+void ratrooti32(_Inout_ PRAT* py, int32_t root, int32_t precision)
+{
+    if (zerrat(*py))
+    {
+        return;
+    }
+
+    int32_t sign = SIGN(*py);
+    if (sign < 0 && (root & 1) == 0)
+    {
+        throw(CALC_E_DOMAIN);
+    }
+    (*py)->pp->sign = 1;
+    (*py)->pq->sign = 1;
+
+    PRAT exact = nullptr;
+    DUPRAT(exact, *py);
+    gcdrat(&exact, precision);
+    if (_exactrootnum(&exact->pp, root) && _exactrootnum(&exact->pq, root))
+    {
+        DUPRAT(*py, exact);
+    }
+    else if (root == 2)
+    {
+        sqrtrat(py, precision);
+    }
+    else
+    {
+        int32_t wprecision = precision + g_ratio;
+
+        // Start from a double estimate good to a BASEX digit, as
+        // (2^31 * m) / 2^31 * BASEX^e with 1 <= m < BASEX.
+        double log2y = (_log2num((*py)->pp) - _log2num((*py)->pq)) / root;
+        int32_t e = static_cast<int32_t>(floor(log2y / BASEXPWR));
+        TWO_MANTTYPE m = static_cast<TWO_MANTTYPE>(exp2(log2y - static_cast<double>(e) * BASEXPWR + 31));
+        PRAT y = nullptr;
+        createrat(y);
+        createnum(y->pp, 2);
+        y->pp->sign = 1;
+        y->pp->mant[0] = (MANTTYPE)m;
+        y->pp->mant[1] = (MANTTYPE)(m >> BASEXPWR);
+        y->pp->cdigit = y->pp->mant[1] ? 2 : 1;
+        y->pq = Ui32tonum(1UL << 31, BASEX);
+        if (e >= 0)
+        {
+            y->pp->exp = e;
+        }
+        else
+        {
+            y->pq->exp = -e;
+        }
+
+        PRAT ratroot = i32torat(root);
+        PRAT ratrootless1 = i32torat(root - 1);
+        PRAT power = nullptr;
+        PRAT quotient = nullptr;
+        int32_t stepprecision = g_ratio;
+        bool flast = false;
+        while (!flast)
+        {
+            flast = stepprecision >= wprecision;
+            stepprecision = min(2 * stepprecision, wprecision);
+
+            DUPRAT(power, y);
+            ratpowi32(&power, root - 1, stepprecision);
+            DUPRAT(quotient, *py);
+            divrat(&quotient, power, stepprecision);
+            mulrat(&y, ratrootless1, stepprecision);
+            addrat(&y, quotient, stepprecision);
+            divrat(&y, ratroot, stepprecision);
+        }
+
+        destroyrat(quotient);
+        destroyrat(power);
+        destroyrat(ratrootless1);
+        destroyrat(ratroot);
+        destroyrat(*py);
+        *py = y;
+        trimit(py, precision);
+    }
+    destroyrat(exact);
+
+    (*py)->pp->sign = sign;
+}
+
 //-----------------------------------------------------------------------------
 //
 //    FUNCTION: zerrat
@@ -23,10 +23,11 @@
 #include <cstring> // for memmove
 #include "sal_cross_platform.h"   // for SAL
 
-static constexpr uint32_t BASEXPWR = 31L;     // Internal log2(BASEX)
-static constexpr uint32_t BASEX = 0x80000000; // Internal radix used in calculations, hope to raise
-                                              // this to 2^32 after solving scaling problems with
-                                              // overflow detection esp. in mul
+static constexpr uint32_t BASEXPWR = 32L;      // Internal log2(BASEX)
+static constexpr uint64_t BASEX = 0x100000000; // Internal radix used in calculations, a digit is a
+                                               // full MANTTYPE so it does not fit in a uint32_t
+                                               // radix, functions that can be handed BASEX take
+                                               // the radix as a uint64_t.
 
 typedef uint32_t MANTTYPE;
 typedef uint64_t TWO_MANTTYPE;
@@ -47,8 +48,22 @@ enum eANGLE_TYPE
 
 };
 
+enum eSERIES_TYPE
+{
+    SERIES_EXP,   // exp(x)
+    SERIES_SIN,   // sin(x)
+    SERIES_COS,   // cos(x)
+    SERIES_SINH,  // sinh(x)
+    SERIES_COSH,  // cosh(x)
+    SERIES_ASIN,  // asin(x), abs(x) < 1
+    SERIES_ASINH, // asinh(x), abs(x) < 1
+    SERIES_ATAN,  // atan(x), abs(x) < 1
+    SERIES_ATANH  // atanh(x), abs(x) < 1
+};
+
 typedef enum eNUMOBJ_FMT NUMOBJ_FMT;
 typedef enum eANGLE_TYPE ANGLE_TYPE;
+typedef enum eSERIES_TYPE SERIES_TYPE;
 
 //-----------------------------------------------------------------------------
 //
@@ -56,19 +71,46 @@ typedef enum eANGLE_TYPE ANGLE_TYPE;
 //
 //-----------------------------------------------------------------------------
 
+typedef struct _number
+{
+    int32_t sign;      // The sign of the mantissa, +1, or -1
+    int32_t cdigit;    // The number of digits, or what passes for digits in the
+                       // radix being used.
+    int32_t exp;       // The offset of digits from the radix point
+                       // (decimal point in radix 10)
+    int32_t cdigitmax; // The number of digits the buffer has room for, results
+                       // that fit are written in place.
+    MANTTYPE* mant;
+    // The buffer is allocated as a continuation of the NUMBER structure,
+    // mant points into it.  Trimming low digits moves mant up rather than
+    // moving the digits down, the buffer is compacted again by whatever
+    // next writes a result to it that needs the room.
+} NUMBER, *PNUMBER, **PPNUMBER;
+
+// MANTBASE is the start of the buffer of a number.
+#define MANTBASE(x) ((MANTTYPE*)((x) + 1))
+
+// TRIMLOW moves the n least significant digits of a number into its
+// exponent, dropping them.
+#define TRIMLOW(x, n)                                                                                                                                          \
+    {                                                                                                                                                          \
+        int32_t ctrim = (n);                                                                                                                                   \
+        (x)->mant += ctrim;                                                                                                                                    \
+        (x)->cdigit -= ctrim;                                                                                                                                  \
+        (x)->exp += ctrim;                                                                                                                                     \
+    }
+
+// RAWNUMBER lays a number out with its digits inline, the way the constants
+// in ratconst.h are written.
 #pragma warning(push)
 #pragma warning(disable : 4200) // nonstandard extension used : zero-sized array in struct/union
-typedef struct _number
+typedef struct _rawnumber
 {
-    int32_t sign;   // The sign of the mantissa, +1, or -1
-    int32_t cdigit; // The number of digits, or what passes for digits in the
-                    // radix being used.
-    int32_t exp;    // The offset of digits from the radix point
-                    // (decimal point in radix 10)
+    int32_t sign;
+    int32_t cdigit;
+    int32_t exp;
     MANTTYPE mant[];
-    // This is actually allocated as a continuation of the
-    // NUMBER structure.
-} NUMBER, *PNUMBER, **PPNUMBER;
+} RAWNUMBER;
 #pragma warning(pop)
 
 //-----------------------------------------------------------------------------
@@ -84,8 +126,142 @@ typedef struct _rat
     PNUMBER pq;
 } RAT, *PRAT;
 
+//-----------------------------------------------------------------------------
+//
+//  POOLSTATS counts the allocator traffic of _createnum/_createrat for the
+//  calling thread.  A hit is a request served from the freelists rather than
+//  the heap.  Building with RATPAK_NO_POOL turns the freelists off, every
+//  request then goes to the heap but the counters are still kept.
+//
+//-----------------------------------------------------------------------------
+
+typedef struct _poolstats
+{
+    uint64_t cnumcreate; // Calls to _createnum
+    uint64_t cnumhit;    // of which were served from a freelist
+    uint64_t cratcreate; // Calls to _createrat
+    uint64_t crathit;    // of which were served from a freelist
+    uint64_t cheapalloc; // Blocks allocated from the heap
+    uint64_t cheapfree;  // Blocks returned to the heap
+} POOLSTATS;
+
+//-----------------------------------------------------------------------------
+//
+//  RATCONSTANTS holds the constants that depend on the radix and precision.
+//  getconstants builds one set per (radix, precision) the first time it is
+//  asked for, after that the set is shared and never changed, so it can be
+//  read from any thread.  ChangeConstants points the globals of the same
+//  names at a set.
+//
+//-----------------------------------------------------------------------------
+
+typedef struct _ratconstants
+{
+    uint32_t radix;
+    int32_t precision;
+    int32_t ratio; // g_ratio for radix
+    PRAT rat_nRadix;
+    PRAT rat_smallest;
+    PRAT rat_negsmallest;
+    PRAT pi;
+    PRAT two_pi;
+    PRAT pi_over_two;
+    PRAT one_pt_five_pi;
+    PRAT e_to_one_half;
+    PRAT rat_exp;
+    PRAT ln_ten;
+    PRAT ln_two;
+    PRAT rad_to_deg;
+    PRAT rad_to_grad;
+} RATCONSTANTS;
+
+//-----------------------------------------------------------------------------
+//
+//  RATPAKCONTEXT is the state the math package works in: the constant set
+//  for the radix and precision, the decimal separator, whether numbers are
+//  trimmed and whether RationalMath evaluates adaptively.  Each thread has a
+//  context of its own, set up by ChangeConstants and SetDecimalSeparator, so
+//  calculations on different threads do not interfere.  A caller that
+//  switches between several contexts on one thread saves them with
+//  getratpakcontext and puts them back with setratpakcontext.
+//
+//-----------------------------------------------------------------------------
+
+typedef struct _ratpakcontext
+{
+    const RATCONSTANTS* constants; // nullptr until ChangeConstants is first called
+    wchar_t decimalSeparator;
+    bool ftrueinfinite;
+    bool fadaptive;
+} RATPAKCONTEXT;
+
+//-----------------------------------------------------------------------------
+//
+//  POWWINDOW is one step of left to right sliding window exponentiation:
+//  square the result csquare times, then multiply it by root^odd.  odd is
+//  zero for a step of squarings only.  _powwindows splits a power into these
+//  steps.
+//
+//-----------------------------------------------------------------------------
+
+typedef struct _powwindow
+{
+    int32_t csquare;
+    uint32_t odd;
+} POWWINDOW;
+
+static constexpr int32_t MAX_POW_WINDOWS = 33; // A window per bit, and the trailing squarings
+
 static constexpr uint32_t MAX_LONG_SIZE = 33; // Base 2 requires 32 'digits'
 
+// Default sizes, in BASEX digits, at which mantissa multiplication switches
+// from schoolbook to Karatsuba and from Karatsuba to Toom-3.
+static constexpr int32_t KARATSUBA_THRESHOLD = 32;
+static constexpr int32_t TOOM3_THRESHOLD = 256;
+
+// Default size, in BASEX digits, at which mantissa multiplication switches
+// to the number theoretic transform.
+static constexpr int32_t NTT_THRESHOLD = 4096;
+
+// Default size, in BASEX digits, at which mantissa division switches from
+// schoolbook to Newton reciprocal division.
+static constexpr int32_t NEWTON_DIV_THRESHOLD = 768;
+
+// Default size, in digits of the radix, of both the divisor and the quotient
+// at which division in a radix other than BASEX is done in BASEX instead.
+static constexpr int32_t RADIX_DIV_THRESHOLD = 16;
+
+// Default size, in BASEX digits, at which gcd switches from Lehmer steps to
+// the half gcd.
+static constexpr int32_t HGCD_THRESHOLD = 6144;
+
+// Default size, in BASEX digits, at which conversion out of and into BASEX
+// switches from digit at a time to divide and conquer.
+static constexpr int32_t RADIX_CONV_THRESHOLD = 96;
+
+// Default precision, in BASEX digits, at which the Taylor series switch to
+// binary splitting, and the longest numerator or denominator, in BASEX
+// digits, of an argument that binary splitting takes.
+static constexpr int32_t SPLIT_THRESHOLD = 2;
+static constexpr int32_t SPLIT_MAX_ARG_DIGITS = 4;
+
+// Default precision, in BASEX digits, at which exp, sin and cos reduce their
+// argument and undo the reduction with squaring or multiple angle formulas.
+static constexpr int32_t REDUCE_THRESHOLD = 8;
+
+// Default precision, in BASEX digits, at which lograt switches from the
+// Taylor series to the arithmetic-geometric mean.
+static constexpr int32_t LOG_AGM_THRESHOLD = 12;
+
+// BASEX digits of x - 1 below the unit at which lograt keeps the Taylor
+// series at any precision, where the absolute error of the AGM would swamp
+// the small result.
+static constexpr int32_t LOG_NEAR_ONE_DIGITS = 1;
+
+// Digits, in BASEX digits, that the reduction of large arguments by 2 pi
+// carries past the precision.
+static constexpr int32_t REDUCE_2PI_GUARD = 2;
+
 //-----------------------------------------------------------------------------
 //
 // List of useful constants for evaluation, note this list needs to be
@@ -99,8 +275,6 @@ extern PNUMBER num_five;
 extern PNUMBER num_six;
 extern PNUMBER num_ten;
 
-extern PRAT ln_ten;
-extern PRAT ln_two;
 extern PRAT rat_zero;
 extern PRAT rat_neg_one;
 extern PRAT rat_one;
@@ -109,14 +283,6 @@ extern PRAT rat_six;
 extern PRAT rat_half;
 extern PRAT rat_ten;
 extern PRAT pt_eight_five;
-extern PRAT pi;
-extern PRAT pi_over_two;
-extern PRAT two_pi;
-extern PRAT one_pt_five_pi;
-extern PRAT e_to_one_half;
-extern PRAT rat_exp;
-extern PRAT rad_to_deg;
-extern PRAT rad_to_grad;
 extern PRAT rat_qword;
 extern PRAT rat_dword;
 extern PRAT rat_word;
@@ -125,9 +291,6 @@ extern PRAT rat_360;
 extern PRAT rat_400;
 extern PRAT rat_180;
 extern PRAT rat_200;
-extern PRAT rat_nRadix;
-extern PRAT rat_smallest;
-extern PRAT rat_negsmallest;
 extern PRAT rat_max_exp;
 extern PRAT rat_min_exp;
 extern PRAT rat_max_fact;
@@ -135,10 +298,30 @@ extern PRAT rat_min_fact;
 extern PRAT rat_max_i32;
 extern PRAT rat_min_i32;
 
-// DUPNUM Duplicates a number taking care of allocation and internals
+// The constants that depend on the radix and precision are those of the
+// calling thread's context, see RATPAKCONTEXT.
+extern thread_local PRAT ln_ten;
+extern thread_local PRAT ln_two;
+extern thread_local PRAT pi;
+extern thread_local PRAT pi_over_two;
+extern thread_local PRAT two_pi;
+extern thread_local PRAT one_pt_five_pi;
+extern thread_local PRAT e_to_one_half;
+extern thread_local PRAT rat_exp;
+extern thread_local PRAT rad_to_deg;
+extern thread_local PRAT rad_to_grad;
+extern thread_local PRAT rat_nRadix;
+extern thread_local PRAT rat_smallest;
+extern thread_local PRAT rat_negsmallest;
+
+// DUPNUM Duplicates a number taking care of allocation and internals, the
+// buffer already held by a is reused when b fits in it.
 #define DUPNUM(a, b)                                                                                                                                           \
-    destroynum(a);                                                                                                                                             \
-    createnum(a, (b)->cdigit);                                                                                                                                 \
+    if ((a) == nullptr || (a)->cdigitmax < (b)->cdigit)                                                                                                        \
+    {                                                                                                                                                          \
+        destroynum(a);                                                                                                                                         \
+        createnum(a, (b)->cdigit);                                                                                                                             \
+    }                                                                                                                                                          \
     _dupnum(a, b);
 
 // DUPRAT Duplicates a rational taking care of allocation and internals
@@ -233,9 +416,7 @@ extern PRAT rat_min_i32;
         int32_t trim = (x)->cdigit - precision - g_ratio;                                                                                                      \
         if (trim > 1)                                                                                                                                          \
         {                                                                                                                                                      \
-            memmove((x)->mant, &((x)->mant[trim]), sizeof(MANTTYPE) * ((x)->cdigit - trim));                                                                   \
-            (x)->cdigit -= trim;                                                                                                                               \
-            (x)->exp += trim;                                                                                                                                  \
+            TRIMLOW(x, trim);                                                                                                                                  \
         }                                                                                                                                                      \
     }
 // TRIMTOP ASSUMES the number is in INTERNAL BASEX!!!
@@ -245,9 +426,7 @@ extern PRAT rat_min_i32;
         int32_t trim = (x)->pp->cdigit - (precision / g_ratio) - 2;                                                                                            \
         if (trim > 1)                                                                                                                                          \
         {                                                                                                                                                      \
-            memmove((x)->pp->mant, &((x)->pp->mant[trim]), sizeof(MANTTYPE) * ((x)->pp->cdigit - trim));                                                       \
-            (x)->pp->cdigit -= trim;                                                                                                                           \
-            (x)->pp->exp += trim;                                                                                                                              \
+            TRIMLOW((x)->pp, trim);                                                                                                                            \
         }                                                                                                                                                      \
         trim = std::min((x)->pp->exp, (x)->pq->exp);                                                                                                           \
         (x)->pp->exp -= trim;                                                                                                                                  \
@@ -263,6 +442,10 @@ extern PRAT rat_min_i32;
 //
 //-----------------------------------------------------------------------------
 
+// TAYLORDIGITS is room enough for the sum of a series to be updated in place,
+// it holds the product of two numbers trimit has cut to precision.
+#define TAYLORDIGITS(precision) (2 * ((precision) / g_ratio + 2))
+
 #define CREATETAYLOR()                                                                                                                                         \
     PRAT xx = nullptr;                                                                                                                                         \
     PNUMBER n2 = nullptr;                                                                                                                                      \
@@ -272,7 +455,9 @@ extern PRAT rat_min_i32;
     mulrat(&xx, *px, precision);                                                                                                                               \
     createrat(pret);                                                                                                                                           \
     pret->pp = i32tonum(0L, BASEX);                                                                                                                            \
-    pret->pq = i32tonum(0L, BASEX);
+    pret->pq = i32tonum(0L, BASEX);                                                                                                                            \
+    reservenum(&(pret->pp), TAYLORDIGITS(precision));                                                                                                          \
+    reservenum(&(pret->pq), TAYLORDIGITS(precision));
 
 #define DESTROYTAYLOR()                                                                                                                                        \
     destroynum(n2);                                                                                                                                            \
@@ -319,11 +504,25 @@ extern PRAT rat_min_i32;
 //
 //-----------------------------------------------------------------------------
 
-extern bool g_ftrueinfinite; // set to true to allow infinite precision
-                             // don't use unless you know what you are doing
-                             // used to help decide when to stop calculating.
-
-extern int32_t g_ratio; // Internally calculated ratio of internal radix
+extern thread_local bool g_ftrueinfinite; // set to true to allow infinite precision
+                                          // don't use unless you know what you are doing
+                                          // used to help decide when to stop calculating.
+extern thread_local bool g_fadaptive; // set to true to let RationalMath evaluate functions
+                                      // at the precision of the constants first
+
+extern thread_local int32_t g_ratio; // Internally calculated ratio of internal radix
+extern thread_local wchar_t g_decimalSeparator; // Decimal separator of the number strings
+
+extern int32_t g_karatsubaThreshold; // Mantissa size at which Karatsuba multiplication is used
+extern int32_t g_toom3Threshold;     // Mantissa size at which Toom-3 multiplication is used
+extern int32_t g_nttThreshold;       // Mantissa size at which NTT multiplication is used
+extern int32_t g_newtonDivThreshold; // Mantissa size at which Newton division is used
+extern int32_t g_radixDivThreshold;  // Mantissa size at which division in radix is done in BASEX
+extern int32_t g_hgcdThreshold;      // Mantissa size at which half gcd is used
+extern int32_t g_radixConvThreshold; // Mantissa size at which radix conversion divides and conquers
+extern int32_t g_splitThreshold;     // Precision at which Taylor series use binary splitting
+extern int32_t g_reduceThreshold;    // Precision at which exp, sin and cos reduce their argument
+extern int32_t g_logAgmThreshold;    // Precision at which lograt uses the AGM
 
 //-----------------------------------------------------------------------------
 //
@@ -331,12 +530,20 @@ extern int32_t g_ratio; // Internally calculated ratio of internal radix
 //
 //-----------------------------------------------------------------------------
 
-// Call whenever decimal separator character changes.
+// Call whenever decimal separator character changes, applies to the calling thread.
 extern void SetDecimalSeparator(wchar_t decimalSeparator);
 
-// Call whenever either radix or precision changes, is smarter about recalculating constants.
+// Call whenever either radix or precision changes, constants are only calculated
+// the first time a radix and precision is used.  Applies to the calling thread.
 extern void ChangeConstants(uint32_t radix, int32_t precision);
 
+// Returns the shared, immutable constants for radix and precision.
+extern const RATCONSTANTS* getconstants(uint32_t radix, int32_t precision);
+
+// Returns and replaces the context of the calling thread.
+extern RATPAKCONTEXT getratpakcontext();
+extern void setratpakcontext(const RATPAKCONTEXT& context);
+
 extern bool equnum(_In_ PNUMBER a, _In_ PNUMBER b);  // returns true of a == b
 extern bool lessnum(_In_ PNUMBER a, _In_ PNUMBER b); // returns true of a < b
 extern bool zernum(_In_ PNUMBER a);                  // returns true of a == 0
@@ -345,12 +552,16 @@ extern std::wstring NumberToString(_Inout_ PNUMBER& pnum, int format, uint32_t r
 
 // returns a text representation of a PRAT
 extern std::wstring RatToString(_Inout_ PRAT& prat, int format, uint32_t radix, int32_t precision);
+// returns the text of a PRAT divided out in BASEX, cheaper but not always the last digit of RatToString
+extern std::wstring RatToStringx(_In_ PRAT prat, int format, uint32_t radix, int32_t precision);
 // converts a PRAT into a PNUMBER
 extern PNUMBER RatToNumber(_In_ PRAT prat, uint32_t radix, int32_t precision);
+// divides out a PRAT in BASEX to about cdigit digits, from the leading digits of p and q only
+extern PNUMBER RatToNumberx(_In_ PRAT prat, int32_t cdigit);
 // flattens a PRAT by converting it to a PNUMBER and back to a PRAT
 extern void flatrat(_Inout_ PRAT& prat, uint32_t radix, int32_t precision);
 
-extern int32_t numtoi32(_In_ PNUMBER pnum, uint32_t radix);
+extern int32_t numtoi32(_In_ PNUMBER pnum, uint64_t radix);
 extern int32_t rattoi32(_In_ PRAT prat, uint32_t radix, int32_t precision);
 uint64_t rattoUi64(_In_ PRAT prat, uint32_t radix, int32_t precision);
 extern PNUMBER _createnum(_In_ uint32_t size); // returns an empty number structure with size digits
@@ -366,9 +577,11 @@ extern PRAT
 StringToRat(bool mantissaIsNegative, std::wstring_view mantissa, bool exponentIsNegative, std::wstring_view exponent, uint32_t radix, int32_t precision);
 
 extern PNUMBER i32factnum(int32_t ini32, uint32_t radix);
+extern PNUMBER i32factnumx(int32_t ini32);
 extern PNUMBER i32prodnum(int32_t start, int32_t stop, uint32_t radix);
-extern PNUMBER i32tonum(int32_t ini32, uint32_t radix);
-extern PNUMBER Ui32tonum(uint32_t ini32, uint32_t radix);
+extern PNUMBER i32prodnumx(int32_t start, int32_t stop);
+extern PNUMBER i32tonum(int32_t ini32, uint64_t radix);
+extern PNUMBER Ui32tonum(uint32_t ini32, uint64_t radix);
 extern PNUMBER numtonRadixx(_In_ PNUMBER a, uint32_t radix);
 
 // creates a empty/undefined rational representation (p/q)
@@ -417,6 +630,13 @@ extern void cosanglerat(_Inout_ PRAT* px, ANGLE_TYPE angletype, uint32_t radix,
 // returns a new rat structure with the exp of x->p/x->q this should not be called explicitly.
 extern void _exprat(_Inout_ PRAT* px, int32_t precision);
 
+// returns a new rat structure with the asin of x->p/x->q, abs(x) <= 0.85, this should not be called explicitly.
+extern void _asinrat(_Inout_ PRAT* px, int32_t precision);
+
+// evaluates the series in x->p/x->q by binary splitting, x->p and x->q need to be short.
+extern bool _usesplitrat(_In_ PRAT x, int32_t precision);
+extern void _splitrat(_Inout_ PRAT* px, SERIES_TYPE series, int32_t precision);
+
 // returns a new rat structure with the exp of x->p/x->q
 extern void exprat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 
@@ -425,6 +645,12 @@ extern void log10rat(_Inout_ PRAT* px, int32_t precision);
 
 // returns a new rat structure with the natural log of x->p/x->q
 extern void lograt(_Inout_ PRAT* px, int32_t precision);
+extern void _logagmrat(_Inout_ PRAT* px, int32_t precision);
+
+// returns a new rat structure with the gamma of x->p/x->q > 0, by the Taylor
+// series and by Spouge's approximation with cached coefficients
+extern void _gamma(_Inout_ PRAT* pn, uint32_t radix, int32_t precision);
+extern void _gammaspouge(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 
 extern PRAT i32torat(int32_t ini32);
 extern PRAT Ui32torat(uint32_t inui32);
@@ -445,13 +671,18 @@ extern void tanrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
 extern void tananglerat(_Inout_ PRAT* px, ANGLE_TYPE angletype, uint32_t radix, int32_t precision);
 
 extern void _dupnum(_In_ PNUMBER dest, _In_ const NUMBER* const src);
+extern void reservenum(_Inout_ PNUMBER* pa, int32_t cdigit); // makes room for cdigit digits in *pa keeping its value
+extern PNUMBER rawtonum(_In_ const RAWNUMBER* praw);
 
 extern void _destroynum(_Frees_ptr_opt_ PNUMBER pnum);
 extern void _destroyrat(_Frees_ptr_opt_ PRAT prat);
-extern void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
+extern void getpoolstats(_Out_ POOLSTATS* pstats);
+extern void resetpoolstats();
+extern void trimpool();
+extern void addnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix);
 extern void addrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void andrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
-extern void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix, int32_t precision);
+extern void divnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix, int32_t precision);
 extern void divnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b, int32_t precision);
 extern void divrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void fracrat(_Inout_ PRAT* pa, uint32_t radix, int32_t precision);
@@ -460,24 +691,41 @@ extern void remrat(_Inout_ PRAT* pa, _In_ PRAT b);
 extern void modrat(_Inout_ PRAT* pa, _In_ PRAT b);
 extern void gcdrat(_Inout_ PRAT* pa, int32_t precision);
 extern void intrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
-extern void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
+extern void mulnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix);
 extern void mulnumx(_Inout_ PNUMBER* pa, _In_ PNUMBER b);
+extern void _mulmantx(_Out_ MANTTYPE* pc, _In_ const MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb);
+extern void _mulmantntt(_Out_ MANTTYPE* pc, _In_ const MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb);
+extern bool _fitsntt(int32_t cc);
+extern void _divmantx(_Out_ MANTTYPE* pq, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, _In_ const MANTTYPE* pb, int32_t cb);
+extern void _divmantbase(_Out_ MANTTYPE* pq, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, _In_ const MANTTYPE* pb, int32_t cb, uint64_t radix);
+extern bool _divmantradix(_Out_ MANTTYPE* pq, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, _In_ const MANTTYPE* pb, int32_t cb, uint32_t radix);
+extern int32_t _gcdmantx(_Inout_ MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb);
+extern void _divnumtrunc(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix, int32_t thismax);
+extern MANTTYPE _addmant(_Inout_ MANTTYPE* pc, int32_t cc, _In_ const MANTTYPE* pb, int32_t cb);
+extern MANTTYPE _submant(_Inout_ MANTTYPE* pc, int32_t cc, _In_ const MANTTYPE* pb, int32_t cb);
+extern int32_t _cmpmant(_In_ const MANTTYPE* pa, int32_t ca, _In_ const MANTTYPE* pb, int32_t cb);
+extern void _sqrtmantx(_Out_ MANTTYPE* ps, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn);
+extern void _rootmantx(_Out_ MANTTYPE* ps, _Out_opt_ MANTTYPE* pr, _In_ const MANTTYPE* pn, int32_t cn, int32_t root);
 extern void mulrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
-extern void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint32_t radix, int32_t precision);
+extern void numpowi32(_Inout_ PNUMBER* proot, int32_t power, uint64_t radix, int32_t precision);
 extern void numpowi32x(_Inout_ PNUMBER* proot, int32_t power);
 extern void orrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powratNumeratorDenominator(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void powratcomp(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void ratpowi32(_Inout_ PRAT* proot, int32_t power, int32_t precision);
-extern void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint32_t radix);
+extern void remnum(_Inout_ PNUMBER* pa, _In_ PNUMBER b, uint64_t radix);
 extern void rootrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
+extern void sqrtrat(_Inout_ PRAT* pa, int32_t precision);
+extern void ratrooti32(_Inout_ PRAT* proot, int32_t root, int32_t precision);
 extern void scale2pi(_Inout_ PRAT* px, uint32_t radix, int32_t precision);
+extern int32_t _twopidigits();
 extern void scale(_Inout_ PRAT* px, _In_ PRAT scalefact, uint32_t radix, int32_t precision);
 extern void subrat(_Inout_ PRAT* pa, _In_ PRAT b, int32_t precision);
 extern void xorrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void lshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
 extern void rshrat(_Inout_ PRAT* pa, _In_ PRAT b, uint32_t radix, int32_t precision);
+extern int32_t ratcmp(_In_ PRAT a, _In_ PRAT b); // returns -1, 0 or 1 as a < b, a == b or a > b
 extern bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_neq(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t precision);
@@ -485,6 +733,11 @@ extern bool rat_ge(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_lt(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern bool rat_le(_In_ PRAT a, _In_ PRAT b, int32_t precision);
 extern void inbetween(_In_ PRAT* px, _In_ PRAT range, int32_t precision);
+extern double _log2num(_In_ PNUMBER a);
+extern int32_t _powwindows(uint32_t power, _Out_ POWWINDOW* windows, _Out_ int32_t* pwindow);
+extern int32_t _reducesteps(_In_ PRAT x, uint32_t factor, int32_t precision);
+extern void _reducerat(_Inout_ PRAT* px, uint32_t factor, int32_t steps);
+extern int32_t _reduceguard(int32_t bits);
 extern void trimit(_Inout_ PRAT* px, int32_t precision);
 extern void _dumprawrat(_In_ const wchar_t* varname, _In_ PRAT rat, std::wostream& out);
 extern void _dumprawnum(_In_ const wchar_t* varname, _In_ PNUMBER num, std::wostream& out);
@@ -0,0 +1,305 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//-----------------------------------------------------------------------------
+//  Package Title  ratpak
+//  File           series.cpp
+//
+//
+//  Description
+//
+//     Contains binary splitting evaluation of the Taylor series used by the
+//  transcendental functions, for arguments x = u/v where u and v are short.
+//
+//     Every one of those series has the form
+//
+//             n    k
+//            ___  ___
+//            \  ] | | p(j)
+//     S  =    \   | | ----
+//             /   | | q(j)
+//            /__] j=1
+//            k=0
+//
+//  with p(j) and q(j) integers, u or u^2 times a small polynomial in j and v
+//  or v^2 times another.  Over a range of terms [n1, n2) the partial products
+//  P = p(n1)...p(n2-1), Q = q(n1)...q(n2-1) and the partial sum T = Q * S are
+//  integers, and two adjacent ranges combine as
+//
+//     P = Pl * Pr,   Q = Ql * Qr,   T = Tl * Qr + Pl * Tr
+//
+//  so splitting the terms in half recursively turns the series into a
+//  balanced tree of multiplications of integers of about equal size, which
+//  the fast multiply handles in quasi linear time.  Nothing is trimmed until
+//  the final T/Q, which is exact for the n terms summed.
+//
+//-----------------------------------------------------------------------------
+#include "ratpak.h"
+#include <cmath>
+
+using namespace std;
+
+// Precision, in BASEX digits, at which the series functions switch from
+// term by term Taylor evaluation to binary splitting.
+int32_t g_splitThreshold = SPLIT_THRESHOLD;
+
+namespace
+{
+    typedef uint64_t (*SPLITPOLY)(uint64_t j);
+
+    // p(j) = p * pj(j) and q(j) = q * qj(j), p carries the sign.
+    typedef struct _splitseries
+    {
+        PNUMBER p;
+        PNUMBER q;
+        SPLITPOLY pj;
+        SPLITPOLY qj;
+        bool fmulx; // The sum is multiplied by x
+    } SPLITSERIES;
+
+    uint64_t one(uint64_t)
+    {
+        return 1;
+    }
+
+    uint64_t identity(uint64_t j)
+    {
+        return j;
+    }
+
+    uint64_t odd(uint64_t j)
+    {
+        return 2 * j - 1;
+    }
+
+    uint64_t nextodd(uint64_t j)
+    {
+        return 2 * j + 1;
+    }
+
+    uint64_t oddsquared(uint64_t j)
+    {
+        return (2 * j - 1) * (2 * j - 1);
+    }
+
+    uint64_t sinfactor(uint64_t j)
+    {
+        return (2 * j) * (2 * j + 1);
+    }
+
+    uint64_t cosfactor(uint64_t j)
+    {
+        return (2 * j - 1) * (2 * j);
+    }
+
+    PNUMBER ui64tonum(uint64_t value)
+    {
+        PNUMBER pnum = nullptr;
+        createnum(pnum, 2);
+        pnum->sign = 1;
+        pnum->exp = 0;
+        pnum->mant[0] = (MANTTYPE)value;
+        pnum->mant[1] = (MANTTYPE)(value >> BASEXPWR);
+        pnum->cdigit = pnum->mant[1] ? 2 : 1;
+        return pnum;
+    }
+
+    // Computes P, Q and T over the terms [n1, n2), pP can be nullptr when
+    // the caller has no use for P.
+    void split(const SPLITSERIES& s, uint64_t n1, uint64_t n2, PNUMBER* pP, PNUMBER* pQ, PNUMBER* pT)
+    {
+        if (n2 - n1 == 1)
+        {
+            PNUMBER p = ui64tonum(s.pj(n1));
+            mulnumx(&p, s.p);
+            *pQ = ui64tonum(s.qj(n1));
+            mulnumx(pQ, s.q);
+            *pT = nullptr;
+            DUPNUM(*pT, p);
+            if (pP != nullptr)
+            {
+                *pP = p;
+            }
+            else
+            {
+                destroynum(p);
+            }
+            return;
+        }
+
+        uint64_t m = n1 + (n2 - n1) / 2;
+        PNUMBER pl = nullptr;
+        PNUMBER ql = nullptr;
+        PNUMBER tl = nullptr;
+        PNUMBER pr = nullptr;
+        PNUMBER qr = nullptr;
+        PNUMBER tr = nullptr;
+        split(s, n1, m, &pl, &ql, &tl);
+        split(s, m, n2, pP != nullptr ? &pr : nullptr, &qr, &tr);
+
+        // T = Tl * Qr + Pl * Tr
+        mulnumx(&tl, qr);
+        mulnumx(&tr, pl);
+        addnum(&tl, tr, BASEX);
+        destroynum(tr);
+        *pT = tl;
+
+        mulnumx(&ql, qr);
+        destroynum(qr);
+        *pQ = ql;
+
+        if (pP != nullptr)
+        {
+            mulnumx(&pl, pr);
+            destroynum(pr);
+            *pP = pl;
+        }
+        else
+        {
+            destroynum(pl);
+        }
+    }
+
+    // Sets up the series for x, p and q still have to be destroyed.
+    SPLITSERIES makeseries(PRAT x, SERIES_TYPE series)
+    {
+        SPLITSERIES s{ nullptr, nullptr, one, one, false };
+        DUPNUM(s.p, x->pp);
+        DUPNUM(s.q, x->pq);
+        s.p->sign *= s.q->sign;
+        s.q->sign = 1;
+
+        if (series != SERIES_EXP)
+        {
+            mulnumx(&s.p, s.p);
+            mulnumx(&s.q, s.q);
+        }
+
+        switch (series)
+        {
+        case SERIES_EXP:
+            s.qj = identity;
+            break;
+        case SERIES_SIN:
+        case SERIES_SINH:
+            s.qj = sinfactor;
+            s.fmulx = true;
+            break;
+        case SERIES_COS:
+        case SERIES_COSH:
+            s.qj = cosfactor;
+            break;
+        case SERIES_ASIN:
+        case SERIES_ASINH:
+            s.pj = oddsquared;
+            s.qj = sinfactor;
+            s.fmulx = true;
+            break;
+        case SERIES_ATAN:
+        case SERIES_ATANH:
+            s.pj = odd;
+            s.qj = nextodd;
+            s.fmulx = true;
+            break;
+        }
+
+        if (series == SERIES_SIN || series == SERIES_COS || series == SERIES_ASINH || series == SERIES_ATAN)
+        {
+            s.p->sign = -1;
+        }
+        return s;
+    }
+
+    // Number of terms to sum for the remaining terms to be below precision.
+    uint64_t countterms(const SPLITSERIES& s, int32_t precision)
+    {
+        const double lp = _log2num(s.p) - _log2num(s.q);
+        const double target = -static_cast<double>(BASEXPWR) * (precision / g_ratio + 2);
+        double logterm = 0;
+        uint64_t n = 1;
+        for (;; n++)
+        {
+            double logratio = lp + log2(static_cast<double>(s.pj(n))) - log2(static_cast<double>(s.qj(n)));
+            logterm += logratio;
+
+            // The ratios only shrink from here on, so once a term is below
+            // precision and falling the rest of the series is too.
+            if (logterm < target && logratio < 0)
+            {
+                break;
+            }
+        }
+        return n;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _usesplitrat
+//
+//  ARGUMENTS: x PRAT, precision
+//
+//  RETURN: true if a series in x is faster by binary splitting.
+//
+//  DESCRIPTION: Binary splitting pays off when the precision is high and the
+//  numerator and denominator of x are short next to it.
+//
+//-----------------------------------------------------------------------------
+
+bool _usesplitrat(_In_ PRAT x, int32_t precision)
+{
+    return !zernum(x->pp) && precision / g_ratio >= g_splitThreshold && LOGNUM2(x->pp) <= SPLIT_MAX_ARG_DIGITS
+           && LOGNUM2(x->pq) <= SPLIT_MAX_ARG_DIGITS;
+}
+
+//-----------------------------------------------------------------------------
+//
+//  FUNCTION: _splitrat
+//
+//  ARGUMENTS: x PRAT, which series to evaluate in x, precision
+//
+//  RETURN: the series in PRAT form, replacing x.
+//
+//  DESCRIPTION: Evaluates the Taylor series by binary splitting.  x must be
+//  nonzero and the inverse function series need abs(x) below one, as for
+//  the term by term versions.  Works at any precision, _usesplitrat tells
+//  when it is the faster choice.
+//
+//-----------------------------------------------------------------------------
+
+void _splitrat(_Inout_ PRAT* px, SERIES_TYPE series, int32_t precision)
+{
+    SPLITSERIES s = makeseries(*px, series);
+    uint64_t n = countterms(s, precision);
+
+    PRAT pret = nullptr;
+    createrat(pret);
+    if (n > 1)
+    {
+        PNUMBER t = nullptr;
+        split(s, 1, n, nullptr, &(pret->pq), &t);
+
+        // S = 1 + T/Q
+        pret->pp = nullptr;
+        DUPNUM(pret->pp, pret->pq);
+        addnum(&(pret->pp), t, BASEX);
+        destroynum(t);
+    }
+    else
+    {
+        pret->pp = i32tonum(1L, BASEX);
+        pret->pq = i32tonum(1L, BASEX);
+    }
+
+    if (s.fmulx)
+    {
+        mulnumx(&(pret->pp), (*px)->pp);
+        mulnumx(&(pret->pq), (*px)->pq);
+    }
+
+    destroynum(s.p);
+    destroynum(s.q);
+    destroyrat(*px);
+    trimit(&pret, precision);
+    *px = pret;
+}
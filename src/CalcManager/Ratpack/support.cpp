@@ -19,22 +19,24 @@
 //----------------------------------------------------------------------------
 
 #include <string>
-#include <cstring>  // for memmove
 #include <iostream> // for wostream
+#include <cmath>    // for log2, sqrt
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "ratpak.h"
 
 using namespace std;
 
-void _readconstants(void);
-
 #if defined(GEN_CONST)
-static int cbitsofprecision = 0;
-#define READRAWRAT(v)
-#define READRAWNUM(v)
+static constexpr int cbitsofprecision = 0;
+#define READRAWCONST(pc, v)
 #define DUMPRAWRAT(v) _dumprawrat(#v, v, wcout)
+#define DUMPRAWCONST(pc, v) _dumprawrat(#v, (pc)->v, wcout)
 #define DUMPRAWNUM(v)                                                                                                                                          \
     fprintf(stderr, "// Autogenerated by _dumprawrat in support.cpp\n");                                                                                       \
-    fprintf(stderr, "inline const NUMBER init_" #v "= {\n");                                                                                                   \
+    fprintf(stderr, "inline const RAWNUMBER init_" #v "= {\n");                                                                                                \
     _dumprawnum(v, wcout);                                                                                                                                     \
     fprintf(stderr, "};\n")
 
@@ -42,11 +44,11 @@ static int cbitsofprecision = 0;
 
 #define DUMPRAWRAT(v)
 #define DUMPRAWNUM(v)
-#define READRAWRAT(v)                                                                                                                                          \
-    createrat(v);                                                                                                                                              \
-    DUPNUM((v)->pp, (&(init_p_##v)));                                                                                                                          \
-    DUPNUM((v)->pq, (&(init_q_##v)));
-#define READRAWNUM(v) DUPNUM(v, (&(init_##v)))
+#define DUMPRAWCONST(pc, v)
+#define READRAWCONST(pc, v)                                                                                                                                    \
+    createrat((pc)->v);                                                                                                                                        \
+    (pc)->v->pp = rawtonum(&(init_p_##v));                                                                                                                     \
+    (pc)->v->pq = rawtonum(&(init_q_##v));
 
 #define INIT_AND_DUMP_RAW_NUM_IF_NULL(r, v)                                                                                                                    \
     if (r == nullptr)                                                                                                                                          \
@@ -65,15 +67,29 @@ static constexpr int RATIO_FOR_DECIMAL = 9;
 static constexpr int DECIMAL = 10;
 static constexpr int CALC_DECIMAL_DIGITS_DEFAULT = 32;
 
-static int cbitsofprecision = RATIO_FOR_DECIMAL * DECIMAL * CALC_DECIMAL_DIGITS_DEFAULT;
+// Bits of precision the constants in ratconst.h were generated with.
+static constexpr int cbitsofprecision = RATIO_FOR_DECIMAL * DECIMAL * CALC_DECIMAL_DIGITS_DEFAULT;
 
 #include "ratconst.h"
 
 #endif
 
-bool g_ftrueinfinite = false; // Set to true if you don't want
-                              // chopping internally
-                              // precision used internally
+// Precision, in BASEX digits, at which exp, sin and cos reduce their
+// argument before summing the series.
+int32_t g_reduceThreshold = REDUCE_THRESHOLD;
+
+thread_local bool g_ftrueinfinite = false; // Set to true if you don't want
+                                           // chopping internally
+                                           // precision used internally
+
+thread_local bool g_fadaptive = false; // Set to true to have RationalMath
+                                       // evaluate near the display precision
+                                       // and only retry at full precision
+                                       // when that can't be rounded for display
+
+// Constant set of the calling thread's context, the globals below for the
+// radix and precision point into it.
+thread_local const RATCONSTANTS* t_constants = nullptr;
 
 PNUMBER num_one = nullptr;
 PNUMBER num_two = nullptr;
@@ -81,8 +97,8 @@ PNUMBER num_five = nullptr;
 PNUMBER num_six = nullptr;
 PNUMBER num_ten = nullptr;
 
-PRAT ln_ten = nullptr;
-PRAT ln_two = nullptr;
+thread_local PRAT ln_ten = nullptr;
+thread_local PRAT ln_two = nullptr;
 PRAT rat_zero = nullptr;
 PRAT rat_one = nullptr;
 PRAT rat_neg_one = nullptr;
@@ -91,14 +107,14 @@ PRAT rat_six = nullptr;
 PRAT rat_half = nullptr;
 PRAT rat_ten = nullptr;
 PRAT pt_eight_five = nullptr;
-PRAT pi = nullptr;
-PRAT pi_over_two = nullptr;
-PRAT two_pi = nullptr;
-PRAT one_pt_five_pi = nullptr;
-PRAT e_to_one_half = nullptr;
-PRAT rat_exp = nullptr;
-PRAT rad_to_deg = nullptr;
-PRAT rad_to_grad = nullptr;
+thread_local PRAT pi = nullptr;
+thread_local PRAT pi_over_two = nullptr;
+thread_local PRAT two_pi = nullptr;
+thread_local PRAT one_pt_five_pi = nullptr;
+thread_local PRAT e_to_one_half = nullptr;
+thread_local PRAT rat_exp = nullptr;
+thread_local PRAT rad_to_deg = nullptr;
+thread_local PRAT rad_to_grad = nullptr;
 PRAT rat_qword = nullptr;
 PRAT rat_dword = nullptr; // unsigned max ui32
 PRAT rat_word = nullptr;
@@ -107,9 +123,9 @@ PRAT rat_360 = nullptr;
 PRAT rat_400 = nullptr;
 PRAT rat_180 = nullptr;
 PRAT rat_200 = nullptr;
-PRAT rat_nRadix = nullptr;
-PRAT rat_smallest = nullptr;
-PRAT rat_negsmallest = nullptr;
+thread_local PRAT rat_nRadix = nullptr;
+thread_local PRAT rat_smallest = nullptr;
+thread_local PRAT rat_negsmallest = nullptr;
 PRAT rat_max_exp = nullptr;
 PRAT rat_min_exp = nullptr;
 PRAT rat_max_fact = nullptr;
@@ -117,41 +133,44 @@ PRAT rat_min_fact = nullptr;
 PRAT rat_min_i32 = nullptr; // min signed i32
 PRAT rat_max_i32 = nullptr; // max signed i32
 
-//----------------------------------------------------------------------------
-//
-//  FUNCTION: ChangeConstants
-//
-//  ARGUMENTS:  base changing to, and precision to use.
-//
-//  RETURN: None
-//
-//  SIDE EFFECTS: sets a mess of constants.
-//
-//
-//----------------------------------------------------------------------------
-
-void ChangeConstants(uint32_t radix, int32_t precision)
+namespace
 {
-    // ratio is set to the number of digits in the current radix, you can get
-    // in the internal BASEX radix, this is important for length calculations
-    // in translating from radix to BASEX and back.
+    // Precision in radix digits the precision independent constants are
+    // built at, enough to hold 2^64 in any radix.
+    constexpr int32_t FIXED_PRECISION = 64;
 
-    uint64_t limit = static_cast<uint64_t>(BASEX) / static_cast<uint64_t>(radix);
-    g_ratio = 0;
-    for (uint32_t digit = 1; digit < limit; digit *= radix)
+    once_flag s_fixedonce;
+
+    // Constant sets are built under the lock and never changed or freed
+    // afterwards, a pointer handed out by getconstants stays good.
+    mutex s_constantslock;
+    map<pair<uint32_t, int32_t>, unique_ptr<RATCONSTANTS>> s_constants;
+
+    int32_t ratioforradix(uint32_t radix)
     {
-        g_ratio++;
+        // ratio is set to the number of digits in the current radix, you can get
+        // in the internal BASEX radix, this is important for length calculations
+        // in translating from radix to BASEX and back.
+        uint64_t limit = static_cast<uint64_t>(BASEX) / static_cast<uint64_t>(radix);
+        int32_t ratio = 0;
+        for (uint32_t digit = 1; digit < limit; digit *= radix)
+        {
+            ratio++;
+        }
+        return ratio + !ratio;
     }
-    g_ratio += !g_ratio;
 
-    destroyrat(rat_nRadix);
-    rat_nRadix = i32torat(radix);
+    //----------------------------------------------------------------------------
+    //
+    //  FUNCTION: initfixedconstants
+    //
+    //  DESCRIPTION: builds the constants that do not depend on the radix or
+    //  the precision, once.
+    //
+    //----------------------------------------------------------------------------
 
-    // Check to see what we have to recalculate and what we don't
-    if (cbitsofprecision < (g_ratio * static_cast<int32_t>(radix) * precision))
+    void initfixedconstants()
     {
-        g_ftrueinfinite = false;
-
         INIT_AND_DUMP_RAW_NUM_IF_NULL(num_one, 1L);
         INIT_AND_DUMP_RAW_NUM_IF_NULL(num_two, 2L);
         INIT_AND_DUMP_RAW_NUM_IF_NULL(num_five, 5L);
@@ -164,57 +183,44 @@ void ChangeConstants(uint32_t radix, int32_t precision)
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_neg_one, -1L);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_ten, 10L);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_word, 0xffff);
-        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_word, 0xff);
+        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_byte, 0xff);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_400, 400);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_360, 360);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_200, 200);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_180, 180);
         INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_max_exp, 100000);
 
-        // 3248, is the max number for which calc is able to compute factorial, after that it is unable to compute due to overflow.
-        // Hence restricted factorial range as at most 3248.Beyond that calc will throw overflow error immediately.
-        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_max_fact, 3249);
+        // 100000, is the max number for which calc computes factorial. Integer factorials are exact, 100000! has 456574
+        // digits and takes a fraction of a second, larger ones only grow a result the display overflows on long before.
+        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_max_fact, 100000);
 
-        // -1000, is the min number for which calc is able to compute factorial, after that it takes too long to compute.
-        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_min_fact, -1000);
+        // -100000, is the min number for which calc computes factorial, negative ones reflect onto positive ones.
+        INIT_AND_DUMP_RAW_RAT_IF_NULL(rat_min_fact, -100000);
 
-        DUPRAT(rat_smallest, rat_nRadix);
-        ratpowi32(&rat_smallest, -precision, precision);
-        DUPRAT(rat_negsmallest, rat_smallest);
-        rat_negsmallest->pp->sign = -1;
-        DUMPRAWRAT(rat_smallest);
-        DUMPRAWRAT(rat_negsmallest);
+        createrat(rat_half);
+        DUPNUM(rat_half->pp, num_one);
+        DUPNUM(rat_half->pq, num_two);
+        DUMPRAWRAT(rat_half);
 
-        if (rat_half == nullptr)
-        {
-            createrat(rat_half);
-            DUPNUM(rat_half->pp, num_one);
-            DUPNUM(rat_half->pq, num_two);
-            DUMPRAWRAT(rat_half);
-        }
-
-        if (pt_eight_five == nullptr)
-        {
-            createrat(pt_eight_five);
-            pt_eight_five->pp = i32tonum(85L, BASEX);
-            pt_eight_five->pq = i32tonum(100L, BASEX);
-            DUMPRAWRAT(pt_eight_five);
-        }
+        createrat(pt_eight_five);
+        pt_eight_five->pp = i32tonum(85L, BASEX);
+        pt_eight_five->pq = i32tonum(100L, BASEX);
+        DUMPRAWRAT(pt_eight_five);
 
         DUPRAT(rat_qword, rat_two);
-        numpowi32(&(rat_qword->pp), 64, BASEX, precision);
-        subrat(&rat_qword, rat_one, precision);
+        numpowi32(&(rat_qword->pp), 64, BASEX, FIXED_PRECISION);
+        subrat(&rat_qword, rat_one, FIXED_PRECISION);
         DUMPRAWRAT(rat_qword);
 
         DUPRAT(rat_dword, rat_two);
-        numpowi32(&(rat_dword->pp), 32, BASEX, precision);
-        subrat(&rat_dword, rat_one, precision);
+        numpowi32(&(rat_dword->pp), 32, BASEX, FIXED_PRECISION);
+        subrat(&rat_dword, rat_one, FIXED_PRECISION);
         DUMPRAWRAT(rat_dword);
 
         DUPRAT(rat_max_i32, rat_two);
-        numpowi32(&(rat_max_i32->pp), 31, BASEX, precision);
+        numpowi32(&(rat_max_i32->pp), 31, BASEX, FIXED_PRECISION);
         DUPRAT(rat_min_i32, rat_max_i32);
-        subrat(&rat_max_i32, rat_one, precision); // rat_max_i32 = 2^31 -1
+        subrat(&rat_max_i32, rat_one, FIXED_PRECISION); // rat_max_i32 = 2^31 -1
         DUMPRAWRAT(rat_max_i32);
 
         rat_min_i32->pp->sign *= -1; // rat_min_i32 = -2^31
@@ -223,66 +229,220 @@ void ChangeConstants(uint32_t radix, int32_t precision)
         DUPRAT(rat_min_exp, rat_max_exp);
         rat_min_exp->pp->sign *= -1;
         DUMPRAWRAT(rat_min_exp);
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    //  FUNCTION: buildconstants
+    //
+    //  ARGUMENTS:  constant set with radix, ratio and precision filled in.
+    //
+    //  DESCRIPTION: fills in the rest of the set, from ratconst.h if that
+    //  holds enough digits, by series otherwise.  g_ratio has to be the ratio
+    //  of the radix.
+    //
+    //----------------------------------------------------------------------------
+
+    void buildconstants(RATCONSTANTS* pc)
+    {
+        uint32_t radix = pc->radix;
+        int32_t precision = pc->precision;
 
-        cbitsofprecision = g_ratio * radix * precision;
+        pc->rat_nRadix = i32torat(radix);
+        DUPRAT(pc->rat_smallest, pc->rat_nRadix);
+        ratpowi32(&pc->rat_smallest, -precision, precision);
+        DUPRAT(pc->rat_negsmallest, pc->rat_smallest);
+        pc->rat_negsmallest->pp->sign = -1;
+
+        if (cbitsofprecision >= (pc->ratio * static_cast<int32_t>(radix) * precision))
+        {
+            READRAWCONST(pc, pi);
+            READRAWCONST(pc, two_pi);
+            READRAWCONST(pc, pi_over_two);
+            READRAWCONST(pc, one_pt_five_pi);
+            READRAWCONST(pc, e_to_one_half);
+            READRAWCONST(pc, rat_exp);
+            READRAWCONST(pc, ln_ten);
+            READRAWCONST(pc, ln_two);
+            READRAWCONST(pc, rad_to_deg);
+            READRAWCONST(pc, rad_to_grad);
+            return;
+        }
 
         // Apparently when dividing 180 by pi, another (internal) digit of
-        // precision is needed.
-        int32_t extraPrecision = precision + g_ratio;
-        DUPRAT(pi, rat_half);
-        asinrat(&pi, radix, extraPrecision);
-        mulrat(&pi, rat_six, extraPrecision);
-        DUMPRAWRAT(pi);
-
-        DUPRAT(two_pi, pi);
-        DUPRAT(pi_over_two, pi);
-        DUPRAT(one_pt_five_pi, pi);
-        addrat(&two_pi, pi, extraPrecision);
-        DUMPRAWRAT(two_pi);
-
-        divrat(&pi_over_two, rat_two, extraPrecision);
-        DUMPRAWRAT(pi_over_two);
-
-        addrat(&one_pt_five_pi, pi_over_two, extraPrecision);
-        DUMPRAWRAT(one_pt_five_pi);
-
-        DUPRAT(e_to_one_half, rat_half);
-        _exprat(&e_to_one_half, extraPrecision);
-        DUMPRAWRAT(e_to_one_half);
-
-        DUPRAT(rat_exp, rat_one);
-        _exprat(&rat_exp, extraPrecision);
-        DUMPRAWRAT(rat_exp);
-
-        // WARNING: remember lograt uses exponent constants calculated above...
-
-        DUPRAT(ln_ten, rat_ten);
-        lograt(&ln_ten, extraPrecision);
-        DUMPRAWRAT(ln_ten);
-
-        DUPRAT(ln_two, rat_two);
-        lograt(&ln_two, extraPrecision);
-        DUMPRAWRAT(ln_two);
-
-        destroyrat(rad_to_deg);
-        rad_to_deg = i32torat(180L);
-        divrat(&rad_to_deg, pi, extraPrecision);
-        DUMPRAWRAT(rad_to_deg);
-
-        destroyrat(rad_to_grad);
-        rad_to_grad = i32torat(200L);
-        divrat(&rad_to_grad, pi, extraPrecision);
-        DUMPRAWRAT(rad_to_grad);
+        // precision is needed.  Only the series are called, the functions
+        // around them read the constant globals this set is not in yet.
+        int32_t extraPrecision = precision + pc->ratio;
+        DUPRAT(pc->pi, rat_half);
+        _asinrat(&pc->pi, extraPrecision);
+        mulrat(&pc->pi, rat_six, extraPrecision);
+        DUMPRAWCONST(pc, pi);
+
+        DUPRAT(pc->two_pi, pc->pi);
+        DUPRAT(pc->pi_over_two, pc->pi);
+        DUPRAT(pc->one_pt_five_pi, pc->pi);
+        addrat(&pc->two_pi, pc->pi, extraPrecision);
+        DUMPRAWCONST(pc, two_pi);
+
+        divrat(&pc->pi_over_two, rat_two, extraPrecision);
+        DUMPRAWCONST(pc, pi_over_two);
+
+        addrat(&pc->one_pt_five_pi, pc->pi_over_two, extraPrecision);
+        DUMPRAWCONST(pc, one_pt_five_pi);
+
+        DUPRAT(pc->e_to_one_half, rat_half);
+        _exprat(&pc->e_to_one_half, extraPrecision);
+        DUMPRAWCONST(pc, e_to_one_half);
+
+        DUPRAT(pc->rat_exp, rat_one);
+        _exprat(&pc->rat_exp, extraPrecision);
+        DUMPRAWCONST(pc, rat_exp);
+
+        // ln(2) = 2*atanh(1/3) and ln(10) = 3*ln(2) + 2*atanh(1/9), the
+        // atanh series in small rationals are quicker than going through lograt.
+        createrat(pc->ln_two);
+        pc->ln_two->pp = i32tonum(1L, BASEX);
+        pc->ln_two->pq = i32tonum(3L, BASEX);
+        _splitrat(&pc->ln_two, SERIES_ATANH, extraPrecision);
+        mulrat(&pc->ln_two, rat_two, extraPrecision);
+        DUMPRAWCONST(pc, ln_two);
+
+        createrat(pc->ln_ten);
+        pc->ln_ten->pp = i32tonum(1L, BASEX);
+        pc->ln_ten->pq = i32tonum(9L, BASEX);
+        _splitrat(&pc->ln_ten, SERIES_ATANH, extraPrecision);
+        addrat(&pc->ln_ten, pc->ln_two, extraPrecision);
+        mulrat(&pc->ln_ten, rat_two, extraPrecision);
+        addrat(&pc->ln_ten, pc->ln_two, extraPrecision);
+        DUMPRAWCONST(pc, ln_ten);
+
+        pc->rad_to_deg = i32torat(180L);
+        divrat(&pc->rad_to_deg, pc->pi, extraPrecision);
+        DUMPRAWCONST(pc, rad_to_deg);
+
+        pc->rad_to_grad = i32torat(200L);
+        divrat(&pc->rad_to_grad, pc->pi, extraPrecision);
+        DUMPRAWCONST(pc, rad_to_grad);
     }
-    else
+}
+
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: getconstants
+//
+//  ARGUMENTS:  radix and precision the constants are wanted for.
+//
+//  RETURN: the constant set for radix and precision, built the first time it
+//  is asked for and shared after that.  Safe to call from any thread, the
+//  set is never changed once returned.
+//
+//----------------------------------------------------------------------------
+
+const RATCONSTANTS* getconstants(uint32_t radix, int32_t precision)
+{
+    call_once(s_fixedonce, initfixedconstants);
+
+    lock_guard<mutex> lock(s_constantslock);
+    unique_ptr<RATCONSTANTS>& entry = s_constants[{ radix, precision }];
+    if (entry == nullptr)
     {
-        _readconstants();
+        auto pc = make_unique<RATCONSTANTS>();
+        pc->radix = radix;
+        pc->precision = precision;
+        pc->ratio = ratioforradix(radix);
+
+        // The series read the thread's g_ratio, leave it as it was for the caller.
+        int32_t savedRatio = g_ratio;
+        g_ratio = pc->ratio;
+        try
+        {
+            buildconstants(pc.get());
+        }
+        catch (...)
+        {
+            g_ratio = savedRatio;
+            s_constants.erase({ radix, precision });
+            throw;
+        }
+        g_ratio = savedRatio;
+        entry = move(pc);
+    }
+    return entry.get();
+}
 
-        DUPRAT(rat_smallest, rat_nRadix);
-        ratpowi32(&rat_smallest, -precision, precision);
-        DUPRAT(rat_negsmallest, rat_smallest);
-        rat_negsmallest->pp->sign = -1;
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: getratpakcontext
+//
+//  RETURN: the context of the calling thread.
+//
+//----------------------------------------------------------------------------
+
+RATPAKCONTEXT getratpakcontext()
+{
+    return { t_constants, g_decimalSeparator, g_ftrueinfinite, g_fadaptive };
+}
+
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: setratpakcontext
+//
+//  ARGUMENTS:  context to make the calling thread's.
+//
+//  SIDE EFFECTS: points the constant globals of the thread at the context's
+//  constant set.
+//
+//----------------------------------------------------------------------------
+
+void setratpakcontext(const RATPAKCONTEXT& context)
+{
+    g_decimalSeparator = context.decimalSeparator;
+    g_ftrueinfinite = context.ftrueinfinite;
+    g_fadaptive = context.fadaptive;
+
+    const RATCONSTANTS* pc = context.constants;
+    t_constants = pc;
+    if (pc == nullptr)
+    {
+        return;
     }
+
+    g_ratio = pc->ratio;
+    rat_nRadix = pc->rat_nRadix;
+    rat_smallest = pc->rat_smallest;
+    rat_negsmallest = pc->rat_negsmallest;
+    pi = pc->pi;
+    two_pi = pc->two_pi;
+    pi_over_two = pc->pi_over_two;
+    one_pt_five_pi = pc->one_pt_five_pi;
+    e_to_one_half = pc->e_to_one_half;
+    rat_exp = pc->rat_exp;
+    ln_ten = pc->ln_ten;
+    ln_two = pc->ln_two;
+    rad_to_deg = pc->rad_to_deg;
+    rad_to_grad = pc->rad_to_grad;
+}
+
+//----------------------------------------------------------------------------
+//
+//  FUNCTION: ChangeConstants
+//
+//  ARGUMENTS:  base changing to, and precision to use.
+//
+//  RETURN: None
+//
+//  SIDE EFFECTS: switches the calling thread's context to the constant set
+//  for radix and precision, see getconstants.
+//
+//
+//----------------------------------------------------------------------------
+
+void ChangeConstants(uint32_t radix, int32_t precision)
+{
+    RATPAKCONTEXT context = getratpakcontext();
+    context.constants = getconstants(radix, precision);
+    context.ftrueinfinite = false;
+    setratpakcontext(context);
 }
 
 //----------------------------------------------------------------------------
@@ -317,6 +477,128 @@ void intrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
     }
 }
 
+namespace
+{
+    // Scratch for the cross products of ratcmp, kept between calls so that
+    // comparisons on a thread stop allocating once it is big enough.
+    thread_local vector<MANTTYPE> t_cmplhs;
+    thread_local vector<MANTTYPE> t_cmprhs;
+
+    // Digit count of a mantissa without its leading zeros.
+    int32_t sigdigits(const MANTTYPE* p, int32_t c)
+    {
+        while (c > 0 && p[c - 1] == 0)
+        {
+            c--;
+        }
+        return c;
+    }
+
+    // Compares pa * BASEX^ea with pb * BASEX^eb, returns -1, 0 or 1.
+    int32_t cmpscaled(const MANTTYPE* pa, int32_t ca, int32_t ea, const MANTTYPE* pb, int32_t cb, int32_t eb)
+    {
+        ca = sigdigits(pa, ca);
+        cb = sigdigits(pb, cb);
+        if (ca == 0 || cb == 0)
+        {
+            return (ca != 0) - (cb != 0);
+        }
+        if (ca + ea != cb + eb)
+        {
+            return (ca + ea < cb + eb) ? -1 : 1;
+        }
+
+        // The top digits line up, a digit below the end of either mantissa is
+        // a zero.
+        int32_t cdigits = max(ca, cb);
+        for (int32_t i = 1; i <= cdigits; i++)
+        {
+            MANTTYPE da = (i <= ca) ? pa[ca - i] : 0;
+            MANTTYPE db = (i <= cb) ? pb[cb - i] : 0;
+            if (da != db)
+            {
+                return (da < db) ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // Multiplies the mantissas of x and y into scratch, returns the digit
+    // count of the product.
+    int32_t crossmant(vector<MANTTYPE>& scratch, PNUMBER x, int32_t cx, PNUMBER y, int32_t cy)
+    {
+        size_t cprod = static_cast<size_t>(cx) + cy;
+        if (scratch.size() < cprod)
+        {
+            scratch.resize(cprod);
+        }
+        _mulmantx(scratch.data(), x->mant, cx, y->mant, cy);
+        return static_cast<int32_t>(cprod);
+    }
+}
+
+//---------------------------------------------------------------------------
+//
+//  FUNCTION: ratcmp
+//
+//  ARGUMENTS:  PRAT a and PRAT b
+//
+//  RETURN: -1, 0 or 1 as a is less than, equal to or greater than b.
+//
+//  DESCRIPTION: Neither a nor b is changed and nothing is allocated once
+//  the scratch of the thread is big enough.  Different signs decide at
+//  once.  Otherwise |x| lies within a BASEX digit of BASEX^LOGRAT2(x), so
+//  estimates two or more apart decide the magnitudes, and only estimates
+//  that tie cross multiply p of one with q of the other and compare the
+//  products.  Equal q's skip the products and compare the p's.
+//
+//---------------------------------------------------------------------------
+
+int32_t ratcmp(_In_ PRAT a, _In_ PRAT b)
+{
+    int32_t signa = zernum(a->pp) ? 0 : SIGN(a);
+    int32_t signb = zernum(b->pp) ? 0 : SIGN(b);
+    if (signa != signb)
+    {
+        return (signa < signb) ? -1 : 1;
+    }
+    if (signa == 0)
+    {
+        return 0;
+    }
+
+    // Same sign, compare the magnitudes and turn the answer around if both
+    // are negative.
+    int32_t cap = sigdigits(a->pp->mant, a->pp->cdigit);
+    int32_t caq = sigdigits(a->pq->mant, a->pq->cdigit);
+    int32_t cbp = sigdigits(b->pp->mant, b->pp->cdigit);
+    int32_t cbq = sigdigits(b->pq->mant, b->pq->cdigit);
+    int32_t loga = (cap + a->pp->exp) - (caq + a->pq->exp);
+    int32_t logb = (cbp + b->pp->exp) - (cbq + b->pq->exp);
+
+    int32_t cmp;
+    if (loga - logb >= 2)
+    {
+        cmp = 1;
+    }
+    else if (logb - loga >= 2)
+    {
+        cmp = -1;
+    }
+    else if (equnum(a->pq, b->pq))
+    {
+        cmp = cmpscaled(a->pp->mant, cap, a->pp->exp, b->pp->mant, cbp, b->pp->exp);
+    }
+    else
+    {
+        int32_t clhs = crossmant(t_cmplhs, a->pp, cap, b->pq, cbq);
+        int32_t crhs = crossmant(t_cmprhs, b->pp, cbp, a->pq, caq);
+        cmp = cmpscaled(t_cmplhs.data(), clhs, a->pp->exp + b->pq->exp, t_cmprhs.data(), crhs, b->pp->exp + a->pq->exp);
+    }
+
+    return signa * cmp;
+}
+
 //---------------------------------------------------------------------------
 //
 //  FUNCTION: rat_equ
@@ -328,16 +610,10 @@ void intrat(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 //
 //---------------------------------------------------------------------------
 
-bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    rattmp->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    bool bret = zernum(rattmp->pp);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) == 0;
 }
 
 //---------------------------------------------------------------------------
@@ -351,17 +627,10 @@ bool rat_equ(_In_ PRAT a, _In_ PRAT b, int32_t precision)
 //
 //---------------------------------------------------------------------------
 
-bool rat_ge(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+bool rat_ge(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (zernum(rattmp->pp) || SIGN(rattmp) == 1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) >= 0;
 }
 
 //---------------------------------------------------------------------------
@@ -375,17 +644,10 @@ bool rat_ge(_In_ PRAT a, _In_ PRAT b, int32_t precision)
 //
 //---------------------------------------------------------------------------
 
-bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (!zernum(rattmp->pp) && SIGN(rattmp) == 1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) > 0;
 }
 
 //---------------------------------------------------------------------------
@@ -399,17 +661,10 @@ bool rat_gt(_In_ PRAT a, _In_ PRAT b, int32_t precision)
 //
 //---------------------------------------------------------------------------
 
-bool rat_le(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+bool rat_le(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (zernum(rattmp->pp) || SIGN(rattmp) == -1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) <= 0;
 }
 
 //---------------------------------------------------------------------------
@@ -423,17 +678,10 @@ bool rat_le(_In_ PRAT a, _In_ PRAT b, int32_t precision)
 //
 //---------------------------------------------------------------------------
 
-bool rat_lt(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+bool rat_lt(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    b->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    b->pp->sign *= -1;
-    bool bret = (!zernum(rattmp->pp) && SIGN(rattmp) == -1);
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) < 0;
 }
 
 //---------------------------------------------------------------------------
@@ -447,16 +695,10 @@ bool rat_lt(_In_ PRAT a, _In_ PRAT b, int32_t precision)
 //
 //---------------------------------------------------------------------------
 
-bool rat_neq(_In_ PRAT a, _In_ PRAT b, int32_t precision)
+bool rat_neq(_In_ PRAT a, _In_ PRAT b, int32_t /*precision*/)
 
 {
-    PRAT rattmp = nullptr;
-    DUPRAT(rattmp, a);
-    rattmp->pp->sign *= -1;
-    addrat(&rattmp, b, precision);
-    bool bret = !(zernum(rattmp->pp));
-    destroyrat(rattmp);
-    return (bret);
+    return ratcmp(a, b) != 0;
 }
 
 //---------------------------------------------------------------------------
@@ -492,6 +734,230 @@ void scale(_Inout_ PRAT* px, _In_ PRAT scalefact, uint32_t radix, int32_t precis
     destroyrat(pret);
 }
 
+namespace
+{
+    // 2 pi and 1/(2 pi) as BASEX fixed point numbers, mant * BASEX^exp, good
+    // to all of their cdigit digits.  Entries are built under the lock at
+    // growing lengths and never changed or freed afterwards.
+    struct TWOPIDIGITS
+    {
+        int32_t cdigit;
+        PNUMBER twopi;
+        PNUMBER invtwopi;
+    };
+
+    mutex s_twopilock;
+    vector<unique_ptr<TWOPIDIGITS>> s_twopi;
+
+    // Shortest the cache starts out at, in BASEX digits.
+    constexpr int32_t TWOPI_MIN_DIGITS = 16;
+
+    // a / b truncated to at least cdigit significant BASEX digits, a and b
+    // are taken as positive.
+    PNUMBER fixedquotient(PNUMBER a, PNUMBER b, int32_t cdigit)
+    {
+        int32_t ca = sigdigits(a->mant, a->cdigit);
+        int32_t cb = sigdigits(b->mant, b->cdigit);
+        int32_t shift = max(cdigit + cb - ca + 1, 0);
+
+        vector<MANTTYPE> n(static_cast<size_t>(ca) + shift, 0);
+        copy(a->mant, a->mant + ca, n.begin() + shift);
+        int32_t cn = static_cast<int32_t>(n.size());
+
+        PNUMBER q = nullptr;
+        createnum(q, cn - cb + 1);
+        _divmantx(q->mant, nullptr, n.data(), cn, b->mant, cb);
+        q->sign = 1;
+        q->cdigit = sigdigits(q->mant, cn - cb + 1);
+        q->exp = a->exp - b->exp - shift;
+        return q;
+    }
+
+    // The cache entry with at least cdigit digits, built if there is none.
+    const TWOPIDIGITS* twopidigits(int32_t cdigit, uint32_t radix)
+    {
+        lock_guard<mutex> lock(s_twopilock);
+        if (!s_twopi.empty() && s_twopi.back()->cdigit >= cdigit)
+        {
+            return s_twopi.back().get();
+        }
+
+        // Grow geometrically so a run of ever larger arguments only builds a
+        // few entries.
+        if (!s_twopi.empty())
+        {
+            cdigit = max(cdigit, 2 * s_twopi.back()->cdigit);
+        }
+        cdigit = max(cdigit, TWOPI_MIN_DIGITS);
+
+        // 2 pi = 12 asin(1/2) a couple of digits past what is kept.
+        int32_t precision = (cdigit + 2) * g_ratio;
+        PRAT prat = nullptr;
+        DUPRAT(prat, rat_half);
+        asinrat(&prat, radix, precision);
+        mulrat(&prat, rat_six, precision);
+        mulrat(&prat, rat_two, precision);
+
+        auto entry = make_unique<TWOPIDIGITS>();
+        entry->cdigit = cdigit;
+        entry->twopi = fixedquotient(prat->pp, prat->pq, cdigit);
+        entry->invtwopi = fixedquotient(prat->pq, prat->pp, cdigit);
+        destroyrat(prat);
+
+        s_twopi.push_back(move(entry));
+        return s_twopi.back().get();
+    }
+
+    // A positive rational from the mantissa digits [first, first + c) of p
+    // times BASEX^exp, over q times BASEX^qexp.
+    PRAT fixedrat(const MANTTYPE* p, int32_t c, int32_t exp, const MANTTYPE* q, int32_t cq, int32_t qexp)
+    {
+        PRAT prat = nullptr;
+        createrat(prat);
+        c = max(sigdigits(p, c), 1);
+        createnum(prat->pp, c);
+        copy(p, p + c, prat->pp->mant);
+        prat->pp->cdigit = c;
+        prat->pp->sign = 1;
+        createnum(prat->pq, cq);
+        copy(q, q + cq, prat->pq->mant);
+        prat->pq->cdigit = cq;
+        prat->pq->sign = 1;
+
+        // p and q are integers in a rational.
+        exp -= qexp;
+        prat->pp->exp = max(exp, 0);
+        prat->pq->exp = max(-exp, 0);
+        return prat;
+    }
+
+    //---------------------------------------------------------------------------
+    //
+    //  FUNCTION: reduce2pi
+    //
+    //  ARGUMENTS:  pointer to x PRAT representation of number, |x| >= 1
+    //
+    //  RETURN: no return, x is smashed with x - 2pi*int(x/2pi).
+    //
+    //  DESCRIPTION: x is split exactly into an integer n and a fraction r.
+    //  The fraction of n/(2pi) is found Payne-Hanek style, the digits of
+    //  1/(2pi) whose product with n is an integer only add whole turns and
+    //  are skipped, and those below the precision are too small to matter.
+    //  That leaves a window of about as many digits as n has plus the
+    //  precision, however large n is, taken from the cache.  The fraction
+    //  times 2pi, plus r, is the answer.
+    //
+    //---------------------------------------------------------------------------
+
+    void reduce2pi(PRAT* px, uint32_t radix, int32_t precision)
+    {
+        int32_t sign = SIGN(*px);
+        PNUMBER p = (*px)->pp;
+        PNUMBER q = (*px)->pq;
+        int32_t cp = sigdigits(p->mant, p->cdigit);
+        int32_t cq = sigdigits(q->mant, q->cdigit);
+        int32_t shift = p->exp - q->exp;
+
+        // n = mant[0, cn) * BASEX^nexp and r = rpart, both taken as positive.
+        vector<MANTTYPE> n;
+        const MANTTYPE* nmant;
+        int32_t cn;
+        int32_t nexp = 0;
+        PRAT rpart = nullptr;
+        if (cq == 1 && q->mant[0] == 1)
+        {
+            // q is a power of BASEX, the split is where the digits of p are.
+            if (shift >= 0)
+            {
+                nmant = p->mant;
+                cn = cp;
+                nexp = shift;
+            }
+            else
+            {
+                nmant = p->mant - shift;
+                cn = cp + shift;
+                if (sigdigits(p->mant, -shift) > 0)
+                {
+                    rpart = fixedrat(p->mant, -shift, 0, num_one->mant, 1, -shift);
+                }
+            }
+        }
+        else
+        {
+            // Long division of p by q, one of them shifted so both are
+            // integers in the same units.
+            vector<MANTTYPE> a(static_cast<size_t>(cp) + max(shift, 0), 0);
+            copy(p->mant, p->mant + cp, a.begin() + max(shift, 0));
+            vector<MANTTYPE> b(static_cast<size_t>(cq) + max(-shift, 0), 0);
+            copy(q->mant, q->mant + cq, b.begin() + max(-shift, 0));
+            int32_t ca = static_cast<int32_t>(a.size());
+            int32_t cb = static_cast<int32_t>(b.size());
+
+            n.resize(static_cast<size_t>(ca) - cb + 1);
+            vector<MANTTYPE> rem(cb);
+            _divmantx(n.data(), rem.data(), a.data(), ca, b.data(), cb);
+            nmant = n.data();
+            cn = sigdigits(n.data(), ca - cb + 1);
+            if (sigdigits(rem.data(), cb) > 0)
+            {
+                rpart = fixedrat(rem.data(), cb, 0, b.data(), cb, 0);
+            }
+        }
+
+        // Digits of the fraction of n/(2pi) that are carried, and the window
+        // of 1/(2pi) that gives them.  Digit i of 1/(2pi) times n lands on
+        // BASEX^(nexp + exp + i) and up.
+        int32_t cfrac = precision / g_ratio + 1 + REDUCE_2PI_GUARD;
+        const TWOPIDIGITS* pcache = twopidigits(nexp + cn + cfrac + 1, radix);
+        PNUMBER inv = pcache->invtwopi;
+        int32_t ihigh = min(inv->cdigit, max(-nexp - inv->exp, 0));
+        int32_t ilow = max(ihigh - cn - cfrac, 0);
+
+        PRAT pret = nullptr;
+        if (cn > 0 && ihigh > ilow)
+        {
+            int32_t cw = cn + ihigh - ilow;
+            vector<MANTTYPE> w(cw);
+            _mulmantx(w.data(), nmant, cn, inv->mant + ilow, ihigh - ilow);
+
+            // Digits of w below BASEX^0 are the fraction, keep the top cfrac.
+            int32_t kfrac = min(-(nexp + inv->exp + ilow), cw);
+            int32_t kfirst = max(kfrac - cfrac, 0);
+            PNUMBER twopi = pcache->twopi;
+            int32_t ctwopi = min(twopi->cdigit, cfrac + 1);
+            const MANTTYPE* ptwopi = twopi->mant + twopi->cdigit - ctwopi;
+            int32_t twopiexp = twopi->exp + twopi->cdigit - ctwopi;
+
+            // fraction * 2pi as one product.
+            int32_t cf = kfrac - kfirst;
+            vector<MANTTYPE> product(static_cast<size_t>(cf) + ctwopi);
+            _mulmantx(product.data(), w.data() + kfirst, cf, ptwopi, ctwopi);
+            pret = fixedrat(product.data(), cf + ctwopi, twopiexp - cf, num_one->mant, 1, 0);
+        }
+        else
+        {
+            DUPRAT(pret, rat_zero);
+        }
+
+        if (rpart != nullptr)
+        {
+            addrat(&pret, rpart, precision);
+            destroyrat(rpart);
+
+            // A fraction just short of 2pi plus r may go past a whole turn.
+            if (rat_ge(pret, two_pi, precision))
+            {
+                subrat(&pret, two_pi, precision);
+            }
+        }
+
+        pret->pp->sign = sign;
+        destroyrat(*px);
+        *px = pret;
+    }
+}
+
 //---------------------------------------------------------------------------
 //
 //  function: scale2pi
@@ -501,41 +967,44 @@ void scale(_Inout_ PRAT* px, _In_ PRAT scalefact, uint32_t radix, int32_t precis
 //  RETURN: no return, value x PRAT is smashed with a scaled number in the
 //          range of 0..2pi
 //
+//  DESCRIPTION: Arguments of a BASEX digit and more are reduced against the
+//  cached digits of 2pi and 1/(2pi), which are only calculated again when
+//  an argument needs more of them than any before.
+//
 //---------------------------------------------------------------------------
 
 void scale2pi(_Inout_ PRAT* px, uint32_t radix, int32_t precision)
 {
-    PRAT pret = nullptr;
-    PRAT my_two_pi = nullptr;
-    DUPRAT(pret, *px);
-
-    // Logscale is a quick way to tell how much extra precision is needed for
-    // scaling by 2 pi.
-    int32_t logscale = g_ratio * ((pret->pp->cdigit + pret->pp->exp) - (pret->pq->cdigit + pret->pq->exp));
-    if (logscale > 0)
+    if (LOGRAT2(*px) > 0)
     {
-        precision += logscale;
-        DUPRAT(my_two_pi, rat_half);
-        asinrat(&my_two_pi, radix, precision);
-        mulrat(&my_two_pi, rat_six, precision);
-        mulrat(&my_two_pi, rat_two, precision);
-    }
-    else
-    {
-        DUPRAT(my_two_pi, two_pi);
-        logscale = 0;
+        reduce2pi(px, radix, precision);
+        return;
     }
 
-    divrat(&pret, my_two_pi, precision);
+    PRAT pret = nullptr;
+    DUPRAT(pret, *px);
+    divrat(&pret, two_pi, precision);
     intrat(&pret, radix, precision);
-    mulrat(&pret, my_two_pi, precision);
+    mulrat(&pret, two_pi, precision);
     pret->pp->sign *= -1;
     addrat(px, pret, precision);
-
-    destroyrat(my_two_pi);
     destroyrat(pret);
 }
 
+//---------------------------------------------------------------------------
+//
+//  FUNCTION: _twopidigits
+//
+//  RETURN: BASEX digits of 2pi and 1/(2pi) cached so far, 0 if none.
+//
+//---------------------------------------------------------------------------
+
+int32_t _twopidigits()
+{
+    lock_guard<mutex> lock(s_twopilock);
+    return s_twopi.empty() ? 0 : s_twopi.back()->cdigit;
+}
+
 //---------------------------------------------------------------------------
 //
 //  FUNCTION: inbetween
@@ -555,13 +1024,108 @@ void inbetween(_In_ PRAT* px, _In_ PRAT range, int32_t precision)
     }
     else
     {
-        range->pp->sign *= -1;
-        if (rat_lt(*px, range, precision))
+        // -x > range rather than x < -range, range may be a shared constant.
+        PRAT negx = nullptr;
+        DUPRAT(negx, *px);
+        negx->pp->sign *= -1;
+        if (rat_gt(negx, range, precision))
         {
             DUPRAT(*px, range);
+            (*px)->pp->sign *= -1;
         }
-        range->pp->sign *= -1;
+        destroyrat(negx);
+    }
+}
+
+//---------------------------------------------------------------------------
+//
+//  FUNCTION: _log2num
+//
+//  ARGUMENTS:  PNUMBER a, nonzero and in BASEX
+//
+//  RETURN: log2 of the magnitude of a, good to a few bits.
+//
+//---------------------------------------------------------------------------
+
+double _log2num(_In_ PNUMBER a)
+
+{
+    double top = a->mant[a->cdigit - 1];
+    if (a->cdigit > 1)
+    {
+        top += a->mant[a->cdigit - 2] / static_cast<double>(BASEX);
     }
+    return log2(top) + static_cast<double>(a->cdigit - 1 + a->exp) * BASEXPWR;
+}
+
+//---------------------------------------------------------------------------
+//
+//  FUNCTION: _reducesteps
+//
+//  ARGUMENTS:  PRAT x, reduction factor, and precision the series will
+//              be summed to.
+//
+//  RETURN: k, the number of times x should be divided by factor before
+//          summing its series, 0 if the series should be summed as is.
+//
+//  DESCRIPTION: Each division by factor makes the series converge about
+//  log2(factor) bits per term faster, and costs one step of a
+//  multiplication or two to undo with squaring or a multiple angle
+//  formula.  Balancing the two, the argument is brought down to about
+//  2^-sqrt(bits of precision), which cuts the terms summed from O(p) to
+//  O(sqrt(p)).  Below g_reduceThreshold BASEX digits of precision the
+//  series is short enough as is.
+//
+//---------------------------------------------------------------------------
+
+int32_t _reducesteps(_In_ PRAT x, uint32_t factor, int32_t precision)
+
+{
+    int32_t digits = precision / g_ratio;
+    if (zernum(x->pp) || digits < g_reduceThreshold)
+    {
+        return 0;
+    }
+
+    double log2x = _log2num(x->pp) - _log2num(x->pq);
+    double target = sqrt(static_cast<double>(digits) * BASEXPWR);
+    return max(0, static_cast<int32_t>((target + log2x) / log2(static_cast<double>(factor))));
+}
+
+//---------------------------------------------------------------------------
+//
+//  FUNCTION: _reducerat
+//
+//  ARGUMENTS:  PRAT *px, reduction factor, and number of steps
+//
+//  RETURN: none, divides *px by factor^steps exactly.
+//
+//---------------------------------------------------------------------------
+
+void _reducerat(_Inout_ PRAT* px, uint32_t factor, int32_t steps)
+
+{
+    PNUMBER pnumscale = i32tonum(factor, BASEX);
+    numpowi32x(&pnumscale, steps);
+    mulnumx(&((*px)->pq), pnumscale);
+    destroynum(pnumscale);
+}
+
+//---------------------------------------------------------------------------
+//
+//  FUNCTION: _reduceguard
+//
+//  ARGUMENTS:  bits lost over all the steps that undo a reduction.
+//
+//  RETURN: extra digits of precision the reduced series needs for the
+//          result to still be good to precision.
+//
+//---------------------------------------------------------------------------
+
+int32_t _reduceguard(int32_t bits)
+
+{
+    return (bits * g_ratio + BASEXPWR - 1) / static_cast<int32_t>(BASEXPWR) + g_ratio;
 }
 
 //---------------------------------------------------------------------------
@@ -598,7 +1162,7 @@ void _dumprawnum(_In_ const wchar_t* varname, _In_ PNUMBER num, wostream& out)
 {
     int i;
 
-    out << L"NUMBER " << varname << L" = {\n";
+    out << L"RAWNUMBER " << varname << L" = {\n";
     out << L"\t" << num->sign << L",\n";
     out << L"\t" << num->cdigit << L",\n";
     out << L"\t" << num->exp << L",\n";
@@ -612,50 +1176,6 @@ void _dumprawnum(_In_ const wchar_t* varname, _In_ PNUMBER num, wostream& out)
     out << L"};\n";
 }
 
-void _readconstants(void)
-
-{
-    READRAWNUM(num_one);
-    READRAWNUM(num_two);
-    READRAWNUM(num_five);
-    READRAWNUM(num_six);
-    READRAWNUM(num_ten);
-    READRAWRAT(pt_eight_five);
-    READRAWRAT(rat_six);
-    READRAWRAT(rat_two);
-    READRAWRAT(rat_zero);
-    READRAWRAT(rat_one);
-    READRAWRAT(rat_neg_one);
-    READRAWRAT(rat_half);
-    READRAWRAT(rat_ten);
-    READRAWRAT(pi);
-    READRAWRAT(two_pi);
-    READRAWRAT(pi_over_two);
-    READRAWRAT(one_pt_five_pi);
-    READRAWRAT(e_to_one_half);
-    READRAWRAT(rat_exp);
-    READRAWRAT(ln_ten);
-    READRAWRAT(ln_two);
-    READRAWRAT(rad_to_deg);
-    READRAWRAT(rad_to_grad);
-    READRAWRAT(rat_qword);
-    READRAWRAT(rat_dword);
-    READRAWRAT(rat_word);
-    READRAWRAT(rat_byte);
-    READRAWRAT(rat_360);
-    READRAWRAT(rat_400);
-    READRAWRAT(rat_180);
-    READRAWRAT(rat_200);
-    READRAWRAT(rat_smallest);
-    READRAWRAT(rat_negsmallest);
-    READRAWRAT(rat_max_exp);
-    READRAWRAT(rat_min_exp);
-    READRAWRAT(rat_max_fact);
-    READRAWRAT(rat_min_fact);
-    READRAWRAT(rat_min_i32);
-    READRAWRAT(rat_max_i32);
-}
-
 //---------------------------------------------------------------------------
 //
 //  FUNCTION: trimit
@@ -689,27 +1209,17 @@ void trimit(_Inout_ PRAT* px, int32_t precision)
         {
             trim /= g_ratio;
 
-            if (trim <= pp->exp)
-            {
-                pp->exp -= trim;
-            }
-            else
+            if (trim > pp->exp)
             {
-                memmove(pp->mant, &(pp->mant[trim - pp->exp]), sizeof(MANTTYPE) * (pp->cdigit - trim + pp->exp));
-                pp->cdigit -= trim - pp->exp;
-                pp->exp = 0;
+                TRIMLOW(pp, trim - pp->exp);
             }
+            pp->exp -= trim;
 
-            if (trim <= pq->exp)
-            {
-                pq->exp -= trim;
-            }
-            else
+            if (trim > pq->exp)
             {
-                memmove(pq->mant, &(pq->mant[trim - pq->exp]), sizeof(MANTTYPE) * (pq->cdigit - trim + pq->exp));
-                pq->cdigit -= trim - pq->exp;
-                pq->exp = 0;
+                TRIMLOW(pq, trim - pq->exp);
             }
+            pq->exp -= trim;
         }
         trim = min(pp->exp, pq->exp);
         pp->exp -= trim;
@@ -61,25 +61,66 @@ void scalerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_t pr
 //   thisterm  = X ;  and stop when thisterm < precision used.
 //           0                              n
 //
+//   At high precision X is first divided by 3^k, k picked by _reducesteps,
+//   and the sum put back together with the triple angle formula.
+//
 //-----------------------------------------------------------------------------
 
 void _sinrat(PRAT* px, int32_t precision)
 
 {
-    CREATETAYLOR();
+    if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_SIN, precision);
+    }
+    else
+    {
+        // sin(3x) = sin(x)*(3-4*sin(x)^2), at high precision the series is
+        // summed for x/3^k and tripled back up k times, each step costs up
+        // to a little over 3 bits.
+        int32_t steps = _reducesteps(*px, 3, precision);
+        int32_t outprecision = precision;
+        if (steps > 0)
+        {
+            _reducerat(px, 3, steps);
+            precision += _reduceguard(4 * steps);
+        }
 
-    DUPRAT(pret, *px);
-    DUPRAT(thisterm, *px);
+        CREATETAYLOR();
 
-    DUPNUM(n2, num_one);
-    xx->pp->sign *= -1;
+        DUPRAT(pret, *px);
+        DUPRAT(thisterm, *px);
 
-    do
-    {
-        NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+        DUPNUM(n2, num_one);
+        xx->pp->sign *= -1;
 
-    DESTROYTAYLOR();
+        do
+        {
+            NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
+        } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+
+        DESTROYTAYLOR();
+
+        if (steps > 0)
+        {
+            PRAT pthree = i32torat(3);
+            PRAT pfour = i32torat(4);
+            PRAT ptmp = nullptr;
+            for (int32_t i = 0; i < steps; i++)
+            {
+                DUPRAT(ptmp, *px);
+                mulrat(&ptmp, *px, precision);
+                mulrat(&ptmp, pfour, precision);
+                ptmp->pp->sign *= -1;
+                addrat(&ptmp, pthree, precision);
+                mulrat(px, ptmp, precision);
+            }
+            destroyrat(ptmp);
+            destroyrat(pthree);
+            destroyrat(pfour);
+            trimit(px, outprecision);
+        }
+    }
 
     // Since *px might be epsilon above 1 or below -1, due to TRIMIT we need
     // this trick here.
@@ -153,30 +194,61 @@ void sinanglerat(_Inout_ PRAT* pa, ANGLE_TYPE angletype, uint32_t radix, int32_t
 //   thisterm  = 1 ;  and stop when thisterm < precision used.
 //           0                              n
 //
+//   At high precision X is first divided by 2^k, k picked by _reducesteps,
+//   and the sum put back together with the double angle formula.
+//
 //-----------------------------------------------------------------------------
 
 void _cosrat(PRAT* px, uint32_t radix, int32_t precision)
 
 {
-    CREATETAYLOR();
+    if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_COS, precision);
+    }
+    else
+    {
+        // cos(2x) = 2*cos(x)^2-1, at high precision the series is summed
+        // for x/2^k and doubled back up k times, each step costs 2 bits.
+        int32_t steps = _reducesteps(*px, 2, precision);
+        int32_t outprecision = precision;
+        if (steps > 0)
+        {
+            _reducerat(px, 2, steps);
+            precision += _reduceguard(2 * steps);
+        }
 
-    destroynum(pret->pp);
-    destroynum(pret->pq);
+        CREATETAYLOR();
 
-    pret->pp = i32tonum(1L, radix);
-    pret->pq = i32tonum(1L, radix);
+        destroynum(pret->pp);
+        destroynum(pret->pq);
 
-    DUPRAT(thisterm, pret)
+        pret->pp = i32tonum(1L, radix);
+        pret->pq = i32tonum(1L, radix);
 
-    n2 = i32tonum(0L, radix);
-    xx->pp->sign *= -1;
+        DUPRAT(thisterm, pret)
 
-    do
-    {
-        NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
-    } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+        n2 = i32tonum(0L, radix);
+        xx->pp->sign *= -1;
 
-    DESTROYTAYLOR();
+        do
+        {
+            NEXTTERM(xx, INC(n2) DIVNUM(n2) INC(n2) DIVNUM(n2), precision);
+        } while (!SMALL_ENOUGH_RAT(thisterm, precision));
+
+        DESTROYTAYLOR();
+
+        if (steps > 0)
+        {
+            for (int32_t i = 0; i < steps; i++)
+            {
+                mulrat(px, *px, precision);
+                mulrat(px, rat_two, precision);
+                subrat(px, rat_one, precision);
+            }
+            trimit(px, outprecision);
+        }
+    }
     // Since *px might be epsilon above 1 or below -1, due to TRIMIT we need
     // this trick here.
     inbetween(px, rat_one, precision);
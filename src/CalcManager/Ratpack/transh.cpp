@@ -73,6 +73,12 @@ void _sinhrat(PRAT* px, int32_t precision)
         throw(CALC_E_DOMAIN);
     }
 
+    if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_SINH, precision);
+        return;
+    }
+
     CREATETAYLOR();
 
     DUPRAT(pret, *px);
@@ -152,8 +158,17 @@ void _coshrat(PRAT* px, uint32_t radix, int32_t precision)
         throw(CALC_E_DOMAIN);
     }
 
+    if (_usesplitrat(*px, precision))
+    {
+        _splitrat(px, SERIES_COSH, precision);
+        return;
+    }
+
     CREATETAYLOR();
 
+    destroynum(pret->pp);
+    destroynum(pret->pq);
+
     pret->pp = i32tonum(1L, radix);
     pret->pq = i32tonum(1L, radix);
 
@@ -3,6 +3,8 @@
 
 #include "pch.h"
 #include <CppUnitTest.h>
+#include <chrono>
+#include <thread>
 
 #include "CalcViewModel/Common/EngineResourceProvider.h"
 
@@ -13,6 +15,50 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
 static constexpr size_t MAX_HISTORY_SIZE = 20;
 
+namespace
+{
+    // Scientific and programmer keystrokes that between them go through most
+    // of the math and conversions.
+    constexpr OpCode c_scientificKeys[] = {
+        IDC_GRAD, IDC_2, IDC_SQRT, IDC_ADD, IDC_PI, IDC_EQU, IDC_SIN, IDC_MUL, IDC_9, IDC_FAC, IDC_EQU, IDC_LN,
+        IDC_DIV, IDC_2, IDC_PNT, IDC_9, IDC_EQU, IDC_COS, IDC_TAN, IDC_COSH, IDC_CUBEROOT, IDC_LOG, IDC_PWR, IDC_3,
+        IDC_PNT, IDC_7, IDC_EQU, IDC_ROOT, IDC_5, IDC_EQU, IDC_MOD, IDC_PI, IDC_EQU, IDC_POW10, IDC_REC
+    };
+    constexpr OpCode c_programmerKeys[] = {
+        IDC_HEX, IDC_F, IDC_F, IDC_LSHF, IDC_3, IDC_EQU, IDC_ROL, IDC_XOR, IDC_A, IDC_EQU, IDC_MUL, IDC_7, IDC_EQU, IDC_DEC
+    };
+
+    wstring RunKeys(CCalcEngine& engine, bool programmer)
+    {
+        engine.ProcessCommand(IDC_CLEAR);
+        if (programmer)
+        {
+            for (OpCode key : c_programmerKeys)
+            {
+                engine.ProcessCommand(key);
+            }
+        }
+        else
+        {
+            for (OpCode key : c_scientificKeys)
+            {
+                engine.ProcessCommand(key);
+            }
+        }
+        return engine.GetCurrentResultForRadix(10, 32, false);
+    }
+
+    wstring RunProgrammerKeys(CCalcEngine& engine, initializer_list<OpCode> keys, uint32_t radix)
+    {
+        engine.ProcessCommand(IDC_CLEAR);
+        for (OpCode key : keys)
+        {
+            engine.ProcessCommand(key);
+        }
+        return engine.GetCurrentResultForRadix(radix, 32, false);
+    }
+}
+
 namespace CalculatorEngineTests
 {
     TEST_CLASS(CalcEngineTests)
@@ -234,6 +280,89 @@ namespace CalculatorEngineTests
                 L"Verify expanded form multigroup non-repeating grouping.");
         }
 
+        TEST_METHOD(TestEnginesInParallel)
+        {
+            // Engines keep their own Ratpack context.  Each thread switches between a scientific and a
+            // programmer engine of its own, and every one has to get the answer of an engine run alone.
+            constexpr int repeats = 20;
+            wstring expected[2];
+            for (int programmer = 0; programmer < 2; programmer++)
+            {
+                CCalcEngine engine(false, programmer != 0, m_resourceProvider.get(), nullptr, nullptr);
+                expected[programmer] = RunKeys(engine, programmer != 0);
+            }
+
+            unsigned int cores = max(thread::hardware_concurrency(), 2u);
+            unsigned int threadCounts[2] = { 1, cores };
+            double elapsed[2] = {};
+            for (int run = 0; run < 2; run++)
+            {
+                unsigned int threadCount = threadCounts[run];
+                vector<unique_ptr<CCalcEngine>> engines;
+                for (unsigned int i = 0; i < 2 * threadCount; i++)
+                {
+                    engines.push_back(make_unique<CCalcEngine>(false, (i & 1) != 0, m_resourceProvider.get(), nullptr, nullptr));
+                }
+
+                vector<wstring> results(2 * threadCount);
+                vector<thread> threads;
+                auto start = chrono::steady_clock::now();
+                for (unsigned int i = 0; i < threadCount; i++)
+                {
+                    threads.emplace_back([&engines, &results, i] {
+                        for (int j = 0; j < repeats; j++)
+                        {
+                            results[2 * i] = RunKeys(*engines[2 * i], false);
+                            results[2 * i + 1] = RunKeys(*engines[2 * i + 1], true);
+                        }
+                    });
+                }
+                for (auto& t : threads)
+                {
+                    t.join();
+                }
+                elapsed[run] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+                for (unsigned int i = 0; i < 2 * threadCount; i++)
+                {
+                    VERIFY_ARE_EQUAL(expected[i & 1], results[i], L"Verify an engine sharing its thread and the process gets the same result");
+                }
+            }
+
+            // Every thread does the same work, with linear scaling cores threads take as long as one.
+            wstringstream message;
+            message << L"1 thread " << elapsed[0] << L"ms, " << cores << L" threads " << elapsed[1] << L"ms, speedup "
+                    << cores * elapsed[0] / elapsed[1];
+            Logger::WriteMessage(message.str().c_str());
+        }
+
+        TEST_METHOD(TestIntegerModeWords)
+        {
+            // Integer mode works on the word, negative numbers in 2's complement form.
+            CCalcEngine engine(false, true, m_resourceProvider.get(), nullptr, nullptr);
+
+            VERIFY_ARE_EQUAL(
+                L"FFFF", RunProgrammerKeys(engine, { IDC_HEX, IDC_BYTE, IDC_1, IDC_SIGN, IDC_WORD }, 16), L"Verify -1 stays -1 in a wider word");
+            VERIFY_ARE_EQUAL(
+                L"CF",
+                RunProgrammerKeys(engine, { IDC_HEX, IDC_BYTE, IDC_F, IDC_0, IDC_NAND, IDC_3, IDC_C, IDC_EQU }, 16),
+                L"Verify NAND is truncated to the word");
+            VERIFY_ARE_EQUAL(
+                L"F800",
+                RunProgrammerKeys(engine, { IDC_HEX, IDC_WORD, IDC_8, IDC_0, IDC_0, IDC_0, IDC_RSHF, IDC_4, IDC_EQU }, 16),
+                L"Verify arithmetic right shift fills with the sign bit");
+            VERIFY_ARE_EQUAL(
+                L"-3",
+                RunProgrammerKeys(engine, { IDC_DEC, IDC_DWORD, IDC_7, IDC_SIGN, IDC_DIV, IDC_2, IDC_EQU }, 10),
+                L"Verify division truncates toward zero");
+            VERIFY_ARE_EQUAL(
+                L"-1",
+                RunProgrammerKeys(engine, { IDC_DEC, IDC_DWORD, IDC_7, IDC_SIGN, IDC_MOD, IDC_2, IDC_EQU }, 10),
+                L"Verify the remainder has the sign of the numerator");
+            VERIFY_ARE_EQUAL(
+                L"1", RunProgrammerKeys(engine, { IDC_HEX, IDC_BYTE, IDC_8, IDC_0, IDC_ROLC, IDC_ROLC }, 16), L"Verify rotate through carry");
+        }
+
     private:
         unique_ptr<CCalcEngine> m_calcEngine;
         shared_ptr<IResourceProvider> m_resourceProvider;
@@ -0,0 +1,2937 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <chrono>
+#include <thread>
+#include "Ratpack/ratpak.h"
+
+using namespace std;
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    // Deterministic mantissa generator so failures are reproducible.
+    vector<MANTTYPE> RandomMantissa(int32_t cdigit, uint32_t& seed)
+    {
+        vector<MANTTYPE> mant(cdigit);
+        for (auto& digit : mant)
+        {
+            // Two steps per digit, the low bits of the generator are poor.
+            seed = seed * 1103515245 + 12345;
+            uint64_t high = seed >> 16;
+            seed = seed * 1103515245 + 12345;
+            digit = static_cast<MANTTYPE>(((high << 16) | (seed >> 16)) & (BASEX - 1));
+        }
+        return mant;
+    }
+
+    vector<MANTTYPE> MulMant(const vector<MANTTYPE>& a, const vector<MANTTYPE>& b, int32_t karatsubaThreshold, int32_t toom3Threshold, int32_t nttThreshold = INT32_MAX)
+    {
+        int32_t savedKaratsuba = g_karatsubaThreshold;
+        int32_t savedToom3 = g_toom3Threshold;
+        int32_t savedNtt = g_nttThreshold;
+        g_karatsubaThreshold = karatsubaThreshold;
+        g_toom3Threshold = toom3Threshold;
+        g_nttThreshold = nttThreshold;
+
+        vector<MANTTYPE> c(a.size() + b.size());
+        _mulmantx(c.data(), a.data(), static_cast<int32_t>(a.size()), b.data(), static_cast<int32_t>(b.size()));
+
+        g_karatsubaThreshold = savedKaratsuba;
+        g_toom3Threshold = savedToom3;
+        g_nttThreshold = savedNtt;
+        return c;
+    }
+
+    PNUMBER NumberFromMantissa(const vector<MANTTYPE>& mant, int32_t sign, int32_t exp)
+    {
+        PNUMBER num = nullptr;
+        createnum(num, static_cast<int32_t>(mant.size()));
+        num->sign = sign;
+        num->exp = exp;
+        num->cdigit = static_cast<int32_t>(mant.size());
+        copy(mant.begin(), mant.end(), num->mant);
+        return num;
+    }
+
+    // Conversion out of BASEX at the given divide and conquer threshold, of
+    // every digit including those the exponent stands for.
+    PNUMBER ToRadix(PNUMBER a, uint32_t radix, int32_t threshold)
+    {
+        int32_t savedThreshold = g_radixConvThreshold;
+        g_radixConvThreshold = threshold;
+        PNUMBER result = nRadixxtonum(a, radix, INT32_MAX);
+        g_radixConvThreshold = savedThreshold;
+        return result;
+    }
+
+    // Conversion into BASEX at the given divide and conquer threshold.
+    PNUMBER FromRadix(PNUMBER a, uint32_t radix, int32_t threshold)
+    {
+        int32_t savedThreshold = g_radixConvThreshold;
+        g_radixConvThreshold = threshold;
+        PNUMBER result = numtonRadixx(a, radix);
+        g_radixConvThreshold = savedThreshold;
+        return result;
+    }
+
+    // Multiply by the radix and add, one digit at a time, the reference the
+    // chunked conversion into BASEX is checked against.
+    PNUMBER FromRadixDigitAtATime(PNUMBER a, uint32_t radix)
+    {
+        PNUMBER result = i32tonum(0, BASEX);
+        PNUMBER numRadix = i32tonum(radix, BASEX);
+        for (int32_t i = a->cdigit - 1; i >= 0; i--)
+        {
+            mulnumx(&result, numRadix);
+            PNUMBER digit = i32tonum(a->mant[i], BASEX);
+            addnum(&result, digit, BASEX);
+            destroynum(digit);
+        }
+        destroynum(numRadix);
+        return result;
+    }
+
+    // Random digits in radix, the most significant one nonzero.
+    PNUMBER RandomRadixNumber(int32_t cdigit, uint32_t radix, uint32_t& seed)
+    {
+        vector<MANTTYPE> mant = RandomMantissa(cdigit, seed);
+        for (auto& digit : mant)
+        {
+            digit %= radix;
+        }
+        mant[cdigit - 1] = max<MANTTYPE>(mant[cdigit - 1], 1);
+        return NumberFromMantissa(mant, 1, 0);
+    }
+
+    // A Taylor series evaluated term by term or by binary splitting, through
+    // the public function for the series where there is one.
+    PRAT SeriesRat(PRAT x, SERIES_TYPE series, int32_t precision, bool split)
+    {
+        int32_t savedThreshold = g_splitThreshold;
+        g_splitThreshold = split ? 0 : INT32_MAX;
+
+        PRAT result = nullptr;
+        DUPRAT(result, x);
+        switch (series)
+        {
+        case SERIES_EXP:
+            exprat(&result, 10, precision);
+            break;
+        case SERIES_SIN:
+            sinanglerat(&result, ANGLE_RAD, 10, precision);
+            break;
+        case SERIES_COS:
+            cosanglerat(&result, ANGLE_RAD, 10, precision);
+            break;
+        case SERIES_SINH:
+            sinhrat(&result, 10, precision);
+            break;
+        case SERIES_COSH:
+            coshrat(&result, 10, precision);
+            break;
+        case SERIES_ASIN:
+            asinrat(&result, 10, precision);
+            break;
+        case SERIES_ATAN:
+            atanrat(&result, 10, precision);
+            break;
+        default:
+            _splitrat(&result, series, precision);
+            break;
+        }
+
+        g_splitThreshold = savedThreshold;
+        return result;
+    }
+
+    // exp, sin or cos of x with or without argument reduction, through the
+    // public functions so rational arguments too long for binary splitting
+    // take the reduced Taylor series.
+    PRAT ReducedRat(PRAT x, SERIES_TYPE series, int32_t precision, bool reduce)
+    {
+        int32_t savedThreshold = g_reduceThreshold;
+        g_reduceThreshold = reduce ? 0 : INT32_MAX;
+        PRAT result = SeriesRat(x, series, precision, false);
+        g_reduceThreshold = savedThreshold;
+        return result;
+    }
+
+    // A rational with a long denominator close to p/q.
+    PRAT LongRat(int32_t p, int32_t q, int32_t digits)
+    {
+        PRAT x = i32torat(p);
+        PRAT denominator = i32torat(q);
+        divrat(&x, denominator, INT32_MAX);
+        PRAT nudge = i32torat(7);
+        ratpowi32(&nudge, -digits, INT32_MAX);
+        addrat(&x, nudge, INT32_MAX);
+        destroyrat(nudge);
+        destroyrat(denominator);
+        return x;
+    }
+
+    // Natural log by the Taylor series or the arithmetic-geometric mean.
+    PRAT LogRat(PRAT x, int32_t precision, bool agm)
+    {
+        int32_t savedThreshold = g_logAgmThreshold;
+        g_logAgmThreshold = agm ? 0 : INT32_MAX;
+        PRAT result = nullptr;
+        DUPRAT(result, x);
+        lograt(&result, precision);
+        g_logAgmThreshold = savedThreshold;
+        return result;
+    }
+
+    // True if a and b differ by less than 10^-digits.
+    bool RatsAgree(PRAT a, PRAT b, int32_t digits)
+    {
+        PRAT diff = nullptr;
+        DUPRAT(diff, a);
+        subrat(&diff, b, INT32_MAX);
+        diff->pp->sign = 1;
+        diff->pq->sign = 1;
+
+        PRAT bound = i32torat(10);
+        ratpowi32(&bound, -digits, INT32_MAX);
+        bool agree = rat_lt(diff, bound, INT32_MAX);
+        destroyrat(bound);
+        destroyrat(diff);
+        return agree;
+    }
+
+    PRAT SmallRat(int32_t p, int32_t q)
+    {
+        PRAT x = i32torat(p);
+        PRAT denominator = i32torat(q);
+        divrat(&x, denominator, INT32_MAX);
+        destroyrat(denominator);
+        return x;
+    }
+
+    // n! one multiply at a time, the reference the product tree is checked against.
+    PRAT SequentialFactorial(int32_t n)
+    {
+        PRAT fact = i32torat(1);
+        for (int32_t i = 2; i <= n; i++)
+        {
+            PNUMBER factor = Ui32tonum(i, BASEX);
+            mulnumx(&fact->pp, factor);
+            destroynum(factor);
+        }
+        return fact;
+    }
+
+    PRAT NumToRat(PNUMBER num)
+    {
+        PRAT x = nullptr;
+        createrat(x);
+        DUPNUM(x->pp, num);
+        DUPNUM(x->pq, num_one);
+        return x;
+    }
+
+    // root^power by one square per bit of the power, the reference the sliding
+    // windows are checked against.
+    PNUMBER BinaryPower(PNUMBER root, int32_t power)
+    {
+        PNUMBER result = i32tonum(1, BASEX);
+        PNUMBER square = nullptr;
+        DUPNUM(square, root);
+        for (; power > 0; power >>= 1)
+        {
+            if (power & 1)
+            {
+                mulnumx(&result, square);
+            }
+            mulnumx(&square, square);
+        }
+        destroynum(square);
+        return result;
+    }
+
+    PRAT Ui64ToRat(uint64_t value)
+    {
+        vector<MANTTYPE> mant = { static_cast<MANTTYPE>(value) };
+        if (value >> BASEXPWR)
+        {
+            mant.push_back(static_cast<MANTTYPE>(value >> BASEXPWR));
+        }
+        PNUMBER num = NumberFromMantissa(mant, 1, 0);
+        PRAT x = NumToRat(num);
+        destroynum(num);
+        return x;
+    }
+
+    // The same value over a denominator of three, which keeps the logical
+    // operations and shifts off the integer kernels.
+    PRAT OverThree(PRAT x)
+    {
+        PRAT y = nullptr;
+        DUPRAT(y, x);
+        PNUMBER three = i32tonum(3, BASEX);
+        mulnumx(&y->pp, three);
+        mulnumx(&y->pq, three);
+        destroynum(three);
+        return y;
+    }
+
+    // Plain Euclid on remnum, the reference the gcd kernels are checked against.
+    PNUMBER EuclidGcd(PNUMBER a, PNUMBER b)
+    {
+        PNUMBER larger = nullptr;
+        PNUMBER smaller = nullptr;
+        DUPNUM(larger, a);
+        DUPNUM(smaller, b);
+        larger->sign = 1;
+        smaller->sign = 1;
+        while (!zernum(smaller))
+        {
+            remnum(&larger, smaller, BASEX);
+            swap(larger, smaller);
+        }
+        destroynum(smaller);
+        return larger;
+    }
+
+    // Sum of 1/k for k = 1..terms without any gcd normalization, which gives
+    // the kind of numerator and denominator long expression chains produce.
+    PRAT HarmonicSum(int32_t terms)
+    {
+        PRAT sum = nullptr;
+        DUPRAT(sum, rat_zero);
+        for (int32_t k = 1; k <= terms; k++)
+        {
+            PRAT term = nullptr;
+            DUPRAT(term, rat_one);
+            PRAT denominator = i32torat(k);
+            divrat(&term, denominator, INT32_MAX / 2);
+            addrat(&sum, term, INT32_MAX / 2);
+            destroyrat(denominator);
+            destroyrat(term);
+        }
+        return sum;
+    }
+
+    // Sign of a - b by subtraction, the reference ratcmp is checked against.
+    int32_t SubtractionSign(PRAT a, PRAT b)
+    {
+        PRAT diff = nullptr;
+        DUPRAT(diff, a);
+        subrat(&diff, b, INT32_MAX);
+        int32_t sign = zernum(diff->pp) ? 0 : SIGN(diff);
+        destroyrat(diff);
+        return sign;
+    }
+
+    // x - 2pi*int(x/2pi) with 2pi from asin at the precision plus the size of
+    // x, the way scale2pi used to, the reference the cached reduction is
+    // checked against.
+    PRAT Scale2PiBySeries(PRAT x, int32_t precision)
+    {
+        int32_t wide = precision + g_ratio * max(LOGRAT2(x), 0) + 2 * g_ratio;
+        PRAT twoPi = nullptr;
+        DUPRAT(twoPi, rat_half);
+        asinrat(&twoPi, 10, wide);
+        mulrat(&twoPi, rat_six, wide);
+        mulrat(&twoPi, rat_two, wide);
+
+        PRAT turns = nullptr;
+        DUPRAT(turns, x);
+        divrat(&turns, twoPi, wide);
+        intrat(&turns, 10, wide);
+        mulrat(&turns, twoPi, wide);
+        PRAT result = nullptr;
+        DUPRAT(result, x);
+        subrat(&result, turns, wide);
+        destroyrat(turns);
+        destroyrat(twoPi);
+        return result;
+    }
+
+    // The same number digit for digit, not merely the same value.
+    bool SameNumber(PNUMBER a, PNUMBER b)
+    {
+        return a->sign == b->sign && a->cdigit == b->cdigit && a->exp == b->exp && equal(a->mant, a->mant + a->cdigit, b->mant);
+    }
+
+    // A copy of a claiming no room to spare, so arithmetic on it allocates
+    // its result the way it always did.
+    PNUMBER TightCopy(PNUMBER a)
+    {
+        PNUMBER copy = NumberFromMantissa(vector<MANTTYPE>(a->mant, a->mant + a->cdigit), a->sign, a->exp);
+        copy->cdigitmax = copy->cdigit;
+        return copy;
+    }
+
+    // Sum of x^k/k! for the given number of terms, updated the way NEXTTERM
+    // updates a series.
+    void ExpTerms(PRAT* psum, PRAT* pterm, PNUMBER* pn, PRAT x, int32_t terms, int32_t precision)
+    {
+        for (int32_t i = 0; i < terms; i++)
+        {
+            mulrat(pterm, x, precision);
+            mulnumx(&((*pterm)->pq), *pn);
+            addrat(psum, *pterm, precision);
+            addnum(pn, num_one, BASEX);
+        }
+    }
+
+    // Drops the low digits of p and q the way trimit did before mantissas
+    // could start part way into their buffer, by moving the digits down.
+    void TrimByMoving(PRAT x, int32_t precision)
+    {
+        int32_t trim = g_ratio * (min(x->pp->cdigit + x->pp->exp, x->pq->cdigit + x->pq->exp) - 1) - precision;
+        if (trim > g_ratio)
+        {
+            trim /= g_ratio;
+            for (PNUMBER num : { x->pp, x->pq })
+            {
+                if (trim > num->exp)
+                {
+                    int32_t drop = trim - num->exp;
+                    memmove(num->mant, num->mant + drop, (num->cdigit - drop) * sizeof(MANTTYPE));
+                    num->cdigit -= drop;
+                    num->exp += drop;
+                }
+                num->exp -= trim;
+            }
+        }
+        trim = min(x->pp->exp, x->pq->exp);
+        x->pp->exp -= trim;
+        x->pq->exp -= trim;
+    }
+}
+
+namespace CalculatorEngineTests
+{
+    TEST_CLASS(RatpackTests)
+    {
+    public:
+        TEST_CLASS_INITIALIZE(CommonSetup)
+        {
+            ChangeConstants(10, 128);
+        }
+
+        TEST_METHOD(TestMulMantMatchesSchoolbook)
+        {
+            uint32_t seed = 1;
+            const int32_t sizes[] = { 1, 2, 3, 7, 16, 33, 64, 100, 257, 600 };
+            for (int32_t ca : sizes)
+            {
+                for (int32_t cb : sizes)
+                {
+                    auto a = RandomMantissa(ca, seed);
+                    auto b = RandomMantissa(cb, seed);
+                    auto expected = MulMant(a, b, INT32_MAX, INT32_MAX);
+
+                    VERIFY_IS_TRUE(expected == MulMant(a, b, 4, INT32_MAX), L"Verify Karatsuba matches schoolbook");
+                    VERIFY_IS_TRUE(expected == MulMant(a, b, 4, 9), L"Verify Toom-3 matches schoolbook");
+                    VERIFY_IS_TRUE(expected == MulMant(a, b, KARATSUBA_THRESHOLD, TOOM3_THRESHOLD), L"Verify default thresholds match schoolbook");
+                }
+
+                auto a = RandomMantissa(ca, seed);
+                auto expected = MulMant(a, a, INT32_MAX, INT32_MAX);
+                VERIFY_IS_TRUE(expected == MulMant(a, a, 4, 9), L"Verify squaring matches schoolbook");
+            }
+        }
+
+        TEST_METHOD(TestMulMantAllOnes)
+        {
+            // Every digit at its maximum pushes every carry path to its limit.
+            for (int32_t cdigit : { 5, 40, 300 })
+            {
+                vector<MANTTYPE> a(cdigit, static_cast<MANTTYPE>(BASEX - 1));
+                auto expected = MulMant(a, a, INT32_MAX, INT32_MAX);
+                VERIFY_IS_TRUE(expected == MulMant(a, a, 4, 9));
+                VERIFY_IS_TRUE(expected == MulMant(a, vector<MANTTYPE>(a), 4, 9));
+            }
+        }
+
+        TEST_METHOD(TestMulNumLargeOperands)
+        {
+            // (BASEX^n - 1)^2 == BASEX^2n - 2*BASEX^n + 1, built through mulnumx
+            // so the NUMBER bookkeeping around the kernels is covered too.
+            const int32_t n = 500;
+            PNUMBER a = nullptr;
+            createnum(a, n);
+            a->sign = -1;
+            a->cdigit = n;
+            a->exp = 3;
+            for (int32_t i = 0; i < n; i++)
+            {
+                a->mant[i] = static_cast<MANTTYPE>(BASEX - 1);
+            }
+
+            PNUMBER c = nullptr;
+            DUPNUM(c, a);
+            mulnumx(&c, a);
+
+            VERIFY_ARE_EQUAL(1, c->sign);
+            VERIFY_ARE_EQUAL(6, c->exp);
+            VERIFY_ARE_EQUAL(2 * n, c->cdigit);
+            VERIFY_ARE_EQUAL(1u, c->mant[0]);
+            VERIFY_ARE_EQUAL(static_cast<MANTTYPE>(BASEX - 2), c->mant[n]);
+            VERIFY_ARE_EQUAL(static_cast<MANTTYPE>(BASEX - 1), c->mant[2 * n - 1]);
+
+            destroynum(c);
+            destroynum(a);
+        }
+
+        TEST_METHOD(TestMulNumNttMatchesToom3)
+        {
+            // mulnumx with the NTT tier forced on must match the product
+            // computed without it, for lopsided operands and squares too.
+            uint32_t seed = 3;
+            const pair<int32_t, int32_t> sizes[] = { { 1, 1 }, { 5, 3 }, { 100, 100 }, { 1000, 37 }, { 2500, 2400 }, { 4000, 4000 } };
+            for (const auto& size : sizes)
+            {
+                PNUMBER a = NumberFromMantissa(RandomMantissa(size.first, seed), -1, 2);
+                PNUMBER b = NumberFromMantissa(RandomMantissa(size.second, seed), 1, -7);
+
+                int32_t savedNtt = g_nttThreshold;
+                PNUMBER expected = nullptr;
+                PNUMBER actual = nullptr;
+                PNUMBER square = nullptr;
+                PNUMBER expectedsquare = nullptr;
+                DUPNUM(expected, a);
+                DUPNUM(actual, a);
+                DUPNUM(square, b);
+                DUPNUM(expectedsquare, b);
+
+                g_nttThreshold = INT32_MAX;
+                mulnumx(&expected, b);
+                mulnumx(&expectedsquare, b);
+                g_nttThreshold = 1;
+                mulnumx(&actual, b);
+                mulnumx(&square, b);
+                g_nttThreshold = savedNtt;
+
+                VERIFY_IS_TRUE(equnum(expected, actual), L"Verify NTT product matches");
+                VERIFY_ARE_EQUAL(expected->sign, actual->sign);
+                VERIFY_ARE_EQUAL(expected->exp, actual->exp);
+                VERIFY_IS_TRUE(equnum(expectedsquare, square), L"Verify NTT square matches");
+
+                destroynum(expectedsquare);
+                destroynum(square);
+                destroynum(actual);
+                destroynum(expected);
+                destroynum(b);
+                destroynum(a);
+            }
+        }
+
+        TEST_METHOD(TestDivMantNewtonMatchesSchoolbook)
+        {
+            uint32_t seed = 5;
+            int32_t savedThreshold = g_newtonDivThreshold;
+            const pair<int32_t, int32_t> sizes[] = { { 1, 1 }, { 20, 9 }, { 40, 20 }, { 200, 100 }, { 1000, 30 }, { 1500, 700 }, { 2100, 1000 } };
+            for (const auto& size : sizes)
+            {
+                const int32_t cn = size.first;
+                const int32_t cb = size.second;
+                auto n = RandomMantissa(cn, seed);
+                auto b = RandomMantissa(cb, seed);
+                b[cb - 1] |= 1;
+
+                vector<MANTTYPE> expectedq(cn - cb + 1);
+                vector<MANTTYPE> expectedr(cb);
+                _divmantbase(expectedq.data(), expectedr.data(), n.data(), cn, b.data(), cb, BASEX);
+
+                // Check the schoolbook result is right, n == q*b + r and r < b.
+                vector<MANTTYPE> check(cn + 1);
+                _mulmantx(check.data(), expectedq.data(), cn - cb + 1, b.data(), cb);
+                _addmant(check.data(), cn + 1, expectedr.data(), cb);
+                VERIFY_ARE_EQUAL(0, _cmpmant(check.data(), cn + 1, n.data(), cn));
+                VERIFY_IS_LESS_THAN(_cmpmant(expectedr.data(), cb, b.data(), cb), 0);
+
+                vector<MANTTYPE> q(cn - cb + 1);
+                vector<MANTTYPE> r(cb);
+                g_newtonDivThreshold = 8;
+                _divmantx(q.data(), r.data(), n.data(), cn, b.data(), cb);
+                g_newtonDivThreshold = savedThreshold;
+
+                VERIFY_IS_TRUE(expectedq == q, L"Verify Newton quotient matches schoolbook");
+                VERIFY_IS_TRUE(expectedr == r, L"Verify Newton remainder matches schoolbook");
+            }
+        }
+
+        TEST_METHOD(TestDivMantRadixMatchesSchoolbook)
+        {
+            // Division in radix done in BASEX, with schoolbook and Newton
+            // division there, against long division in radix.
+            uint32_t seed = 13;
+            int32_t savedThreshold = g_newtonDivThreshold;
+            const pair<int32_t, int32_t> sizes[] = { { 1, 1 }, { 30, 30 }, { 40, 17 }, { 300, 100 }, { 1000, 40 }, { 3000, 1400 } };
+            for (uint32_t radix : { 2u, 8u, 10u, 16u })
+            {
+                for (const auto& size : sizes)
+                {
+                    const int32_t cn = size.first;
+                    const int32_t cb = size.second;
+                    PNUMBER n = RandomRadixNumber(cn, radix, seed);
+                    PNUMBER b = RandomRadixNumber(cb, radix, seed);
+
+                    vector<MANTTYPE> expectedq(cn - cb + 1);
+                    vector<MANTTYPE> expectedr(cb);
+                    _divmantbase(expectedq.data(), expectedr.data(), n->mant, cn, b->mant, cb, radix);
+                    bool fexpectedexact = all_of(expectedr.begin(), expectedr.end(), [](MANTTYPE digit) { return digit == 0; });
+
+                    for (int32_t threshold : { savedThreshold, 8 })
+                    {
+                        vector<MANTTYPE> q(cn - cb + 1);
+                        vector<MANTTYPE> r(cb);
+                        g_newtonDivThreshold = threshold;
+                        bool fexact = _divmantradix(q.data(), r.data(), n->mant, cn, b->mant, cb, radix);
+                        g_newtonDivThreshold = savedThreshold;
+
+                        VERIFY_IS_TRUE(expectedq == q, L"Verify quotient in BASEX matches long division");
+                        VERIFY_IS_TRUE(expectedr == r, L"Verify remainder in BASEX matches long division");
+                        VERIFY_ARE_EQUAL(fexpectedexact, fexact);
+                    }
+
+                    destroynum(b);
+                    destroynum(n);
+                }
+            }
+
+            // An exact quotient keeps only its significant digits either way.
+            PNUMBER a = RandomRadixNumber(200, 10, seed);
+            PNUMBER b = RandomRadixNumber(90, 10, seed);
+            PNUMBER product = nullptr;
+            DUPNUM(product, a);
+            mulnum(&product, b, 10);
+            int32_t savedRadixThreshold = g_radixDivThreshold;
+            for (int32_t threshold : { INT32_MAX, RADIX_DIV_THRESHOLD })
+            {
+                PNUMBER quotient = nullptr;
+                DUPNUM(quotient, product);
+                g_radixDivThreshold = threshold;
+                divnum(&quotient, b, 10, 10);
+                g_radixDivThreshold = savedRadixThreshold;
+                VERIFY_IS_TRUE(equnum(quotient, a));
+                VERIFY_ARE_EQUAL(a->cdigit, quotient->cdigit);
+                destroynum(quotient);
+            }
+            destroynum(product);
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(TestDivNumExactAndTruncated)
+        {
+            // An exact division keeps only the significant digits, as gcdrat expects.
+            uint32_t seed = 9;
+            PNUMBER a = NumberFromMantissa(RandomMantissa(50, seed), 1, 0);
+            PNUMBER b = NumberFromMantissa(RandomMantissa(20, seed), -1, 0);
+            PNUMBER product = nullptr;
+            DUPNUM(product, a);
+            mulnumx(&product, b);
+            divnumx(&product, b, 10);
+            VERIFY_IS_TRUE(equnum(product, a));
+            VERIFY_ARE_EQUAL(1, product->sign);
+            VERIFY_ARE_EQUAL(a->cdigit, product->cdigit);
+            VERIFY_ARE_EQUAL(0, product->exp);
+            destroynum(product);
+            destroynum(b);
+            destroynum(a);
+
+            // 1/3 in radix 10 truncates to precision + 2 digits counting from
+            // the units digit, which is zero and dropped.
+            PNUMBER third = i32tonum(1, 10);
+            PNUMBER three = i32tonum(3, 10);
+            divnum(&third, three, 10, 8);
+            VERIFY_ARE_EQUAL(9, third->cdigit);
+            VERIFY_ARE_EQUAL(-9, third->exp);
+            for (int32_t i = 0; i < third->cdigit; i++)
+            {
+                VERIFY_ARE_EQUAL(3u, third->mant[i]);
+            }
+            destroynum(three);
+            destroynum(third);
+        }
+
+        TEST_METHOD(TestGcdMatchesEuclid)
+        {
+            uint32_t seed = 17;
+            int32_t savedThreshold = g_hgcdThreshold;
+            const int32_t sizes[] = { 1, 2, 3, 10, 80, 300, 700 };
+            for (int32_t threshold : { HGCD_THRESHOLD, 8 })
+            {
+                g_hgcdThreshold = threshold;
+                for (int32_t size : sizes)
+                {
+                    // A common factor makes sure the gcd is not usually one.
+                    PNUMBER common = NumberFromMantissa(RandomMantissa(max(1, size / 3), seed), 1, 0);
+                    PNUMBER a = NumberFromMantissa(RandomMantissa(size, seed), -1, 0);
+                    PNUMBER b = NumberFromMantissa(RandomMantissa(size + size / 4, seed), 1, 0);
+                    mulnumx(&a, common);
+                    mulnumx(&b, common);
+
+                    PNUMBER expected = EuclidGcd(a, b);
+                    PNUMBER actual = gcd(a, b);
+                    VERIFY_IS_TRUE(equnum(expected, actual), L"Verify gcd matches Euclid");
+                    VERIFY_ARE_EQUAL(1, actual->sign);
+
+                    destroynum(actual);
+                    destroynum(expected);
+                    destroynum(b);
+                    destroynum(a);
+                    destroynum(common);
+                }
+            }
+            g_hgcdThreshold = savedThreshold;
+
+            // The numerator and denominator of a long chain of additions.
+            for (int32_t terms : { 50, 200 })
+            {
+                PRAT sum = HarmonicSum(terms);
+                PNUMBER expected = EuclidGcd(sum->pp, sum->pq);
+                PNUMBER actual = gcd(sum->pp, sum->pq);
+                VERIFY_IS_TRUE(equnum(expected, actual), L"Verify gcd of a sum matches Euclid");
+                destroynum(actual);
+                destroynum(expected);
+                destroyrat(sum);
+            }
+        }
+
+        TEST_METHOD(TestGcdExponentsAndZero)
+        {
+            // gcd(6 * BASEX^3, 9 * BASEX) == 3 * BASEX
+            PNUMBER a = i32tonum(6, BASEX);
+            PNUMBER b = i32tonum(9, BASEX);
+            a->exp = 3;
+            b->exp = 1;
+            PNUMBER g = gcd(a, b);
+            VERIFY_ARE_EQUAL(1, g->cdigit);
+            VERIFY_ARE_EQUAL(3u, g->mant[0]);
+            VERIFY_ARE_EQUAL(1, g->exp);
+            destroynum(g);
+
+            // gcd(0, b) is a new copy of b.
+            PNUMBER zero = i32tonum(0, BASEX);
+            g = gcd(zero, b);
+            VERIFY_IS_TRUE(g != b);
+            VERIFY_IS_TRUE(equnum(g, b));
+            destroynum(g);
+            destroynum(zero);
+
+            destroynum(b);
+            destroynum(a);
+        }
+
+        TEST_METHOD(TestPoolReusesZeroedNumbers)
+        {
+            PNUMBER num = nullptr;
+            createnum(num, 20);
+            fill(num->mant, num->mant + 21, MANTTYPE(~0u));
+            num->sign = -1;
+            num->cdigit = 21;
+            num->exp = 5;
+            destroynum(num);
+
+            // The same size class must come back zeroed, whether or not it
+            // was the block just freed.
+            createnum(num, 17);
+            VERIFY_ARE_EQUAL(0, num->sign);
+            VERIFY_ARE_EQUAL(0, num->cdigit);
+            VERIFY_ARE_EQUAL(0, num->exp);
+            VERIFY_IS_TRUE(all_of(num->mant, num->mant + 18, [](MANTTYPE digit) { return digit == 0; }));
+            destroynum(num);
+
+            // Sizes past the largest class still work.
+            createnum(num, 100000);
+            num->mant[100000] = 1;
+            destroynum(num);
+        }
+
+        TEST_METHOD(TestPoolHitRateExpAndSin)
+        {
+            PRAT x = nullptr;
+            auto evaluate = [&x]() {
+                DUPRAT(x, rat_one);
+                divrat(&x, rat_two, 128);
+                exprat(&x, 10, 128);
+                sinanglerat(&x, ANGLE_RAD, 10, 128);
+                destroyrat(x);
+            };
+
+            // Warm up the freelists, then count the traffic of a second run.
+            evaluate();
+            resetpoolstats();
+            evaluate();
+
+            POOLSTATS stats;
+            getpoolstats(&stats);
+            VERIFY_IS_TRUE(stats.cnumcreate > 0);
+            VERIFY_IS_TRUE(stats.cratcreate > 0);
+            VERIFY_IS_TRUE(stats.cnumhit <= stats.cnumcreate);
+            VERIFY_IS_TRUE(stats.crathit <= stats.cratcreate);
+
+            wstringstream message;
+            message << L"numbers " << stats.cnumcreate << L" (" << stats.cnumhit << L" hits) rats " << stats.cratcreate << L" (" << stats.crathit
+                    << L" hits) heap allocations " << stats.cheapalloc << L" frees " << stats.cheapfree;
+            Logger::WriteMessage(message.str().c_str());
+
+#if !defined(RATPAK_NO_POOL)
+            // Heap traffic must be at least an order of magnitude below the number of creations.
+            VERIFY_IS_TRUE(stats.cheapalloc * 10 <= stats.cnumcreate + stats.cratcreate);
+#else
+            VERIFY_ARE_EQUAL(stats.cnumcreate + stats.cratcreate, stats.cheapalloc);
+#endif
+        }
+
+        TEST_METHOD(TestRadixConversionRoundTrip)
+        {
+            uint32_t seed = 5;
+            for (uint32_t radix : { 2u, 3u, 7u, 8u, 10u, 16u, 36u, 64u })
+            {
+                for (int32_t cdigit : { 1, 2, 5, 47, 48, 100, 333 })
+                {
+                    PNUMBER a = NumberFromMantissa(RandomMantissa(cdigit, seed), 1, 0);
+                    a->mant[cdigit - 1] |= 1;
+
+                    for (int32_t threshold : { 2, RADIX_CONV_THRESHOLD, INT32_MAX })
+                    {
+                        PNUMBER converted = ToRadix(a, radix, threshold);
+                        VERIFY_IS_TRUE(all_of(converted->mant, converted->mant + converted->cdigit, [radix](MANTTYPE digit) { return digit < radix; }));
+                        VERIFY_ARE_NOT_EQUAL(0u, converted->mant[converted->cdigit - 1]);
+
+                        PNUMBER back = numtonRadixx(converted, radix);
+                        VERIFY_IS_TRUE(equnum(a, back), L"Verify conversion to the radix and back is exact");
+                        destroynum(back);
+                        destroynum(converted);
+                    }
+                    destroynum(a);
+                }
+            }
+        }
+
+        TEST_METHOD(TestRadixConversionZeroRuns)
+        {
+            // Powers of the radix, and one less, have long runs of equal digits
+            // that must be padded correctly across every split.
+            for (uint32_t radix : { 3u, 10u })
+            {
+                for (int32_t power : { 1, 9, 500, 2000 })
+                {
+                    PNUMBER a = i32tonum(radix, BASEX);
+                    numpowi32x(&a, power);
+                    PNUMBER converted = ToRadix(a, radix, 2);
+                    VERIFY_ARE_EQUAL(power + 1, converted->cdigit);
+                    VERIFY_ARE_EQUAL(1u, converted->mant[power]);
+                    VERIFY_IS_TRUE(all_of(converted->mant, converted->mant + power, [](MANTTYPE digit) { return digit == 0; }));
+                    destroynum(converted);
+
+                    PNUMBER one = i32tonum(1, BASEX);
+                    one->sign = -1;
+                    addnum(&a, one, BASEX);
+                    converted = ToRadix(a, radix, 2);
+                    VERIFY_ARE_EQUAL(power, converted->cdigit);
+                    VERIFY_IS_TRUE(all_of(converted->mant, converted->mant + power, [radix](MANTTYPE digit) { return digit == radix - 1; }));
+                    destroynum(converted);
+                    destroynum(one);
+                    destroynum(a);
+                }
+            }
+
+            PNUMBER zero = i32tonum(0, BASEX);
+            PNUMBER converted = ToRadix(zero, 10, 2);
+            VERIFY_IS_TRUE(zernum(converted));
+            destroynum(converted);
+            destroynum(zero);
+        }
+
+        TEST_METHOD(TestRadixInputMatchesDigitAtATime)
+        {
+            uint32_t seed = 9;
+            for (uint32_t radix : { 2u, 3u, 8u, 10u, 16u, 36u, 64u })
+            {
+                for (int32_t cdigit : { 1, 8, 9, 10, 31, 300, 1000, 5000 })
+                {
+                    PNUMBER a = RandomRadixNumber(cdigit, radix, seed);
+                    PNUMBER expected = FromRadixDigitAtATime(a, radix);
+                    for (int32_t threshold : { 1, 2, RADIX_CONV_THRESHOLD, INT32_MAX })
+                    {
+                        PNUMBER actual = FromRadix(a, radix, threshold);
+                        VERIFY_IS_TRUE(equnum(expected, actual), L"Verify chunked conversion into BASEX matches digit at a time");
+                        destroynum(actual);
+                    }
+                    destroynum(expected);
+                    destroynum(a);
+                }
+            }
+        }
+
+        TEST_METHOD(TestStringToRatLongOperand)
+        {
+            // A long operand with an exponent and a fraction parses to the same
+            // rational however it is split.
+            wstring digits(3000, L'9');
+            PRAT whole = StringToRat(false, digits, false, L"", 10, 128);
+            PRAT one = i32torat(1);
+            addrat(&whole, one, INT32_MAX);
+
+            PRAT expected = i32torat(10);
+            ratpowi32(&expected, 3000, INT32_MAX);
+            VERIFY_IS_TRUE(rat_equ(expected, whole, INT32_MAX));
+
+            PRAT scaled = StringToRat(true, L"1" + wstring(2999, L'0'), true, L"2999", 10, 128);
+            VERIFY_IS_TRUE(rat_equ(scaled, rat_neg_one, 128));
+
+            destroyrat(scaled);
+            destroyrat(expected);
+            destroyrat(one);
+            destroyrat(whole);
+        }
+
+        TEST_METHOD(TestSplitSeriesMatchesTaylor)
+        {
+            const SERIES_TYPE taylorSeries[] = { SERIES_EXP, SERIES_SIN, SERIES_COS, SERIES_SINH, SERIES_COSH, SERIES_ASIN, SERIES_ATAN };
+            const pair<int32_t, int32_t> arguments[] = { { 1, 2 }, { -1, 3 }, { 5, 7 }, { 1, 1000 }, { -17, 20 }, { 123456789, 1000000000 } };
+            for (int32_t precision : { 30, 200 })
+            {
+                for (SERIES_TYPE series : taylorSeries)
+                {
+                    for (auto [p, q] : arguments)
+                    {
+                        PRAT x = SmallRat(p, q);
+                        PRAT taylor = SeriesRat(x, series, precision, false);
+                        PRAT split = SeriesRat(x, series, precision, true);
+                        VERIFY_IS_TRUE(RatsAgree(taylor, split, precision - 2), L"Verify binary splitting agrees with the Taylor series");
+                        destroyrat(split);
+                        destroyrat(taylor);
+                        destroyrat(x);
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(TestSplitSeriesInverseHyperbolic)
+        {
+            // asinh(x) = ln(x + sqrt(x^2 + 1)) and 2 atanh(x) = ln((1 + x) / (1 - x)),
+            // checked at 3/4 and 3/5 where the logs are of integers.
+            PRAT x = SmallRat(3, 4);
+            PRAT asinh = SeriesRat(x, SERIES_ASINH, 100, true);
+            PRAT expected = i32torat(2);
+            lograt(&expected, 100);
+            VERIFY_IS_TRUE(RatsAgree(asinh, expected, 98));
+
+            destroyrat(x);
+            x = SmallRat(3, 5);
+            PRAT atanh = SeriesRat(x, SERIES_ATANH, 100, true);
+            mulrat(&atanh, rat_two, 100);
+            destroyrat(expected);
+            expected = i32torat(4);
+            lograt(&expected, 100);
+            VERIFY_IS_TRUE(RatsAgree(atanh, expected, 98));
+
+            destroyrat(atanh);
+            destroyrat(expected);
+            destroyrat(asinh);
+            destroyrat(x);
+        }
+
+        TEST_METHOD(TestSplitSeriesConstants)
+        {
+            // The constants ChangeConstants builds by binary splitting.
+            PRAT x = SmallRat(1, 2);
+            PRAT sixAsinHalf = SeriesRat(x, SERIES_ASIN, 128, true);
+            mulrat(&sixAsinHalf, rat_six, 128);
+            VERIFY_IS_TRUE(RatsAgree(sixAsinHalf, pi, 126));
+
+            PRAT e = SeriesRat(rat_one, SERIES_EXP, 128, true);
+            VERIFY_IS_TRUE(RatsAgree(e, rat_exp, 126));
+
+            PRAT ln2 = i32torat(2);
+            lograt(&ln2, 128);
+            VERIFY_IS_TRUE(RatsAgree(ln2, ln_two, 126));
+
+            PRAT ln10 = i32torat(10);
+            lograt(&ln10, 128);
+            VERIFY_IS_TRUE(RatsAgree(ln10, ln_ten, 126));
+
+            destroyrat(ln10);
+            destroyrat(ln2);
+            destroyrat(e);
+            destroyrat(sixAsinHalf);
+            destroyrat(x);
+        }
+
+        TEST_METHOD(TestReducedSeriesMatchesTaylor)
+        {
+            const SERIES_TYPE reducedSeries[] = { SERIES_EXP, SERIES_SIN, SERIES_COS };
+            const pair<int32_t, int32_t> arguments[] = { { 1, 2 }, { -1, 3 }, { 5, 7 }, { 1, 1000 }, { -17, 20 }, { 99, 100 } };
+            for (int32_t precision : { 30, 200, 600 })
+            {
+                for (SERIES_TYPE series : reducedSeries)
+                {
+                    for (auto [p, q] : arguments)
+                    {
+                        PRAT x = LongRat(p, q, precision);
+                        PRAT taylor = ReducedRat(x, series, precision, false);
+                        PRAT reduced = ReducedRat(x, series, precision, true);
+                        VERIFY_IS_TRUE(RatsAgree(taylor, reduced, precision - 2), L"Verify argument reduction agrees with the Taylor series");
+                        destroyrat(reduced);
+                        destroyrat(taylor);
+                        destroyrat(x);
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(TestReducedSeriesIdentities)
+        {
+            // sin^2 + cos^2 = 1 and exp(x) exp(-x) = 1 where the reduction steps
+            // differ between the two factors.
+            for (int32_t precision : { 100, 500 })
+            {
+                PRAT x = LongRat(3, 4, precision);
+                PRAT sin = ReducedRat(x, SERIES_SIN, precision, true);
+                PRAT cos = ReducedRat(x, SERIES_COS, precision, true);
+                mulrat(&sin, sin, INT32_MAX);
+                mulrat(&cos, cos, INT32_MAX);
+                addrat(&sin, cos, INT32_MAX);
+                VERIFY_IS_TRUE(RatsAgree(sin, rat_one, precision - 2));
+
+                PRAT exp = ReducedRat(x, SERIES_EXP, precision, true);
+                x->pp->sign = -1;
+                PRAT expneg = ReducedRat(x, SERIES_EXP, precision, true);
+                mulrat(&exp, expneg, INT32_MAX);
+                VERIFY_IS_TRUE(RatsAgree(exp, rat_one, precision - 2));
+
+                destroyrat(expneg);
+                destroyrat(exp);
+                destroyrat(cos);
+                destroyrat(sin);
+                destroyrat(x);
+            }
+        }
+
+        TEST_METHOD(TestSqrtMantExact)
+        {
+            // Squares, squares less one, whose root is one less with remainder
+            // 2r - 2, and squares plus 2r, the largest radicand with root r.
+            uint32_t seed = 29;
+            for (int32_t cdigit : { 1, 2, 3, 5, 17, 64, 300, 1000 })
+            {
+                vector<MANTTYPE> root = RandomMantissa(cdigit, seed);
+                root[cdigit - 1] = max<MANTTYPE>(root[cdigit - 1], 1);
+                vector<MANTTYPE> square = MulMant(root, root, KARATSUBA_THRESHOLD, TOOM3_THRESHOLD);
+                int32_t csquare = static_cast<int32_t>(square.size());
+
+                for (int32_t offset : { -1, 0, 1 })
+                {
+                    vector<MANTTYPE> n = square;
+                    vector<MANTTYPE> expectedRoot = root;
+                    vector<MANTTYPE> expectedRem((csquare + 1) / 2 + 1, 0);
+                    if (offset < 0)
+                    {
+                        MANTTYPE one = 1;
+                        _submant(n.data(), csquare, &one, 1);
+                        _submant(expectedRoot.data(), cdigit, &one, 1);
+                        copy(root.begin(), root.end(), expectedRem.begin());
+                        _addmant(expectedRem.data(), static_cast<int32_t>(expectedRem.size()), root.data(), cdigit);
+                        MANTTYPE two = 2;
+                        _submant(expectedRem.data(), static_cast<int32_t>(expectedRem.size()), &two, 1);
+                    }
+                    else if (offset > 0)
+                    {
+                        _addmant(n.data(), csquare, root.data(), cdigit);
+                        _addmant(n.data(), csquare, root.data(), cdigit);
+                        copy(root.begin(), root.end(), expectedRem.begin());
+                        _addmant(expectedRem.data(), static_cast<int32_t>(expectedRem.size()), root.data(), cdigit);
+                    }
+
+                    vector<MANTTYPE> actualRoot((csquare + 1) / 2, 0);
+                    vector<MANTTYPE> actualRem((csquare + 1) / 2 + 1, 0);
+                    _sqrtmantx(actualRoot.data(), actualRem.data(), n.data(), csquare);
+                    expectedRoot.resize(actualRoot.size(), 0);
+                    VERIFY_IS_TRUE(expectedRoot == actualRoot, L"Verify the root of a square");
+                    VERIFY_IS_TRUE(expectedRem == actualRem, L"Verify the remainder of a square");
+                }
+            }
+        }
+
+        TEST_METHOD(TestSqrtRat)
+        {
+            for (int32_t precision : { 30, 300, 3000 })
+            {
+                for (auto [p, q] : { make_pair(2, 1), make_pair(1, 3), make_pair(1000000007, 7), make_pair(9, 4), make_pair(1, 1000000000) })
+                {
+                    PRAT x = SmallRat(p, q);
+                    PRAT root = nullptr;
+                    DUPRAT(root, x);
+                    sqrtrat(&root, precision);
+                    PRAT square = nullptr;
+                    DUPRAT(square, root);
+                    mulrat(&square, root, INT32_MAX);
+                    VERIFY_IS_TRUE(RatsAgree(square, x, precision - 2), L"Verify the square of the root");
+                    destroyrat(square);
+                    destroyrat(root);
+                    destroyrat(x);
+                }
+            }
+        }
+
+        TEST_METHOD(TestLogAgmMatchesTaylor)
+        {
+            // Both paths lean on constants built for 128 digits, so neither is
+            // checked past that.
+            const pair<int32_t, int32_t> arguments[] = { { 2, 1 }, { 10, 1 }, { 3, 2 }, { 1, 3 }, { 1000000007, 1 }, { 1000001, 1000000 }, { 7, 1000000000 } };
+            for (int32_t precision : { 30, 80, 128 })
+            {
+                for (auto [p, q] : arguments)
+                {
+                    PRAT x = LongRat(p, q, precision);
+                    PRAT taylor = LogRat(x, precision, false);
+                    PRAT agm = LogRat(x, precision, true);
+                    VERIFY_IS_TRUE(RatsAgree(taylor, agm, precision - 2), L"Verify the AGM log agrees with the Taylor series");
+                    destroyrat(agm);
+                    destroyrat(taylor);
+                    destroyrat(x);
+                }
+            }
+        }
+
+        TEST_METHOD(TestLogAgmConstants)
+        {
+            PRAT ln2 = LogRat(rat_two, 128, true);
+            VERIFY_IS_TRUE(RatsAgree(ln2, ln_two, 126));
+
+            PRAT ln10 = LogRat(rat_ten, 128, true);
+            VERIFY_IS_TRUE(RatsAgree(ln10, ln_ten, 126));
+
+            PRAT one = LogRat(rat_exp, 128, true);
+            VERIFY_IS_TRUE(RatsAgree(one, rat_one, 126));
+
+            PRAT zero = LogRat(rat_one, 128, true);
+            VERIFY_IS_TRUE(RatsAgree(zero, rat_zero, 126));
+
+            destroyrat(zero);
+            destroyrat(one);
+            destroyrat(ln10);
+            destroyrat(ln2);
+        }
+
+        TEST_METHOD(TestLogNearOne)
+        {
+            // Close to one the log is small and an absolute error shows in its
+            // leading digits, so the AGM must leave these to the series.  Checked
+            // against log(1 + d) = d - d^2/2 + d^3/3 - ... to precision digits
+            // of the result.
+            const int32_t precision = 128;
+            for (int32_t e : { 10, 30, 60, 100 })
+            {
+                for (int32_t sign : { 1, -1 })
+                {
+                    PRAT d = i32torat(10);
+                    ratpowi32(&d, -e, INT32_MAX);
+                    d->pp->sign = sign;
+                    PRAT x = nullptr;
+                    DUPRAT(x, rat_one);
+                    addrat(&x, d, INT32_MAX);
+
+                    PRAT expected = nullptr;
+                    PRAT power = nullptr;
+                    DUPRAT(expected, rat_zero);
+                    DUPRAT(power, d);
+                    for (int32_t n = 1; (n - 1) * e <= precision + 2; n++)
+                    {
+                        PRAT term = nullptr;
+                        DUPRAT(term, power);
+                        PRAT divisor = i32torat(n % 2 ? n : -n);
+                        divrat(&term, divisor, INT32_MAX);
+                        addrat(&expected, term, INT32_MAX);
+                        mulrat(&power, d, INT32_MAX);
+                        destroyrat(divisor);
+                        destroyrat(term);
+                    }
+
+                    PRAT actual = LogRat(x, precision, true);
+                    VERIFY_IS_TRUE(RatsAgree(actual, expected, precision + e - 2), L"Verify the log close to one");
+
+                    destroyrat(actual);
+                    destroyrat(power);
+                    destroyrat(expected);
+                    destroyrat(x);
+                    destroyrat(d);
+                }
+            }
+
+            PRAT zero = LogRat(rat_one, precision, true);
+            VERIFY_IS_TRUE(zerrat(zero), L"Verify the log of one is exactly zero");
+            destroyrat(zero);
+        }
+
+        TEST_METHOD(TestRootMantExact)
+        {
+            // Powers, and powers less one whose root is one less.
+            uint32_t seed = 31;
+            for (int32_t root : { 2, 3, 5, 17 })
+            {
+                for (int32_t cdigit : { 1, 2, 3, 20, 150 })
+                {
+                    vector<MANTTYPE> s = RandomMantissa(cdigit, seed);
+                    s[cdigit - 1] = max<MANTTYPE>(s[cdigit - 1], 2);
+                    vector<MANTTYPE> n(1, 1);
+                    for (int32_t i = 0; i < root; i++)
+                    {
+                        n = MulMant(n, s, KARATSUBA_THRESHOLD, TOOM3_THRESHOLD);
+                        while (n.size() > 1 && n.back() == 0)
+                        {
+                            n.pop_back();
+                        }
+                    }
+                    int32_t cn = static_cast<int32_t>(n.size());
+
+                    vector<MANTTYPE> actual((cn + root - 1) / root, 0);
+                    vector<MANTTYPE> rem(cn, 0);
+                    _rootmantx(actual.data(), rem.data(), n.data(), cn, root);
+                    vector<MANTTYPE> expected = s;
+                    expected.resize(actual.size(), 0);
+                    VERIFY_IS_TRUE(expected == actual, L"Verify the root of a perfect power");
+                    VERIFY_IS_TRUE(all_of(rem.begin(), rem.end(), [](MANTTYPE digit) { return digit == 0; }));
+
+                    auto decrement = [](vector<MANTTYPE>& mant) {
+                        for (auto& digit : mant)
+                        {
+                            if (digit-- != 0)
+                            {
+                                break;
+                            }
+                        }
+                    };
+                    decrement(n);
+                    decrement(expected);
+                    _rootmantx(actual.data(), nullptr, n.data(), cn, root);
+                    VERIFY_IS_TRUE(expected == actual, L"Verify the root of a perfect power less one");
+                }
+            }
+        }
+
+        TEST_METHOD(TestRatRootExact)
+        {
+            // (p/q)^root, unreduced and with BASEX exponents, comes back as p/q.
+            for (int32_t root : { 2, 3, 7 })
+            {
+                for (auto [p, q] : { make_pair(3, 2), make_pair(-5, 9), make_pair(1000000007, 3), make_pair(12, 1) })
+                {
+                    if (p < 0 && (root & 1) == 0)
+                    {
+                        continue;
+                    }
+                    PRAT expected = SmallRat(p, q);
+                    PRAT x = nullptr;
+                    DUPRAT(x, expected);
+                    ratpowi32(&x, root, INT32_MAX);
+                    PRAT scale = i32torat(6);
+                    mulnumx(&x->pp, scale->pp);
+                    mulnumx(&x->pq, scale->pp);
+                    x->pq->exp += 2 * root;
+                    expected->pq->exp += 2;
+
+                    ratrooti32(&x, root, 128);
+                    VERIFY_IS_TRUE(rat_equ(x, expected, INT32_MAX), L"Verify a perfect power has an exact root");
+                    destroyrat(scale);
+                    destroyrat(x);
+                    destroyrat(expected);
+                }
+            }
+        }
+
+        TEST_METHOD(TestRatRootApproximate)
+        {
+            for (int32_t root : { 2, 3, 5, 100 })
+            {
+                for (auto [p, q] : { make_pair(2, 1), make_pair(-10, 3), make_pair(1, 1000000000), make_pair(1000000007, 1) })
+                {
+                    if (p < 0 && (root & 1) == 0)
+                    {
+                        continue;
+                    }
+                    PRAT x = SmallRat(p, q);
+                    PRAT y = nullptr;
+                    DUPRAT(y, x);
+                    ratrooti32(&y, root, 128);
+                    VERIFY_IS_TRUE(SIGN(y) == SIGN(x));
+
+                    // y^root = x to the precision of y, so compare relative to x.
+                    ratpowi32(&y, root, INT32_MAX);
+                    divrat(&y, x, INT32_MAX);
+                    VERIFY_IS_TRUE(RatsAgree(y, rat_one, 120), L"Verify the root raised back to the power");
+                    destroyrat(y);
+                    destroyrat(x);
+                }
+            }
+
+            PRAT negative = SmallRat(-4, 1);
+            bool domainError = false;
+            try
+            {
+                ratrooti32(&negative, 2, 128);
+            }
+            catch (uint32_t error)
+            {
+                domainError = error == CALC_E_DOMAIN;
+            }
+            VERIFY_IS_TRUE(domainError, L"Verify an even root of a negative is a domain error");
+            destroyrat(negative);
+        }
+
+        TEST_METHOD(TestRootMatchesPower)
+        {
+            // rootrat and powrat with y = 1/n take the native roots, check them
+            // against exp(log(x)/n).
+            for (int32_t root : { 2, 3, 4 })
+            {
+                PRAT x = LongRat(5, 3, 100);
+                PRAT ratroot = i32torat(root);
+                PRAT native = nullptr;
+                DUPRAT(native, x);
+                rootrat(&native, ratroot, 10, 100);
+
+                PRAT viaPow = nullptr;
+                DUPRAT(viaPow, x);
+                PRAT oneovern = nullptr;
+                DUPRAT(oneovern, rat_one);
+                divrat(&oneovern, ratroot, 100);
+                powrat(&viaPow, oneovern, 10, 100);
+
+                PRAT viaLog = nullptr;
+                DUPRAT(viaLog, x);
+                lograt(&viaLog, 100);
+                divrat(&viaLog, ratroot, 100);
+                exprat(&viaLog, 10, 100);
+
+                VERIFY_IS_TRUE(RatsAgree(native, viaLog, 98));
+                VERIFY_IS_TRUE(RatsAgree(viaPow, viaLog, 98));
+
+                destroyrat(viaLog);
+                destroyrat(oneovern);
+                destroyrat(viaPow);
+                destroyrat(native);
+                destroyrat(ratroot);
+                destroyrat(x);
+            }
+        }
+
+        TEST_METHOD(TestFactNumMatchesProduct)
+        {
+            // Around the word size the power of two straddles whole BASEX digits.
+            for (int32_t n : { 0, 1, 2, 3, 4, 5, 31, 32, 33, 34, 63, 64, 65, 66, 100, 1000, 3000 })
+            {
+                PNUMBER factorial = i32factnumx(n);
+                PRAT actual = NumToRat(factorial);
+                PRAT expected = SequentialFactorial(n);
+                VERIFY_IS_TRUE(rat_equ(actual, expected, INT32_MAX), L"Verify the product tree factorial");
+                destroyrat(expected);
+                destroyrat(actual);
+                destroynum(factorial);
+            }
+        }
+
+        TEST_METHOD(TestProdNumRanges)
+        {
+            // Zero is skipped and an odd count of negatives is negative.
+            for (auto [start, stop, expected] : { make_tuple(-3, 4, -144), make_tuple(-5, -2, 120), make_tuple(-4, -2, -24), make_tuple(0, 0, 1),
+                                                  make_tuple(5, 4, 1), make_tuple(6, 9, 3024), make_tuple(-2, 0, 2) })
+            {
+                for (uint32_t radix : { 10u, 16u })
+                {
+                    PNUMBER product = i32prodnum(start, stop, radix);
+                    PNUMBER reference = i32tonum(expected, radix);
+                    VERIFY_IS_TRUE(equnum(product, reference), L"Verify the product of a range");
+                    destroynum(reference);
+                    destroynum(product);
+                }
+            }
+
+            PNUMBER factorial = i32factnum(700, 10);
+            PNUMBER converted = numtonRadixx(factorial, 10);
+            PRAT actual = NumToRat(converted);
+            PRAT expected = SequentialFactorial(700);
+            VERIFY_IS_TRUE(rat_equ(actual, expected, INT32_MAX), L"Verify the factorial in radix 10");
+            destroyrat(expected);
+            destroyrat(actual);
+            destroynum(converted);
+            destroynum(factorial);
+        }
+
+        TEST_METHOD(TestFactRat)
+        {
+            ChangeConstants(10, 32);
+
+            PRAT x = i32torat(170);
+            factrat(&x, 10, 32);
+            PRAT expected = SequentialFactorial(170);
+            VERIFY_IS_TRUE(rat_equ(x, expected, INT32_MAX), L"Verify an integer factorial is exact");
+            destroyrat(expected);
+            destroyrat(x);
+
+            // Close enough to an integer takes the integer factorial.
+            x = i32torat(5);
+            PRAT nudge = i32torat(10);
+            ratpowi32(&nudge, -40, INT32_MAX);
+            addrat(&x, nudge, INT32_MAX);
+            factrat(&x, 10, 32);
+            expected = i32torat(120);
+            VERIFY_IS_TRUE(rat_equ(x, expected, INT32_MAX));
+            destroyrat(expected);
+            destroyrat(nudge);
+            destroyrat(x);
+
+            // 2.5! = 15 sqrt(pi) / 8
+            x = SmallRat(5, 2);
+            factrat(&x, 10, 32);
+            expected = i32torat(15);
+            PRAT root = nullptr;
+            DUPRAT(root, pi);
+            sqrtrat(&root, 32);
+            mulrat(&expected, root, 32);
+            PRAT eight = i32torat(8);
+            divrat(&expected, eight, 32);
+            VERIFY_IS_TRUE(RatsAgree(x, expected, 30), L"Verify a fractional factorial");
+            destroyrat(eight);
+            destroyrat(root);
+            destroyrat(expected);
+            destroyrat(x);
+
+            // x! = x (x - 1)! far enough out that the product rounds.
+            PRAT y = SmallRat(10003, 10);
+            x = nullptr;
+            DUPRAT(x, y);
+            factrat(&x, 10, 40);
+            expected = nullptr;
+            DUPRAT(expected, y);
+            subrat(&expected, rat_one, INT32_MAX);
+            factrat(&expected, 10, 40);
+            mulrat(&expected, y, 40);
+            divrat(&x, expected, 40);
+            VERIFY_IS_TRUE(RatsAgree(x, rat_one, 36), L"Verify the fractional factorial recurrence");
+            destroyrat(expected);
+            destroyrat(x);
+            destroyrat(y);
+
+            for (auto [p, error] : { make_pair(-3, CALC_E_DOMAIN), make_pair(1000000, CALC_E_OVERFLOW), make_pair(-1000000, CALC_E_OVERFLOW) })
+            {
+                x = i32torat(p);
+                uint32_t thrown = 0;
+                try
+                {
+                    factrat(&x, 10, 32);
+                }
+                catch (uint32_t e)
+                {
+                    thrown = e;
+                }
+                VERIFY_ARE_EQUAL(error, thrown);
+                destroyrat(x);
+            }
+        }
+
+        TEST_METHOD(TestGammaSpougeMatchesSeries)
+        {
+            // The series is only good to the precision up to about 1.5.
+            for (int32_t precision : { 32, 100 })
+            {
+                ChangeConstants(10, precision);
+                for (auto [p, q] : { make_pair(1, 10), make_pair(1, 2), make_pair(9, 10), make_pair(13, 10), make_pair(123456789, 1000000000) })
+                {
+                    PRAT series = SmallRat(p, q);
+                    PRAT spouge = nullptr;
+                    DUPRAT(spouge, series);
+                    _gamma(&series, 10, precision);
+                    _gammaspouge(&spouge, 10, precision);
+                    divrat(&spouge, series, precision);
+                    VERIFY_IS_TRUE(RatsAgree(spouge, rat_one, precision - 3), L"Verify Spouge's gamma against the series");
+                    destroyrat(spouge);
+                    destroyrat(series);
+                }
+            }
+
+            // gamma(1/2) = sqrt(pi), from the cached coefficients the second time.
+            ChangeConstants(10, 32);
+            for (int32_t i = 0; i < 2; i++)
+            {
+                PRAT x = SmallRat(1, 2);
+                _gammaspouge(&x, 10, 32);
+                PRAT root = nullptr;
+                DUPRAT(root, pi);
+                sqrtrat(&root, 32);
+                VERIFY_IS_TRUE(RatsAgree(x, root, 30));
+                destroyrat(root);
+                destroyrat(x);
+            }
+        }
+
+        TEST_METHOD(TestFactRatReflection)
+        {
+            ChangeConstants(10, 32);
+
+            // (-1/2)! = sqrt(pi), (-5/2)! = 4 sqrt(pi) / 3 and (-7/2)! = -8 sqrt(pi) / 15
+            PRAT root = nullptr;
+            DUPRAT(root, pi);
+            sqrtrat(&root, 32);
+            for (auto [p, scalep, scaleq] : { make_tuple(-1, 1, 1), make_tuple(-5, 4, 3), make_tuple(-7, -8, 15) })
+            {
+                PRAT x = SmallRat(p, 2);
+                factrat(&x, 10, 32);
+                PRAT expected = SmallRat(scalep, scaleq);
+                mulrat(&expected, root, 32);
+                divrat(&x, expected, 32);
+                VERIFY_IS_TRUE(RatsAgree(x, rat_one, 30), L"Verify a negative half integer factorial");
+                destroyrat(expected);
+                destroyrat(x);
+            }
+            destroyrat(root);
+
+            // x! = x (x - 1)! far out on the negative side.
+            PRAT y = SmallRat(-10003, 10);
+            PRAT x = nullptr;
+            DUPRAT(x, y);
+            factrat(&x, 10, 32);
+            PRAT expected = nullptr;
+            DUPRAT(expected, y);
+            subrat(&expected, rat_one, INT32_MAX);
+            factrat(&expected, 10, 32);
+            mulrat(&expected, y, 32);
+            divrat(&x, expected, 32);
+            VERIFY_IS_TRUE(RatsAgree(x, rat_one, 28), L"Verify the negative factorial recurrence");
+            destroyrat(expected);
+            destroyrat(x);
+            destroyrat(y);
+        }
+
+        TEST_METHOD(TestPowWindows)
+        {
+            for (uint32_t power : { 1u, 2u, 5u, 6u, 1023u, 1024u, 0x5555u, 0x12345678u, 0x7fffffffu, 0x80000000u, 0xffffffffu })
+            {
+                POWWINDOW windows[MAX_POW_WINDOWS];
+                int32_t window;
+                int32_t cwindows = _powwindows(power, windows, &window);
+                VERIFY_ARE_EQUAL(0, windows[0].csquare);
+                uint64_t rebuilt = 0;
+                for (int32_t i = 0; i < cwindows; i++)
+                {
+                    VERIFY_IS_TRUE(windows[i].odd < (1u << window) && (windows[i].odd == 0 || (windows[i].odd & 1) != 0));
+                    rebuilt = (rebuilt << windows[i].csquare) + windows[i].odd;
+                }
+                VERIFY_ARE_EQUAL(static_cast<uint64_t>(power), rebuilt, L"Verify the windows make up the power");
+            }
+        }
+
+        TEST_METHOD(TestNumPowMatchesBinary)
+        {
+            // Odd roots, roots with factors of two and whole zero digits, and
+            // a power of two that is only shifted.
+            uint32_t seed = 17;
+            vector<PNUMBER> roots = { NumberFromMantissa(RandomMantissa(3, seed), 1, 0), NumberFromMantissa({ 0, 0, 6, 5 }, -1, 0),
+                                      NumberFromMantissa({ 0x80000000 }, 1, 2), NumberFromMantissa({ 0, 8 }, -1, -1), NumberFromMantissa({ 3 }, 1, 0) };
+            for (PNUMBER root : roots)
+            {
+                for (int32_t power : { 0, 1, 2, 3, 7, 31, 32, 33, 100, 1025, 3001 })
+                {
+                    PNUMBER actual = nullptr;
+                    DUPNUM(actual, root);
+                    numpowi32x(&actual, power);
+                    PNUMBER expected = BinaryPower(root, power);
+                    PRAT ratactual = NumToRat(actual);
+                    PRAT ratexpected = NumToRat(expected);
+                    VERIFY_IS_TRUE(rat_equ(ratactual, ratexpected, INT32_MAX), L"Verify the windowed power");
+                    destroyrat(ratexpected);
+                    destroyrat(ratactual);
+                    destroynum(expected);
+                    destroynum(actual);
+                }
+                destroynum(root);
+            }
+
+            // Outside BASEX, 3^19 fits in an int32_t.
+            for (uint32_t radix : { 10u, 16u })
+            {
+                PNUMBER actual = i32tonum(3, radix);
+                numpowi32(&actual, 19, radix, 32);
+                PNUMBER expected = i32tonum(1162261467, radix);
+                VERIFY_IS_TRUE(equnum(actual, expected), L"Verify the power in a radix");
+                destroynum(expected);
+                destroynum(actual);
+            }
+        }
+
+        TEST_METHOD(TestZeroTimesPowerHasNoExponent)
+        {
+            // Powers carry their zero digits in the exponent, which a zero
+            // product must not keep or it shows as 0.e+72.
+            PNUMBER power = i32tonum(10, BASEX);
+            numpowi32x(&power, 332);
+            VERIFY_IS_TRUE(power->exp > 0);
+            for (bool zerofirst : { true, false })
+            {
+                PNUMBER product = nullptr;
+                if (zerofirst)
+                {
+                    product = i32tonum(0, BASEX);
+                    mulnumx(&product, power);
+                }
+                else
+                {
+                    DUPNUM(product, power);
+                    PNUMBER zero = i32tonum(0, BASEX);
+                    mulnumx(&product, zero);
+                    destroynum(zero);
+                }
+                VERIFY_IS_TRUE(zernum(product), L"Verify the product is zero");
+                VERIFY_ARE_EQUAL(0, product->exp, L"Verify the zero product has no exponent");
+                destroynum(product);
+            }
+            destroynum(power);
+
+            PNUMBER scaled = i32tonum(4, 10);
+            scaled->exp = 332;
+            PNUMBER zero = i32tonum(0, 10);
+            mulnum(&zero, scaled, 10);
+            VERIFY_ARE_EQUAL(0, zero->exp, L"Verify the zero product has no exponent in a radix");
+            PRAT ratzero = nullptr;
+            createrat(ratzero);
+            ratzero->pp = zero;
+            ratzero->pq = i32tonum(1, BASEX);
+            VERIFY_ARE_EQUAL(wstring(L"0"), RatToString(ratzero, FMT_FLOAT, 10, 32));
+            destroyrat(ratzero);
+            destroynum(scaled);
+        }
+
+        TEST_METHOD(TestRatPowExactAndTrimmed)
+        {
+            ChangeConstants(10, 32);
+
+            // (2/3)^50 keeps a short enough denominator to be exact, and
+            // (2/3)^-5 = 243/32.
+            PRAT x = SmallRat(2, 3);
+            ratpowi32(&x, 50, 32);
+            PNUMBER two = i32tonum(2, BASEX);
+            PNUMBER three = i32tonum(3, BASEX);
+            PNUMBER p = BinaryPower(two, 50);
+            PNUMBER q = BinaryPower(three, 50);
+            VERIFY_IS_TRUE(equnum(x->pp, p) && equnum(x->pq, q), L"Verify the exact power");
+            destroynum(q);
+            destroynum(p);
+            destroynum(three);
+            destroynum(two);
+            destroyrat(x);
+
+            x = SmallRat(2, 3);
+            ratpowi32(&x, -5, 32);
+            PRAT expected = SmallRat(243, 32);
+            VERIFY_IS_TRUE(rat_equ(x, expected, INT32_MAX));
+            destroyrat(expected);
+            destroyrat(x);
+
+            x = SmallRat(2, 3);
+            ratpowi32(&x, 0, 32);
+            VERIFY_IS_TRUE(rat_equ(x, rat_one, INT32_MAX));
+            destroyrat(x);
+
+            // (7/3)^1000 is trimmed along the way, against the exact power.
+            for (int32_t power : { 1000, -1001 })
+            {
+                x = SmallRat(7, 3);
+                ratpowi32(&x, power, 32);
+                expected = SmallRat(7, 3);
+                ratpowi32(&expected, power, INT32_MAX);
+                divrat(&x, expected, 32);
+                VERIFY_IS_TRUE(RatsAgree(x, rat_one, 28), L"Verify the trimmed power");
+                destroyrat(expected);
+                destroyrat(x);
+            }
+        }
+
+        TEST_METHOD(TestBoolRatMatchesWords)
+        {
+            ChangeConstants(10, 32);
+            uint32_t seed = 5;
+            for (int32_t i = 0; i < 200; i++)
+            {
+                vector<MANTTYPE> words = RandomMantissa(4, seed);
+                uint64_t a = (static_cast<uint64_t>(words[0]) << BASEXPWR | words[1]) >> (i % 64);
+                uint64_t b = (static_cast<uint64_t>(words[2]) << BASEXPWR | words[3]) >> (i % 7 * 9);
+                for (int func = 0; func < 3; func++)
+                {
+                    PRAT x = Ui64ToRat(a);
+                    PRAT y = Ui64ToRat(b);
+                    uint64_t expected;
+                    switch (func)
+                    {
+                    case 0:
+                        andrat(&x, y, 10, 32);
+                        expected = a & b;
+                        break;
+                    case 1:
+                        orrat(&x, y, 10, 32);
+                        expected = a | b;
+                        break;
+                    default:
+                        xorrat(&x, y, 10, 32);
+                        expected = a ^ b;
+                        break;
+                    }
+                    VERIFY_ARE_EQUAL(expected, rattoUi64(x, 10, 32), L"Verify the logical operation on words");
+                    destroyrat(y);
+                    destroyrat(x);
+                }
+            }
+
+            // Wide operands, one with a digit exponent, against the general path.
+            PNUMBER wide = NumberFromMantissa(RandomMantissa(9, seed), 1, 0);
+            PNUMBER shifted = NumberFromMantissa(RandomMantissa(4, seed), 1, 3);
+            PRAT x = NumToRat(wide);
+            PRAT y = NumToRat(shifted);
+            for (int func = 0; func < 3; func++)
+            {
+                PRAT fast = nullptr;
+                DUPRAT(fast, x);
+                PRAT general = OverThree(x);
+                void (*op)(PRAT*, PRAT, uint32_t, int32_t) = func == 0 ? andrat : (func == 1 ? orrat : xorrat);
+                op(&fast, y, 10, 32);
+                op(&general, y, 10, 32);
+                VERIFY_IS_TRUE(rat_equ(fast, general, INT32_MAX), L"Verify the logical operation on wide integers");
+                destroyrat(general);
+                destroyrat(fast);
+            }
+            destroyrat(y);
+            destroyrat(x);
+            destroynum(shifted);
+            destroynum(wide);
+
+            // 2^64 - 1 and the low words of something wider.
+            VERIFY_ARE_EQUAL(UINT64_MAX, rattoUi64(rat_qword, 10, 32));
+            PRAT big = Ui64ToRat(0x123456789abcdef0);
+            PRAT shift = i32torat(40);
+            lshrat(&big, shift, 10, 32);
+            VERIFY_ARE_EQUAL(0xbcdef00000000000, rattoUi64(big, 10, 32));
+            destroyrat(shift);
+            destroyrat(big);
+        }
+
+        TEST_METHOD(TestShiftsMatchPowers)
+        {
+            ChangeConstants(10, 32);
+            uint32_t seed = 11;
+            vector<PNUMBER> values = { NumberFromMantissa(RandomMantissa(3, seed), 1, 0), NumberFromMantissa({ 0x80000000, 7 }, -1, 0),
+                                       NumberFromMantissa({ 0, 0x100 }, 1, 1), NumberFromMantissa({ 0 }, 1, 0) };
+            for (PNUMBER value : values)
+            {
+                for (int32_t bits : { 0, 1, 8, 31, 32, 33, 64, 100 })
+                {
+                    PRAT count = i32torat(bits);
+                    PRAT power = nullptr;
+                    DUPRAT(power, rat_two);
+                    ratpowi32(&power, bits, INT32_MAX);
+
+                    PRAT left = NumToRat(value);
+                    lshrat(&left, count, 10, 32);
+                    PRAT expected = NumToRat(value);
+                    mulrat(&expected, power, INT32_MAX);
+                    VERIFY_IS_TRUE(rat_equ(left, expected, INT32_MAX), L"Verify the left shift");
+                    destroyrat(expected);
+
+                    PRAT right = NumToRat(value);
+                    rshrat(&right, count, 10, 32);
+                    expected = NumToRat(value);
+                    divrat(&expected, power, INT32_MAX);
+                    VERIFY_IS_TRUE(rat_equ(right, expected, INT32_MAX), L"Verify the right shift");
+                    destroyrat(expected);
+
+                    // Back again is where it started.
+                    rshrat(&left, count, 10, 32);
+                    PRAT original = NumToRat(value);
+                    VERIFY_IS_TRUE(rat_equ(left, original, INT32_MAX));
+
+                    destroyrat(original);
+                    destroyrat(right);
+                    destroyrat(left);
+                    destroyrat(power);
+                    destroyrat(count);
+                }
+                destroynum(value);
+            }
+        }
+
+        TEST_METHOD(TestConstantsCached)
+        {
+            // Going back to a radix and precision gets the same constants
+            // again, nothing is recalculated.
+            ChangeConstants(10, 60);
+            PRAT pi60 = pi;
+            PRAT ln_two60 = ln_two;
+            ChangeConstants(16, 60);
+            VERIFY_IS_TRUE(pi != pi60);
+            ChangeConstants(10, 100);
+            ChangeConstants(10, 60);
+            VERIFY_IS_TRUE(pi == pi60 && ln_two == ln_two60);
+            VERIFY_IS_TRUE(getconstants(10, 60)->pi == pi60);
+
+            // Below the precision of a set already built the constants are
+            // still good to the precision asked for.
+            PRAT x = SmallRat(1, 2);
+            PRAT sixAsinHalf = SeriesRat(x, SERIES_ASIN, 60, true);
+            mulrat(&sixAsinHalf, rat_six, 60);
+            VERIFY_IS_TRUE(RatsAgree(sixAsinHalf, pi, 58));
+
+            const RATCONSTANTS* pc = getconstants(16, 60);
+            VERIFY_IS_TRUE(pc->radix == 16 && pc->precision == 60 && pc->ratio == 7);
+
+            destroyrat(sixAsinHalf);
+            destroyrat(x);
+            ChangeConstants(10, 128);
+        }
+
+        TEST_METHOD(TestConstantsConcurrent)
+        {
+            // Threads asking for a set nobody has built yet all get the same one.
+            constexpr int32_t threadCount = 8;
+            const RATCONSTANTS* sets[threadCount] = {};
+            vector<thread> threads;
+            for (int32_t i = 0; i < threadCount; i++)
+            {
+                threads.emplace_back([&sets, i] { sets[i] = getconstants(10, 97); });
+            }
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+            for (int32_t i = 1; i < threadCount; i++)
+            {
+                VERIFY_IS_TRUE(sets[i] == sets[0]);
+            }
+
+            // Reading and comparing against shared constants leaves them alone.
+            PRAT expected = nullptr;
+            DUPRAT(expected, sets[0]->pi);
+            threads.clear();
+            bool agree[threadCount] = {};
+            for (int32_t i = 0; i < threadCount; i++)
+            {
+                threads.emplace_back([&sets, &agree, i] {
+                    ChangeConstants(10, 97);
+                    PRAT x = i32torat(3);
+                    bool fagree = true;
+                    for (int32_t j = 0; j < 100; j++)
+                    {
+                        fagree = fagree && rat_lt(x, sets[0]->pi, 97) && !rat_ge(x, sets[0]->pi, 97);
+                        subrat(&x, sets[0]->two_pi, 97);
+                        addrat(&x, sets[0]->two_pi, 97);
+                    }
+                    agree[i] = fagree;
+                    destroyrat(x);
+                });
+            }
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+            for (int32_t i = 0; i < threadCount; i++)
+            {
+                VERIFY_IS_TRUE(agree[i]);
+            }
+            VERIFY_IS_TRUE(rat_equ(expected, sets[0]->pi, INT32_MAX) && SIGN(sets[0]->pi) == 1);
+            destroyrat(expected);
+        }
+
+        TEST_METHOD(TestContextPerThread)
+        {
+            // Threads in different radixes and precisions, each gets the
+            // constants and conversions of its own context.
+            constexpr int32_t threadCount = 8;
+            wstring results[threadCount];
+            vector<thread> threads;
+            for (int32_t i = 0; i < threadCount; i++)
+            {
+                threads.emplace_back([&results, i] {
+                    uint32_t radix = (i & 1) ? 16 : 10;
+                    int32_t precision = 20 + 10 * i;
+                    ChangeConstants(radix, precision);
+                    SetDecimalSeparator(L',');
+                    for (int32_t j = 0; j < 20; j++)
+                    {
+                        PRAT x = nullptr;
+                        DUPRAT(x, pi);
+                        divrat(&x, rat_two, precision);
+                        sinanglerat(&x, ANGLE_RAD, radix, precision);
+                        results[i] = RatToString(x, FMT_FLOAT, radix, precision);
+                        destroyrat(x);
+                    }
+                });
+            }
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+            for (int32_t i = 0; i < threadCount; i++)
+            {
+                VERIFY_IS_TRUE(results[i] == L"1", L"Verify sin(pi/2) in every context");
+            }
+
+            // Saving and restoring a context on one thread.
+            RATPAKCONTEXT saved = getratpakcontext();
+            ChangeConstants(16, 40);
+            SetDecimalSeparator(L',');
+            VERIFY_IS_TRUE(g_ratio == 7 && rat_nRadix->pp->mant[0] == 16);
+            RATPAKCONTEXT hex = getratpakcontext();
+            setratpakcontext(saved);
+            VERIFY_IS_TRUE(g_ratio == 9 && pi == saved.constants->pi && g_decimalSeparator == saved.decimalSeparator);
+            setratpakcontext(hex);
+            VERIFY_IS_TRUE(g_ratio == 7 && pi == getconstants(16, 40)->pi && g_decimalSeparator == L',');
+            setratpakcontext(saved);
+        }
+
+        TEST_METHOD(TestRatCmpMatchesSubtraction)
+        {
+            ChangeConstants(10, 32);
+            uint32_t seed = 13;
+            for (int32_t i = 0; i < 300; i++)
+            {
+                // Lengths and exponents that put the magnitude estimates
+                // apart, a digit apart and level.
+                vector<MANTTYPE> ap = RandomMantissa(1 + i % 5, seed);
+                vector<MANTTYPE> aq = RandomMantissa(1 + i % 3, seed);
+                vector<MANTTYPE> bq = RandomMantissa(1 + i % 4, seed);
+                PRAT a = nullptr;
+                createrat(a);
+                a->pp = NumberFromMantissa(ap, (i & 1) ? -1 : 1, i % 3);
+                a->pq = NumberFromMantissa(aq, (i & 2) ? -1 : 1, 0);
+                PRAT b = nullptr;
+                createrat(b);
+                b->pp = NumberFromMantissa(RandomMantissa(1 + i % 6, seed), (i & 4) ? -1 : 1, i % 2);
+                b->pq = NumberFromMantissa(bq, 1, i % 2);
+
+                VERIFY_ARE_EQUAL(SubtractionSign(a, b), ratcmp(a, b), L"Verify the comparison");
+                VERIFY_ARE_EQUAL(SubtractionSign(b, a), ratcmp(b, a));
+
+                // The same value over a longer denominator, and a last digit off.
+                PRAT c = OverThree(a);
+                VERIFY_ARE_EQUAL(0, ratcmp(a, c), L"Verify equal values over different denominators");
+                VERIFY_IS_TRUE(rat_equ(a, c, 32) && rat_le(a, c, 32) && rat_ge(c, a, 32) && !rat_lt(a, c, 32) && !rat_neq(c, a, 32));
+                c->pp->mant[0] ^= 1;
+                VERIFY_ARE_EQUAL(SubtractionSign(a, c), ratcmp(a, c), L"Verify values a digit apart");
+                VERIFY_ARE_EQUAL(SubtractionSign(c, a) > 0, rat_gt(c, a, 32));
+
+                destroyrat(c);
+                destroyrat(b);
+                destroyrat(a);
+            }
+
+            // Zeros of either sign and the shared constants, which are not written to.
+            PRAT zero = i32torat(0);
+            zero->pp->sign = -1;
+            VERIFY_ARE_EQUAL(0, ratcmp(zero, rat_zero));
+            VERIFY_IS_TRUE(rat_lt(zero, rat_one, 32) && rat_gt(zero, rat_neg_one, 32));
+            VERIFY_IS_TRUE(rat_lt(rat_half, rat_one, 32) && rat_gt(pi, rat_two, 32) && rat_lt(pi, rat_180, 32));
+            destroyrat(zero);
+            ChangeConstants(10, 128);
+        }
+
+        TEST_METHOD(TestSubRatSelfIsPositiveZero)
+        {
+            // Code that reads the sign of pp takes a negative zero for a
+            // negative number, rattoUi64 once reported a domain error for it.
+            vector<PRAT> values = { i32torat(1), i32torat(-5), SmallRat(7, 3), SmallRat(-1, 7), LongRat(2, 3, 50) };
+            for (PRAT value : values)
+            {
+                PRAT x = nullptr;
+                DUPRAT(x, value);
+                subrat(&x, value, 128);
+                VERIFY_IS_TRUE(zerrat(x), L"Verify a - a is zero");
+                VERIFY_ARE_EQUAL(1, x->pp->sign, L"Verify a - a is a positive zero");
+                VERIFY_ARE_EQUAL(0ULL, rattoUi64(x, 10, 128));
+                destroyrat(x);
+                destroyrat(value);
+            }
+
+            PRAT one = nullptr;
+            DUPRAT(one, rat_one);
+            subrat(&one, rat_one, 128);
+            VERIFY_ARE_EQUAL(1, one->pp->sign, L"Verify 1 - 1 is a positive zero");
+            VERIFY_ARE_EQUAL(1, rat_one->pp->sign, L"Verify the shared constant is left alone");
+            destroyrat(one);
+        }
+
+        TEST_METHOD(TestScale2PiMatchesSeries)
+        {
+            ChangeConstants(10, 40);
+            PRAT power = i32torat(10);
+            ratpowi32(&power, 60, INT32_MAX);
+            vector<PRAT> values = { i32torat(5000000), SmallRat(-123456789, 1000), i32torat(0x7fffffff), LongRat(1, 3, 30) };
+
+            // Huge integers, with a fraction, over a long denominator, negative.
+            for (int32_t i = 0; i < 4; i++)
+            {
+                PRAT x = nullptr;
+                DUPRAT(x, power);
+                PRAT offset = (i == 0) ? i32torat(7) : (i == 1) ? SmallRat(1, 7) : (i == 2) ? LongRat(2, 3, 50) : SmallRat(-5, 2);
+                if (i == 3)
+                {
+                    x->pp->sign = -1;
+                }
+                addrat(&x, offset, INT32_MAX);
+                destroyrat(offset);
+                values.push_back(x);
+            }
+            PRAT huge = i32torat(10);
+            ratpowi32(&huge, 2000, INT32_MAX);
+            values.push_back(huge);
+
+            for (PRAT value : values)
+            {
+                PRAT expected = Scale2PiBySeries(value, 40);
+                PRAT x = nullptr;
+                DUPRAT(x, value);
+                scale2pi(&x, 10, 40);
+                VERIFY_IS_TRUE(RatsAgree(x, expected, 38), L"Verify the reduced argument");
+                VERIFY_IS_TRUE(SIGN(x) == SIGN(value) || zerrat(x));
+
+                // Reducing again finds the digits it needs in the cache.
+                int32_t cached = _twopidigits();
+                PRAT again = nullptr;
+                DUPRAT(again, value);
+                scale2pi(&again, 10, 40);
+                VERIFY_IS_TRUE(rat_equ(x, again, INT32_MAX));
+                VERIFY_ARE_EQUAL(cached, _twopidigits());
+
+                destroyrat(again);
+                destroyrat(x);
+                destroyrat(expected);
+                destroyrat(value);
+            }
+            destroyrat(power);
+
+            // sin and cos of 10^22, which is known to be hard to reduce.
+            PRAT x = i32torat(10);
+            ratpowi32(&x, 22, INT32_MAX);
+            PRAT y = nullptr;
+            DUPRAT(y, x);
+            sinanglerat(&x, ANGLE_RAD, 10, 40);
+            cosanglerat(&y, ANGLE_RAD, 10, 40);
+            VERIFY_ARE_EQUAL(wstring(L"-0.8522008497671888017727058937530293683"), RatToString(x, FMT_FLOAT, 10, 37));
+            VERIFY_ARE_EQUAL(wstring(L"0.5232147853951389454975944733847094921"), RatToString(y, FMT_FLOAT, 10, 37));
+            destroyrat(y);
+            destroyrat(x);
+            ChangeConstants(10, 128);
+        }
+
+        TEST_METHOD(TestInPlaceMatchesAllocated)
+        {
+            uint32_t seed = 23;
+            for (int32_t ca : { 1, 3, 17, 60 })
+            {
+                for (int32_t cb : { 1, 5, 40 })
+                {
+                    for (int32_t shift : { -3, 0, 4 })
+                    {
+                        // Unlike signs when shifted down exercise the complemented sum.
+                        PNUMBER a = NumberFromMantissa(RandomMantissa(ca, seed), 1, shift);
+                        PNUMBER b = NumberFromMantissa(RandomMantissa(cb, seed), (shift < 0) ? -1 : 1, 0);
+                        for (int32_t mul = 0; mul < 2; mul++)
+                        {
+                            for (int32_t alias = 0; alias < 2; alias++)
+                            {
+                                PNUMBER tight = TightCopy(a);
+                                PNUMBER roomy = TightCopy(a);
+                                reservenum(&roomy, 2 * max(ca, cb) + 8);
+                                PNUMBER buffer = roomy;
+                                PNUMBER operand = alias ? a : b;
+                                if (mul)
+                                {
+                                    mulnumx(&tight, operand);
+                                    mulnumx(&roomy, alias ? roomy : b);
+                                }
+                                else
+                                {
+                                    addnum(&tight, operand, BASEX);
+                                    addnum(&roomy, alias ? roomy : b, BASEX);
+                                }
+                                VERIFY_IS_TRUE(roomy == buffer);
+                                VERIFY_IS_TRUE(SameNumber(tight, roomy));
+                                destroynum(roomy);
+                                destroynum(tight);
+                            }
+                        }
+                        destroynum(b);
+                        destroynum(a);
+                    }
+                }
+            }
+
+            // A sum less its own negation is zero, left in place as well.
+            PNUMBER a = NumberFromMantissa(RandomMantissa(9, seed), 1, 2);
+            PNUMBER negated = TightCopy(a);
+            negated->sign = -1;
+            reservenum(&a, 20);
+            PNUMBER buffer = a;
+            addnum(&a, negated, BASEX);
+            VERIFY_IS_TRUE(a == buffer && zernum(a));
+            destroynum(negated);
+            destroynum(a);
+
+            // DUPNUM keeps a buffer the copy fits in.
+            PNUMBER copy = nullptr;
+            createnum(copy, 30);
+            buffer = copy;
+            DUPNUM(copy, num_one);
+            VERIFY_IS_TRUE(copy == buffer && SameNumber(copy, num_one));
+            destroynum(copy);
+        }
+
+        TEST_METHOD(TestSeriesStopsAllocating)
+        {
+            PRAT x = SmallRat(1, 3);
+            PRAT sum = i32torat(1);
+            PRAT term = i32torat(1);
+            PNUMBER n = i32tonum(1, BASEX);
+
+            // Once the buffers of the sum and the term have grown, further
+            // terms are calculated without creating numbers.
+            ExpTerms(&sum, &term, &n, x, 10, 128);
+            resetpoolstats();
+            ExpTerms(&sum, &term, &n, x, 60, 128);
+            POOLSTATS stats;
+            getpoolstats(&stats);
+            VERIFY_ARE_EQUAL(0ull, static_cast<unsigned long long>(stats.cnumcreate));
+
+            PRAT e = nullptr;
+            DUPRAT(e, x);
+            exprat(&e, 10, 128);
+            VERIFY_IS_TRUE(RatsAgree(sum, e, 100));
+            destroyrat(e);
+            destroynum(n);
+            destroyrat(term);
+            destroyrat(sum);
+            destroyrat(x);
+        }
+
+        TEST_METHOD(TestTrimmingLeavesDigitsInPlace)
+        {
+            PRAT x = LongRat(22, 7, 400);
+            mulrat(&x, x, INT32_MAX);
+            PRAT moved = nullptr;
+            DUPRAT(moved, x);
+            MANTTYPE* ptop = x->pp->mant + x->pp->cdigit;
+
+            // The digits kept are where they were, only the start of the
+            // mantissa moves.
+            trimit(&x, 128);
+            TrimByMoving(moved, 128);
+            VERIFY_IS_TRUE(x->pp->mant > MANTBASE(x->pp));
+            VERIFY_IS_TRUE(x->pp->mant + x->pp->cdigit == ptop);
+            VERIFY_IS_TRUE(SameNumber(x->pp, moved->pp) && SameNumber(x->pq, moved->pq));
+
+            // Results written over a trimmed number match those of an
+            // untrimmed copy, whether they fit after the trimmed digits, in
+            // the room the trimmed digits left, or only from the start.
+            uint32_t seed = 41;
+            for (int32_t cb : { 2, 20, 40 })
+            {
+                for (int32_t shift : { -30, -2, 0, 3 })
+                {
+                    PNUMBER b = NumberFromMantissa(RandomMantissa(cb, seed), (shift == -2) ? -1 : 1, x->pp->exp + shift);
+                    for (int32_t mul = 0; mul < 2; mul++)
+                    {
+                        PNUMBER trimmed = nullptr;
+                        DUPNUM(trimmed, moved->pp);
+                        reservenum(&trimmed, 2 * x->pp->cdigit + 40);
+                        int32_t cdrop = trimmed->cdigit / 2;
+                        TRIMLOW(trimmed, cdrop);
+                        PNUMBER tight = TightCopy(trimmed);
+                        PNUMBER buffer = trimmed;
+                        if (mul)
+                        {
+                            mulnumx(&trimmed, b);
+                            mulnumx(&tight, b);
+                        }
+                        else
+                        {
+                            addnum(&trimmed, b, BASEX);
+                            addnum(&tight, b, BASEX);
+                        }
+                        VERIFY_IS_TRUE(trimmed == buffer);
+                        VERIFY_IS_TRUE(trimmed->mant >= MANTBASE(trimmed) && trimmed->mant + trimmed->cdigit <= MANTBASE(trimmed) + trimmed->cdigitmax + 1);
+                        VERIFY_IS_TRUE(SameNumber(tight, trimmed));
+                        destroynum(tight);
+                        destroynum(trimmed);
+                    }
+                    destroynum(b);
+                }
+            }
+
+            // Making room moves a trimmed mantissa back to the start.
+            PNUMBER num = nullptr;
+            DUPNUM(num, x->pp);
+            PNUMBER copy = TightCopy(num);
+            TRIMLOW(num, 1);
+            TRIMLOW(copy, 1);
+            reservenum(&num, num->cdigitmax);
+            VERIFY_IS_TRUE(num->mant == MANTBASE(num) && SameNumber(num, copy));
+            destroynum(copy);
+            destroynum(num);
+
+            destroyrat(moved);
+            destroyrat(x);
+        }
+
+        TEST_METHOD(TestRatToStringxMatchesRatToString)
+        {
+            // Exact and series results, scaled from far below one to far above it.
+            for (int32_t precision : { 16, 32 })
+            {
+                ChangeConstants(10, precision);
+                for (int32_t p = -40; p <= 40; p += 3)
+                {
+                    for (int32_t scale : { -60, -17, -1, 0, 5, 40 })
+                    {
+                        PRAT power = i32torat(10);
+                        ratpowi32(&power, scale, INT32_MAX);
+                        for (int32_t function = 0; function < 3; function++)
+                        {
+                            PRAT x = SmallRat(p, 7);
+                            if (function == 1)
+                            {
+                                exprat(&x, 10, precision + 8);
+                            }
+                            else if (function == 2)
+                            {
+                                sinanglerat(&x, ANGLE_RAD, 10, precision + 8);
+                            }
+                            mulrat(&x, power, INT32_MAX);
+                            VERIFY_ARE_EQUAL(RatToString(x, FMT_FLOAT, 10, precision), RatToStringx(x, FMT_FLOAT, 10, precision));
+                            destroyrat(x);
+                        }
+                        destroyrat(power);
+                    }
+                }
+
+                PRAT zero = i32torat(0);
+                VERIFY_ARE_EQUAL(wstring(L"0"), RatToStringx(zero, FMT_FLOAT, 10, precision));
+                destroyrat(zero);
+            }
+            ChangeConstants(10, 128);
+        }
+    };
+
+    // Timings for retuning the thresholds in ratpak.h, each next to the path it
+    // replaced.  The tests above hold the assertions, so these are left out of
+    // the unit suite; drop TEST_IGNORE from one locally to run it.
+    TEST_CLASS(RatpackBenchmarks)
+    {
+    public:
+        TEST_CLASS_INITIALIZE(CommonSetup)
+        {
+            ChangeConstants(10, 128);
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkMulMantThresholds)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkMulMantThresholds)
+        {
+            // Not a pass/fail test, logs the time for each size at a few threshold
+            // settings so KARATSUBA_THRESHOLD and TOOM3_THRESHOLD can be retuned.
+            const pair<int32_t, int32_t> thresholds[] = {
+                { INT32_MAX, INT32_MAX }, { 16, INT32_MAX }, { 32, INT32_MAX }, { 48, INT32_MAX }, { 32, 128 }, { 32, 256 }, { 32, 512 },
+            };
+            uint32_t seed = 7;
+            for (int32_t cdigit : { 16, 32, 64, 128, 256, 512, 1024, 2048 })
+            {
+                auto a = RandomMantissa(cdigit, seed);
+                auto b = RandomMantissa(cdigit, seed);
+                int32_t reps = max(1, 4000000 / (cdigit * cdigit));
+
+                wstringstream message;
+                message << L"digits " << cdigit << L":";
+                for (const auto& threshold : thresholds)
+                {
+                    auto start = chrono::steady_clock::now();
+                    for (int32_t i = 0; i < reps; i++)
+                    {
+                        MulMant(a, b, threshold.first, threshold.second);
+                    }
+                    auto elapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / reps;
+                    message << L" [" << threshold.first << L"," << threshold.second << L"] " << elapsed << L"us";
+                }
+                Logger::WriteMessage(message.str().c_str());
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkMulMantNttScaling)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkMulMantNttScaling)
+        {
+            // Logs Toom-3 against NTT for operands of 1k to 100k decimal digits.
+            uint32_t seed = 11;
+            for (int32_t decimalDigits : { 1000, 3000, 10000, 30000, 100000 })
+            {
+                int32_t cdigit = static_cast<int32_t>(decimalDigits / (BASEXPWR * 0.30103)) + 1;
+                auto a = RandomMantissa(cdigit, seed);
+                auto b = RandomMantissa(cdigit, seed);
+                int32_t reps = max(1, 20000000 / (cdigit * cdigit));
+
+                auto start = chrono::steady_clock::now();
+                vector<MANTTYPE> toom3;
+                for (int32_t i = 0; i < reps; i++)
+                {
+                    toom3 = MulMant(a, b, KARATSUBA_THRESHOLD, TOOM3_THRESHOLD, INT32_MAX);
+                }
+                auto toom3Elapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / reps;
+
+                start = chrono::steady_clock::now();
+                vector<MANTTYPE> ntt;
+                for (int32_t i = 0; i < reps; i++)
+                {
+                    ntt = MulMant(a, b, KARATSUBA_THRESHOLD, TOOM3_THRESHOLD, 1);
+                }
+                auto nttElapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / reps;
+
+                VERIFY_IS_TRUE(toom3 == ntt);
+
+                wstringstream message;
+                message << L"decimal digits " << decimalDigits << L" (" << cdigit << L" BASEX digits): toom3 " << toom3Elapsed << L"us ntt " << nttElapsed
+                        << L"us";
+                Logger::WriteMessage(message.str().c_str());
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkDivMantNewton)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkDivMantNewton)
+        {
+            // Logs schoolbook and Newton division of a 2n digit number by an
+            // n digit number next to the cost of an n by n multiply.
+            uint32_t seed = 13;
+            int32_t savedThreshold = g_newtonDivThreshold;
+            for (int32_t cdigit : { 64, 256, 1024, 4096 })
+            {
+                auto n = RandomMantissa(2 * cdigit, seed);
+                auto b = RandomMantissa(cdigit, seed);
+                vector<MANTTYPE> q(cdigit + 1);
+                vector<MANTTYPE> r(cdigit);
+                int32_t reps = max(1, 2000000 / (cdigit * cdigit));
+
+                double elapsed[2];
+                const int32_t thresholds[] = { INT32_MAX, 8 };
+                for (int32_t i = 0; i < 2; i++)
+                {
+                    g_newtonDivThreshold = thresholds[i];
+                    auto start = chrono::steady_clock::now();
+                    for (int32_t rep = 0; rep < reps; rep++)
+                    {
+                        _divmantx(q.data(), r.data(), n.data(), 2 * cdigit, b.data(), cdigit);
+                    }
+                    elapsed[i] = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / reps;
+                }
+                g_newtonDivThreshold = savedThreshold;
+
+                auto start = chrono::steady_clock::now();
+                for (int32_t rep = 0; rep < reps; rep++)
+                {
+                    MulMant(n, b, KARATSUBA_THRESHOLD, TOOM3_THRESHOLD, NTT_THRESHOLD);
+                }
+                auto mulElapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / reps;
+
+                wstringstream message;
+                message << L"digits " << cdigit << L": schoolbook " << elapsed[0] << L"us newton " << elapsed[1] << L"us multiply " << mulElapsed << L"us";
+                Logger::WriteMessage(message.str().c_str());
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkGcdExpressionChain)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkGcdExpressionChain)
+        {
+            // Logs gcd of the numerator and denominator of a long chain of
+            // additions against plain Euclid.
+            for (int32_t terms : { 50, 200, 800 })
+            {
+                PRAT sum = HarmonicSum(terms);
+
+                auto start = chrono::steady_clock::now();
+                PNUMBER expected = EuclidGcd(sum->pp, sum->pq);
+                auto euclidElapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+                start = chrono::steady_clock::now();
+                PNUMBER actual = gcd(sum->pp, sum->pq);
+                auto gcdElapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+                VERIFY_IS_TRUE(equnum(expected, actual));
+
+                wstringstream message;
+                message << L"terms " << terms << L" (" << sum->pq->cdigit << L" BASEX digits): euclid " << euclidElapsed << L"ms gcd " << gcdElapsed << L"ms";
+                Logger::WriteMessage(message.str().c_str());
+
+                destroynum(actual);
+                destroynum(expected);
+                destroyrat(sum);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkRadixConversion)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkRadixConversion)
+        {
+            // Logs conversion of long integers to decimal a digit at a time and
+            // by divide and conquer, the latter should grow close to linearly.
+            uint32_t seed = 17;
+            for (int32_t cdigit : { 100, 1000, 4000, 16000 })
+            {
+                PNUMBER a = NumberFromMantissa(RandomMantissa(cdigit, seed), 1, 0);
+                a->mant[cdigit - 1] |= 1;
+
+                double elapsed[2];
+                PNUMBER results[2];
+                const int32_t thresholds[] = { INT32_MAX, RADIX_CONV_THRESHOLD };
+                for (int32_t i = 0; i < 2; i++)
+                {
+                    auto start = chrono::steady_clock::now();
+                    results[i] = ToRadix(a, 10, thresholds[i]);
+                    elapsed[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                }
+                VERIFY_IS_TRUE(equnum(results[0], results[1]));
+
+                wstringstream message;
+                message << L"decimal digits " << results[1]->cdigit << L": digit at a time " << elapsed[0] << L"ms divide and conquer " << elapsed[1] << L"ms";
+                Logger::WriteMessage(message.str().c_str());
+
+                destroynum(results[0]);
+                destroynum(results[1]);
+                destroynum(a);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkRadixInput)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkRadixInput)
+        {
+            // Logs conversion of long decimal operands into BASEX a digit at a
+            // time and chunked, plus a full StringToRat parse.
+            uint32_t seed = 21;
+            for (int32_t cdigit : { 1000, 10000, 100000 })
+            {
+                PNUMBER a = RandomRadixNumber(cdigit, 10, seed);
+
+                auto start = chrono::steady_clock::now();
+                PNUMBER expected = FromRadixDigitAtATime(a, 10);
+                auto digitElapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+                start = chrono::steady_clock::now();
+                PNUMBER actual = numtonRadixx(a, 10);
+                auto chunkElapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                VERIFY_IS_TRUE(equnum(expected, actual));
+
+                wstring text(cdigit, L'7');
+                start = chrono::steady_clock::now();
+                PRAT parsed = StringToRat(false, text, false, L"", 10, 128);
+                auto parseElapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+                wstringstream message;
+                message << L"decimal digits " << cdigit << L": digit at a time " << digitElapsed << L"ms chunked " << chunkElapsed << L"ms StringToRat "
+                        << parseElapsed << L"ms";
+                Logger::WriteMessage(message.str().c_str());
+
+                destroyrat(parsed);
+                destroynum(actual);
+                destroynum(expected);
+                destroynum(a);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkRatToStringScaling)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkRatToStringScaling)
+        {
+            // Logs RatToString of a long rational to all its digits with the
+            // division in radix done by long division and in BASEX, the
+            // latter should not grow with the square of the digits.
+            uint32_t seed = 23;
+            int32_t savedThreshold = g_radixDivThreshold;
+            double elapsed[2][2];
+            const int32_t digits[] = { 10000, 30000 };
+            for (int32_t i = 0; i < 2; i++)
+            {
+                int32_t cdigit = digits[i] / g_ratio;
+                PRAT x = nullptr;
+                createrat(x);
+                x->pp = NumberFromMantissa(RandomMantissa(cdigit, seed), 1, 0);
+                x->pq = NumberFromMantissa(RandomMantissa(cdigit, seed), 1, 0);
+                x->pp->mant[cdigit - 1] |= 1;
+                x->pq->mant[cdigit - 1] |= 1;
+
+                wstring results[2];
+                const int32_t thresholds[] = { INT32_MAX, RADIX_DIV_THRESHOLD };
+                for (int32_t j = 0; j < 2; j++)
+                {
+                    g_radixDivThreshold = thresholds[j];
+                    auto start = chrono::steady_clock::now();
+                    results[j] = RatToString(x, FMT_FLOAT, 10, digits[i]);
+                    elapsed[i][j] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    g_radixDivThreshold = savedThreshold;
+                }
+                VERIFY_ARE_EQUAL(results[0], results[1]);
+
+                wstringstream message;
+                message << L"decimal digits " << digits[i] << L": long division " << elapsed[i][0] << L"ms in BASEX " << elapsed[i][1] << L"ms";
+                Logger::WriteMessage(message.str().c_str());
+
+                destroyrat(x);
+            }
+
+            // Three times the digits, long division takes about nine times as long.
+            VERIFY_IS_LESS_THAN(elapsed[1][1], 9 * elapsed[0][1]);
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkSplitSeries)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkSplitSeries)
+        {
+            // Logs exp(1/2) and asin(1/2), the series behind e_to_one_half and
+            // pi, term by term and by binary splitting.
+            PRAT half = SmallRat(1, 2);
+            for (int32_t precision : { 20, 100, 1000, 4000 })
+            {
+                for (auto [series, x, name] : { make_tuple(SERIES_EXP, half, L"exp(1/2)"), make_tuple(SERIES_ASIN, half, L"asin(1/2)") })
+                {
+                    double elapsed[2];
+                    PRAT results[2];
+                    for (int32_t i = 0; i < 2; i++)
+                    {
+                        auto start = chrono::steady_clock::now();
+                        results[i] = SeriesRat(x, series, precision, i == 1);
+                        elapsed[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    }
+                    VERIFY_IS_TRUE(RatsAgree(results[0], results[1], precision - 2));
+
+                    wstringstream message;
+                    message << name << L" to " << precision << L" digits: taylor " << elapsed[0] << L"ms binary splitting " << elapsed[1] << L"ms";
+                    Logger::WriteMessage(message.str().c_str());
+
+                    destroyrat(results[0]);
+                    destroyrat(results[1]);
+                }
+            }
+            destroyrat(half);
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkReducedSeries)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkReducedSeries)
+        {
+            // Logs exp, sin and cos of an argument too long for binary splitting
+            // with and without argument reduction.
+            for (int32_t precision : { 32, 128, 500, 2000 })
+            {
+                PRAT x = LongRat(5, 7, precision);
+                for (auto [series, name] : { make_pair(SERIES_EXP, L"exp"), make_pair(SERIES_SIN, L"sin"), make_pair(SERIES_COS, L"cos") })
+                {
+                    double elapsed[2];
+                    PRAT results[2];
+                    for (int32_t i = 0; i < 2; i++)
+                    {
+                        auto start = chrono::steady_clock::now();
+                        results[i] = ReducedRat(x, series, precision, i == 1);
+                        elapsed[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    }
+                    VERIFY_IS_TRUE(RatsAgree(results[0], results[1], precision - 2));
+
+                    wstringstream message;
+                    message << name << L" to " << precision << L" digits: taylor " << elapsed[0] << L"ms reduced " << elapsed[1] << L"ms";
+                    Logger::WriteMessage(message.str().c_str());
+
+                    destroyrat(results[0]);
+                    destroyrat(results[1]);
+                }
+                destroyrat(x);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkLogAgm)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkLogAgm)
+        {
+            // Logs lograt of a long argument by the Taylor series and by the
+            // AGM so LOG_AGM_THRESHOLD can be retuned.  The constants are only
+            // good to 128 digits, so the results are only compared that far.
+            for (int32_t precision : { 64, 128, 200, 300, 500, 1000, 2000 })
+            {
+                PRAT x = LongRat(5, 3, precision);
+                double elapsed[2];
+                PRAT results[2];
+                for (int32_t i = 0; i < 2; i++)
+                {
+                    auto start = chrono::steady_clock::now();
+                    results[i] = LogRat(x, precision, i == 1);
+                    elapsed[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                }
+                VERIFY_IS_TRUE(RatsAgree(results[0], results[1], min(precision, 128) - 2));
+
+                wstringstream message;
+                message << L"log to " << precision << L" digits: taylor " << elapsed[0] << L"ms agm " << elapsed[1] << L"ms";
+                Logger::WriteMessage(message.str().c_str());
+
+                destroyrat(results[0]);
+                destroyrat(results[1]);
+                destroyrat(x);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkRoots)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkRoots)
+        {
+            // Logs square and cube roots of a long argument through powrat by
+            // the native roots and by exp(log(x)/n).
+            for (int32_t precision : { 32, 128, 500, 2000 })
+            {
+                PRAT x = LongRat(5, 3, precision);
+                for (int32_t root : { 2, 3 })
+                {
+                    PRAT ratroot = i32torat(root);
+                    double elapsed[2];
+                    PRAT results[2] = {};
+                    for (int32_t i = 0; i < 2; i++)
+                    {
+                        auto start = chrono::steady_clock::now();
+                        DUPRAT(results[i], x);
+                        if (i == 0)
+                        {
+                            lograt(&results[i], precision);
+                            divrat(&results[i], ratroot, precision);
+                            exprat(&results[i], 10, precision);
+                        }
+                        else
+                        {
+                            rootrat(&results[i], ratroot, 10, precision);
+                        }
+                        elapsed[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    }
+                    VERIFY_IS_TRUE(RatsAgree(results[0], results[1], min(precision, 128) - 2));
+
+                    wstringstream message;
+                    message << L"root " << root << L" to " << precision << L" digits: exp(log(x)/n) " << elapsed[0] << L"ms native " << elapsed[1] << L"ms";
+                    Logger::WriteMessage(message.str().c_str());
+
+                    destroyrat(results[0]);
+                    destroyrat(results[1]);
+                    destroyrat(ratroot);
+                }
+                destroyrat(x);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkFactorial)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkFactorial)
+        {
+            // Logs factrat of integers against one multiply at a time, and of
+            // the half integer below them.
+            ChangeConstants(10, 32);
+            for (int32_t n : { 3249, 20000, 100000 })
+            {
+                auto start = chrono::steady_clock::now();
+                PRAT x = i32torat(n);
+                factrat(&x, 10, 32);
+                double tree = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+                wstringstream message;
+                message << n << L"!: product tree " << tree << L"ms";
+                if (n <= 20000)
+                {
+                    start = chrono::steady_clock::now();
+                    PRAT expected = SequentialFactorial(n);
+                    double sequential = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    VERIFY_IS_TRUE(rat_equ(x, expected, INT32_MAX));
+                    message << L" one at a time " << sequential << L"ms";
+                    destroyrat(expected);
+                }
+                PRAT half = SmallRat(2 * n - 1, 2);
+                start = chrono::steady_clock::now();
+                factrat(&half, 10, 32);
+                message << L", " << n - 1 << L".5! " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << L"ms";
+                Logger::WriteMessage(message.str().c_str());
+                destroyrat(half);
+                destroyrat(x);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkGamma)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkGamma)
+        {
+            // Logs gamma(0.3) by the series and by Spouge's approximation, the
+            // first call builds the coefficients and the second reuses them.
+            for (int32_t precision : { 32, 128, 500 })
+            {
+                ChangeConstants(10, precision);
+                PRAT x = SmallRat(3, 10);
+                double elapsed[3];
+                PRAT results[3] = {};
+                for (int32_t i = 0; i < 3; i++)
+                {
+                    auto start = chrono::steady_clock::now();
+                    DUPRAT(results[i], x);
+                    if (i == 0)
+                    {
+                        _gamma(&results[i], 10, precision);
+                    }
+                    else
+                    {
+                        _gammaspouge(&results[i], 10, precision);
+                    }
+                    elapsed[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                }
+                divrat(&results[2], results[0], precision);
+                VERIFY_IS_TRUE(RatsAgree(results[2], rat_one, precision - 3));
+
+                wstringstream message;
+                message << L"gamma to " << precision << L" digits: series " << elapsed[0] << L"ms Spouge " << elapsed[1] << L"ms first, " << elapsed[2]
+                        << L"ms cached";
+                Logger::WriteMessage(message.str().c_str());
+
+                for (PRAT result : results)
+                {
+                    destroyrat(result);
+                }
+                destroyrat(x);
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkPowers)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkPowers)
+        {
+            // Logs exact integer powers one square per bit against sliding
+            // windows, the second root spends a factor of two in shifts.
+            for (int32_t rootvalue : { 3, 6 })
+            {
+                for (int32_t power : { 10000, 1000000 })
+                {
+                    PNUMBER root = i32tonum(rootvalue, BASEX);
+                    auto start = chrono::steady_clock::now();
+                    PNUMBER binary = BinaryPower(root, power);
+                    double elapsedbinary = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    start = chrono::steady_clock::now();
+                    numpowi32x(&root, power);
+                    double elapsedwindows = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                    VERIFY_IS_TRUE(equnum(binary, root));
+
+                    wstringstream message;
+                    message << rootvalue << L"^" << power << L": one square per bit " << elapsedbinary << L"ms windows " << elapsedwindows << L"ms";
+                    Logger::WriteMessage(message.str().c_str());
+                    destroynum(binary);
+                    destroynum(root);
+                }
+            }
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkBitwise)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkBitwise)
+        {
+            // Logs what Programmer mode does per operation on 64-bit words,
+            // a logical operation, the chop to the word and a shift, on
+            // integers and on the same values kept off the integer kernels.
+            ChangeConstants(10, 32);
+            PRAT count = i32torat(3);
+            double elapsed[2];
+            uint64_t results[2];
+            for (int32_t general = 0; general < 2; general++)
+            {
+                uint32_t seed = 3;
+                uint64_t sum = 0;
+                auto start = chrono::steady_clock::now();
+                for (int32_t i = 0; i < 20000; i++)
+                {
+                    vector<MANTTYPE> words = RandomMantissa(4, seed);
+                    PRAT x = Ui64ToRat(static_cast<uint64_t>(words[0]) << BASEXPWR | words[1]);
+                    PRAT y = Ui64ToRat(static_cast<uint64_t>(words[2]) << BASEXPWR | words[3]);
+                    if (general)
+                    {
+                        PRAT z = OverThree(x);
+                        destroyrat(x);
+                        x = z;
+                    }
+                    andrat(&x, y, 10, 32);
+                    xorrat(&x, rat_qword, 10, 32);
+                    lshrat(&x, count, 10, 32);
+                    andrat(&x, rat_qword, 10, 32);
+                    rshrat(&x, count, 10, 32);
+                    intrat(&x, 10, 32);
+                    sum += rattoUi64(x, 10, 32);
+                    destroyrat(y);
+                    destroyrat(x);
+                }
+                elapsed[general] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                results[general] = sum;
+            }
+            VERIFY_ARE_EQUAL(results[0], results[1]);
+            destroyrat(count);
+
+            wstringstream message;
+            message << L"20000 64-bit nand, shift and chop: integer kernels " << elapsed[0] << L"ms general path " << elapsed[1] << L"ms";
+            Logger::WriteMessage(message.str().c_str());
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkComparisons)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkComparisons)
+        {
+            // Logs comparisons of the kind the series loops and range checks
+            // do, by ratcmp and by the subtraction they used to be.
+            PRAT x = SmallRat(355, 113);
+            PRAT close = LongRat(22, 7, 100);
+            double elapsed[2];
+            int32_t counts[2];
+            for (int32_t subtract = 0; subtract < 2; subtract++)
+            {
+                int32_t count = 0;
+                auto start = chrono::steady_clock::now();
+                for (int32_t i = 0; i < 100000; i++)
+                {
+                    if (subtract)
+                    {
+                        count += (SubtractionSign(x, pi) < 0) + (SubtractionSign(close, x) > 0) + (SubtractionSign(x, rat_one) > 0);
+                    }
+                    else
+                    {
+                        count += rat_lt(x, pi, 128) + rat_gt(close, x, 128) + rat_gt(x, rat_one, 128);
+                    }
+                }
+                elapsed[subtract] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                counts[subtract] = count;
+            }
+            VERIFY_ARE_EQUAL(counts[0], counts[1]);
+            destroyrat(close);
+            destroyrat(x);
+
+            wstringstream message;
+            message << L"300000 comparisons: ratcmp " << elapsed[0] << L"ms subtraction " << elapsed[1] << L"ms";
+            Logger::WriteMessage(message.str().c_str());
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkLargeTrig)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkLargeTrig)
+        {
+            // Logs sin of small and of large arguments, by the cached 2pi and
+            // by the asin the reduction used to calculate each time.
+            ChangeConstants(10, 32);
+            PRAT small = SmallRat(1234567, 1000000);
+            PRAT large = i32torat(10);
+            ratpowi32(&large, 50, INT32_MAX);
+            double elapsed[3];
+            for (int32_t run = 0; run < 3; run++)
+            {
+                auto start = chrono::steady_clock::now();
+                for (int32_t i = 0; i < 200; i++)
+                {
+                    PRAT x = nullptr;
+                    DUPRAT(x, run == 0 ? small : large);
+                    if (run == 2)
+                    {
+                        PRAT reduced = Scale2PiBySeries(x, 32);
+                        destroyrat(x);
+                        x = reduced;
+                    }
+                    sinanglerat(&x, ANGLE_RAD, 10, 32);
+                    destroyrat(x);
+                }
+                elapsed[run] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            }
+            destroyrat(large);
+            destroyrat(small);
+
+            wstringstream message;
+            message << L"200 sin: of 1.23 " << elapsed[0] << L"ms of 1e50 " << elapsed[1] << L"ms of 1e50 reduced by asin " << elapsed[2] << L"ms";
+            Logger::WriteMessage(message.str().c_str());
+            ChangeConstants(10, 128);
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkInPlaceSeries)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkInPlaceSeries)
+        {
+            // Logs series evaluations with the numbers they create, results
+            // that fit the buffer they replace no longer count.
+            PRAT x = SmallRat(1, 3);
+            POOLSTATS stats;
+            resetpoolstats();
+            auto start = chrono::steady_clock::now();
+            for (int32_t i = 0; i < 200; i++)
+            {
+                PRAT y = nullptr;
+                DUPRAT(y, x);
+                exprat(&y, 10, 128);
+                sinanglerat(&y, ANGLE_RAD, 10, 128);
+                destroyrat(y);
+            }
+            double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            getpoolstats(&stats);
+            destroyrat(x);
+
+            wstringstream message;
+            message << L"200 exp and sin: " << elapsed << L"ms numbers created " << stats.cnumcreate;
+            Logger::WriteMessage(message.str().c_str());
+        }
+
+        BEGIN_TEST_METHOD_ATTRIBUTE(BenchmarkTrimming)
+            TEST_IGNORE()
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD(BenchmarkTrimming)
+        {
+            // Logs trimming a wide rational to half its digits, by moving the
+            // start of the mantissas and by moving the digits kept.
+            PRAT x = LongRat(22, 7, 4000);
+            mulrat(&x, x, INT32_MAX);
+            double elapsed[2];
+            for (int32_t move = 0; move < 2; move++)
+            {
+                auto start = chrono::steady_clock::now();
+                for (int32_t i = 0; i < 20000; i++)
+                {
+                    PRAT y = nullptr;
+                    DUPRAT(y, x);
+                    if (move)
+                    {
+                        TrimByMoving(y, 4000);
+                    }
+                    else
+                    {
+                        trimit(&y, 4000);
+                    }
+                    destroyrat(y);
+                }
+                elapsed[move] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            }
+            destroyrat(x);
+
+            wstringstream message;
+            message << L"20000 copies of a " << 2 * 4000 << L" digit rational trimmed to 4000: offset " << elapsed[0] << L"ms memmove " << elapsed[1] << L"ms";
+            Logger::WriteMessage(message.str().c_str());
+        }
+    };
+}